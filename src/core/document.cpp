@@ -1,4 +1,5 @@
 #include "document.h"
+#include "../utils/trace.h"
 #include <iostream>
 
 namespace badcad {
@@ -8,12 +9,14 @@ Document::Document() {
     m_planes.push_back(Plane("planexy", true));
     m_planes.push_back(Plane("planexz", true));
     m_planes.push_back(Plane("planeyz", true));
+    updateMemoryUsage();
 }
 
 Document::~Document() {
 }
 
 std::string Document::serialize() const {
+    BADCAD_TRACE_SCOPE("Document::serialize");
     std::stringstream ss;
     
     // Serialize planes
@@ -35,12 +38,14 @@ std::string Document::serialize() const {
 }
 
 bool Document::deserialize(const std::string& content) {
+    BADCAD_TRACE_SCOPE("Document::deserialize");
     std::istringstream iss(content);
     std::string line;
     
     m_planes.clear();
     m_sketches.clear();
     m_features.clear();
+    m_version++;
     
     while (std::getline(iss, line)) {
         std::istringstream lineStream(line);
@@ -62,13 +67,17 @@ bool Document::deserialize(const std::string& content) {
         }
     }
     
+    updateMemoryUsage();
     return true;
 }
 
 void Document::setPlaneVisibility(const std::string& name, bool visible) {
     for (auto& plane : m_planes) {
         if (plane.name == name) {
-            plane.visible = visible;
+            if (plane.visible != visible) {
+                plane.visible = visible;
+                m_version++;
+            }
             break;
         }
     }
@@ -98,12 +107,14 @@ void Document::selectPlane(const std::string& name, bool addToSelection) {
             break;
         }
     }
+    m_version++;
 }
 
 void Document::deselectAll() {
     for (auto& plane : m_planes) {
         plane.selected = false;
     }
+    m_version++;
 }
 
 bool Document::isPlaneSelected(const std::string& name) const {
@@ -115,4 +126,23 @@ bool Document::isPlaneSelected(const std::string& name) const {
     return false;
 }
 
+void Document::updateMemoryUsage() {
+    // Container capacity plus heap-allocated string storage
+    size_t documentBytes = sizeof(Document) + m_planes.capacity() * sizeof(Plane)
+        + (m_sketches.capacity() + m_features.capacity()) * sizeof(std::string);
+    for (const auto& plane : m_planes) {
+        documentBytes += plane.name.capacity();
+    }
+    for (const auto& feature : m_features) {
+        documentBytes += feature.capacity();
+    }
+    m_documentBytes.set(documentBytes);
+    
+    size_t sketchBytes = 0;
+    for (const auto& sketch : m_sketches) {
+        sketchBytes += sketch.capacity();
+    }
+    m_sketchBytes.set(sketchBytes);
+}
+
 } // namespace badcad
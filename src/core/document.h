@@ -1,5 +1,7 @@
 #pragma once
 
+#include "../utils/memory_tracker.h"
+#include <cstdint>
 #include <string>
 #include <vector>
 #include <sstream>
@@ -30,6 +32,10 @@ public:
     // Getters
     const std::vector<Plane>& getPlanes() const { return m_planes; }
     
+    // Incremented on every change that affects what the viewport shows.
+    // Consumers compare versions instead of diffing document state.
+    uint64_t getVersion() const { return m_version; }
+    
     // Plane management
     void setPlaneVisibility(const std::string& name, bool visible);
     bool isPlaneVisible(const std::string& name) const;
@@ -40,9 +46,16 @@ public:
     bool isPlaneSelected(const std::string& name) const;
     
 private:
+    // Re-estimate the footprint reported to the memory tracker
+    void updateMemoryUsage();
+    
     std::vector<Plane> m_planes;
     std::vector<std::string> m_sketches;
     std::vector<std::string> m_features;
+    uint64_t m_version = 0;
+    
+    TrackedBytes m_documentBytes{MemoryTag::Document};
+    TrackedBytes m_sketchBytes{MemoryTag::Sketches};
 };
 
 } // namespace badcad
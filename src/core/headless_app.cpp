@@ -0,0 +1,414 @@
+#include "headless_app.h"
+#include "document.h"
+#include "../geometry/boolean_benchmark.h"
+#include "../importexport/mesh_exporter.h"
+#include "../render/headless_context.h"
+#include "../render/occ_viewer.h"
+#include "../render/gl_loader.h"
+#include "../utils/log.h"
+#include "../utils/memory_tracker.h"
+#include "../utils/task_scheduler.h"
+#include "../utils/trace.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <ctime>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <map>
+#include <sstream>
+#include <string>
+#include <tuple>
+#include <vector>
+
+#include <stb/stb_image_write.h>
+
+namespace badcad {
+
+struct HeadlessOptions {
+    std::string inputPath;          // Empty renders a new (default) part
+    std::string outputDir = ".";
+    int width = 1024;
+    int height = 768;
+    std::vector<std::string> views = {"iso"};
+    int benchmarkFrames = 0;        // Redraws per view when benchmarking
+    std::string benchmarkOutput;    // CSV appended to for regression tracking
+    bool memoryReport = false;
+    size_t memoryBudget = 0;        // Bytes; 0 disables the check
+    int booleanIterations = 0;      // Runs per boolean benchmark case; replaces rendering
+    bool checkMeshExport = false;   // STL export self-check; replaces rendering
+};
+
+static void printUsage() {
+    std::cout << "Usage: badCAD --headless [--input part.bCAD] [--output dir] [--size WxH]\n"
+              << "                         [--views iso,front,top,right] [--bench N] [--bench-out file.csv]\n"
+              << "                         [--memory-report] [--memory-budget MB|idle|assembly]\n"
+              << "       badCAD --headless --bench-booleans N [--bench-out file.csv]\n"
+              << "       badCAD --headless --check-mesh-export [--output dir]"
+              << std::endl;
+}
+
+static bool parseOptions(int argc, char** argv, HeadlessOptions& options) {
+    for (int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+        bool hasValue = (i + 1 < argc);
+
+        if (arg == "--headless") {
+            continue;
+        } else if ((arg == "--trace" || arg == "--log-level") && hasValue) {
+            i++;  // Handled in main()
+        } else if (arg == "--input" && hasValue) {
+            options.inputPath = argv[++i];
+        } else if (arg == "--output" && hasValue) {
+            options.outputDir = argv[++i];
+        } else if (arg == "--size" && hasValue) {
+            if (std::sscanf(argv[++i], "%dx%d", &options.width, &options.height) != 2 ||
+                options.width <= 0 || options.height <= 0) {
+                std::cerr << "Invalid --size, expected WIDTHxHEIGHT" << std::endl;
+                return false;
+            }
+        } else if (arg == "--views" && hasValue) {
+            options.views.clear();
+            std::stringstream list(argv[++i]);
+            std::string view;
+            while (std::getline(list, view, ',')) {
+                if (!view.empty()) {
+                    options.views.push_back(view);
+                }
+            }
+        } else if (arg == "--bench" && hasValue) {
+            options.benchmarkFrames = std::max(0, std::atoi(argv[++i]));
+        } else if (arg == "--bench-booleans" && hasValue) {
+            options.booleanIterations = std::max(0, std::atoi(argv[++i]));
+        } else if (arg == "--check-mesh-export") {
+            options.checkMeshExport = true;
+        } else if (arg == "--bench-out" && hasValue) {
+            options.benchmarkOutput = argv[++i];
+        } else if (arg == "--memory-report") {
+            options.memoryReport = true;
+        } else if (arg == "--memory-budget" && hasValue) {
+            std::string value = argv[++i];
+            if (value == "idle") {
+                options.memoryBudget = kIdleMemoryBudget;
+            } else if (value == "assembly") {
+                options.memoryBudget = kMediumAssemblyMemoryBudget;
+            } else {
+                int megabytes = std::atoi(value.c_str());
+                if (megabytes <= 0) {
+                    std::cerr << "Invalid --memory-budget, expected megabytes, idle or assembly" << std::endl;
+                    return false;
+                }
+                options.memoryBudget = (size_t)megabytes * 1024 * 1024;
+            }
+        } else {
+            std::cerr << "Unknown or incomplete argument: " << arg << std::endl;
+            return false;
+        }
+    }
+    return !options.views.empty();
+}
+
+static bool applyView(OccViewer& viewer, const std::string& view) {
+    if (view == "iso") {
+        viewer.setViewIso();
+    } else if (view == "front") {
+        viewer.setViewFront();
+    } else if (view == "top") {
+        viewer.setViewTop();
+    } else if (view == "right") {
+        viewer.setViewRight();
+    } else {
+        return false;
+    }
+    viewer.fitAll();
+    return true;
+}
+
+static double percentile(const std::vector<double>& sorted, double p) {
+    if (sorted.empty()) {
+        return 0.0;
+    }
+    size_t index = (size_t)(p * (sorted.size() - 1) + 0.5);
+    return sorted[std::min(index, sorted.size() - 1)];
+}
+
+// Times each case of the boolean corpus. Returns 1 if any case fails or
+// produces an invalid shape, 3 if any median is over the boolean budget.
+static int runBooleanBenchmark(const HeadlessOptions& options) {
+    std::ofstream csv;
+    if (!options.benchmarkOutput.empty()) {
+        bool writeHeader = !std::filesystem::exists(options.benchmarkOutput);
+        csv.open(options.benchmarkOutput, std::ios::app);
+        if (writeHeader && csv.is_open()) {
+            csv << "timestamp,case,operation,parallel,fuzzy,glue,iterations,min_ms,median_ms,p95_ms,max_ms,valid\n";
+        }
+    }
+
+    int failures = 0;
+    int overBudget = 0;
+    for (const BooleanBenchmarkCase& benchCase : getBooleanBenchmarkCases()) {
+        std::pair<TopoDS_Shape, TopoDS_Shape> inputs = benchCase.makeInputs();
+
+        std::vector<double> samples;
+        samples.reserve(options.booleanIterations);
+        TopoDS_Shape result;
+        for (int i = 0; i < options.booleanIterations; i++) {
+            BooleanResult run = performBoolean(benchCase.type, inputs.first, inputs.second, benchCase.options);
+            if (!run.isDone()) {
+                break;
+            }
+            samples.push_back(run.elapsedMs);
+            result = run.shape;
+        }
+        if (samples.empty()) {
+            BADCAD_LOG_ERROR("Bench ", benchCase.name, ": boolean failed");
+            failures++;
+            continue;
+        }
+        bool valid = isShapeValid(result);
+        if (!valid) {
+            failures++;
+        }
+        std::sort(samples.begin(), samples.end());
+
+        double median = percentile(samples, 0.5);
+        double p95 = percentile(samples, 0.95);
+        if (median > kBooleanBudgetMs) {
+            overBudget++;
+        }
+        BADCAD_LOG_INFO("Bench ", benchCase.name, ": ", samples.size(), " runs, min ", samples.front(),
+                        " ms, median ", median, " ms, p95 ", p95, " ms, max ", samples.back(), " ms",
+                        valid ? "" : ", INVALID result");
+
+        if (csv.is_open()) {
+            csv << std::time(nullptr) << "," << benchCase.name << "," << getBooleanTypeName(benchCase.type)
+                << "," << benchCase.options.parallel << "," << benchCase.options.fuzzyValue
+                << "," << static_cast<int>(benchCase.options.glue) << "," << samples.size()
+                << "," << samples.front() << "," << median << "," << p95 << "," << samples.back()
+                << "," << valid << "\n";
+        }
+    }
+
+    if (failures > 0) {
+        return 1;
+    }
+    if (overBudget > 0) {
+        BADCAD_LOG_ERROR(overBudget, " boolean case(s) over the ", (int)kBooleanBudgetMs, " ms budget");
+        return 3;
+    }
+    return 0;
+}
+
+// Exports a drilled plate with more faces than one export batch to binary STL
+// and reads it back. Returns 1 unless every edge of the mesh is shared by
+// exactly two triangles, i.e. the batches meet without cracks.
+static int runMeshExportCheck(const HeadlessOptions& options) {
+    std::pair<TopoDS_Shape, TopoDS_Shape> inputs = makeHoleGridInputs(24, 24);
+    BooleanResult plate = performBoolean(BooleanType::Cut, inputs.first, inputs.second);
+    if (!plate.isDone()) {
+        BADCAD_LOG_ERROR("Mesh export check: boolean failed: ", plate.error);
+        return 1;
+    }
+
+    std::string path = (std::filesystem::path(options.outputDir) / "mesh_export_check.stl").string();
+    MeshExportSummary summary;
+    JobHandle job = exportMesh(plate.shape, path, MeshExportOptions(),
+                               [&summary](Job&, const MeshExportSummary& result) { summary = result; });
+    JobState state = job->getFuture().get();
+    TaskScheduler::instance().runMainThreadTasks();  // Delivers the summary
+    if (state != JobState::Succeeded) {
+        BADCAD_LOG_ERROR("Mesh export check: export failed: ", job->getError());
+        return 1;
+    }
+
+    std::ifstream file(path, std::ios::binary);
+    char header[80];
+    uint32_t triangleCount = 0;
+    if (!file.read(header, sizeof(header)) ||
+        !file.read(reinterpret_cast<char*>(&triangleCount), sizeof(triangleCount))) {
+        BADCAD_LOG_ERROR("Mesh export check: failed to read ", path);
+        return 1;
+    }
+
+    // Welded by exact position: the exporter writes shared nodes bit for bit
+    using Vertex = std::tuple<float, float, float>;
+    std::map<Vertex, uint32_t> vertices;
+    std::map<std::pair<uint32_t, uint32_t>, int> edgeUses;
+    for (uint32_t triangle = 0; triangle < triangleCount; triangle++) {
+        float data[12];
+        uint16_t attributes = 0;
+        if (!file.read(reinterpret_cast<char*>(data), sizeof(data)) ||
+            !file.read(reinterpret_cast<char*>(&attributes), sizeof(attributes))) {
+            BADCAD_LOG_ERROR("Mesh export check: truncated file");
+            return 1;
+        }
+        uint32_t corners[3];
+        for (int corner = 0; corner < 3; corner++) {
+            const float* p = data + 3 + corner * 3;
+            corners[corner] = vertices.emplace(Vertex(p[0], p[1], p[2]), (uint32_t)vertices.size()).first->second;
+        }
+        for (int corner = 0; corner < 3; corner++) {
+            uint32_t a = corners[corner];
+            uint32_t b = corners[(corner + 1) % 3];
+            if (a != b) {
+                edgeUses[std::minmax(a, b)]++;
+            }
+        }
+    }
+
+    size_t openEdges = 0;
+    for (const auto& edge : edgeUses) {
+        if (edge.second != 2) {
+            openEdges++;
+        }
+    }
+    std::filesystem::remove(path);
+    BADCAD_LOG_INFO("Mesh export check: ", summary.faceCount, " faces, ", triangleCount, " triangles, ",
+                    edgeUses.size(), " edges, ", openEdges, " not shared by exactly two triangles");
+    return openEdges == 0 ? 0 : 1;
+}
+
+bool isHeadlessInvocation(int argc, char** argv) {
+    for (int i = 1; i < argc; i++) {
+        if (std::strcmp(argv[i], "--headless") == 0) {
+            return true;
+        }
+    }
+    return false;
+}
+
+int runHeadless(int argc, char** argv) {
+    HeadlessOptions options;
+    if (!parseOptions(argc, argv, options)) {
+        printUsage();
+        return 2;
+    }
+
+    // Geometry only; no GL context needed
+    if (options.booleanIterations > 0) {
+        return runBooleanBenchmark(options);
+    }
+    if (options.checkMeshExport) {
+        return runMeshExportCheck(options);
+    }
+
+    // Context first so the viewer (and its FBO) is destroyed while it is still current
+    HeadlessContext context;
+    if (!context.init()) {
+        BADCAD_LOG_ERROR("Failed to create headless OpenGL context");
+        return 1;
+    }
+
+    Document document;
+    std::string stem = "untitled";
+    if (!options.inputPath.empty()) {
+        BADCAD_TRACE_SCOPE_CAT("Headless read input", "io");
+        std::ifstream file(options.inputPath);
+        if (!file.is_open()) {
+            BADCAD_LOG_ERROR("Failed to open file: ", options.inputPath);
+            return 1;
+        }
+        std::string data((std::istreambuf_iterator<char>(file)),
+                         std::istreambuf_iterator<char>());
+        document.deserialize(data);
+        stem = std::filesystem::path(options.inputPath).stem().string();
+    }
+
+    OccViewer viewer;
+    if (!viewer.init(nullptr, options.width, options.height)) {
+        BADCAD_LOG_ERROR("Failed to initialize viewer");
+        return 1;
+    }
+    viewer.setDocument(&document);
+
+    std::error_code ec;
+    std::filesystem::create_directories(options.outputDir, ec);
+
+    std::ofstream benchCsv;
+    if (options.benchmarkFrames > 0 && !options.benchmarkOutput.empty()) {
+        bool writeHeader = !std::filesystem::exists(options.benchmarkOutput);
+        benchCsv.open(options.benchmarkOutput, std::ios::app);
+        if (writeHeader && benchCsv.is_open()) {
+            benchCsv << "timestamp,input,view,width,height,renderer,frames,min_ms,median_ms,p95_ms,max_ms\n";
+        }
+    }
+
+    int failures = 0;
+    std::vector<unsigned char> pixels;
+
+    for (const auto& view : options.views) {
+        if (!applyView(viewer, view)) {
+            BADCAD_LOG_ERROR("Unknown view: ", view);
+            failures++;
+            continue;
+        }
+
+        viewer.invalidate();
+        viewer.render();
+        glFinish();
+
+        int width = 0, height = 0;
+        std::filesystem::path outPath = std::filesystem::path(options.outputDir) / (stem + "_" + view + ".png");
+        bool written = false;
+        {
+            BADCAD_TRACE_SCOPE_CAT("Headless write PNG", "io");
+            written = viewer.readPixels(pixels, width, height) &&
+                      stbi_write_png(outPath.string().c_str(), width, height, 4, pixels.data(), width * 4);
+        }
+        if (!written) {
+            BADCAD_LOG_ERROR("Failed to write ", outPath.string());
+            failures++;
+            continue;
+        }
+        BADCAD_LOG_INFO("Wrote ", outPath.string(), " (", width, "x", height, ")");
+
+        if (options.benchmarkFrames <= 0) {
+            continue;
+        }
+
+        // Time full redraws; glFinish makes the measurement include GPU work
+        std::vector<double> samples;
+        samples.reserve(options.benchmarkFrames);
+        for (int i = 0; i < options.benchmarkFrames; i++) {
+            viewer.invalidate();
+            auto start = std::chrono::steady_clock::now();
+            viewer.render();
+            glFinish();
+            std::chrono::duration<double, std::milli> elapsed = std::chrono::steady_clock::now() - start;
+            samples.push_back(elapsed.count());
+        }
+        std::sort(samples.begin(), samples.end());
+
+        double median = percentile(samples, 0.5);
+        double p95 = percentile(samples, 0.95);
+        BADCAD_LOG_INFO("Bench ", view, ": ", samples.size(), " frames, min ", samples.front(),
+                        " ms, median ", median, " ms, p95 ", p95, " ms, max ", samples.back(), " ms");
+
+        if (benchCsv.is_open()) {
+            benchCsv << std::time(nullptr) << "," << (options.inputPath.empty() ? stem : options.inputPath)
+                     << "," << view << "," << options.width << "," << options.height
+                     << ",\"" << context.getRendererName() << "\"," << samples.size()
+                     << "," << samples.front() << "," << median << "," << p95 << "," << samples.back() << "\n";
+        }
+    }
+
+    // Checked with the document and viewer still alive, i.e. at the scenario's steady state
+    if (options.memoryReport) {
+        std::cout << MemoryTracker::formatReport();
+    }
+    if (options.memoryBudget > 0) {
+        size_t used = std::max(MemoryTracker::getProcessResidentBytes(), MemoryTracker::getTotalLiveBytes());
+        if (used > options.memoryBudget) {
+            BADCAD_LOG_ERROR("Memory budget exceeded: ", used / (1024 * 1024), " MB used, budget ",
+                             options.memoryBudget / (1024 * 1024), " MB");
+            return 3;
+        }
+    }
+
+    return failures == 0 ? 0 : 1;
+}
+
+} // namespace badcad
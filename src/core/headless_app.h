@@ -0,0 +1,26 @@
+#pragma once
+
+namespace badcad {
+
+// Command line entry point for rendering without a window:
+//
+//   badCAD --headless [--input part.bCAD] [--output dir] [--size 1024x768]
+//          [--views iso,front,top,right] [--bench N] [--bench-out file.csv]
+//          [--trace trace.json] [--log-level debug]
+//          [--memory-report] [--memory-budget MB|idle|assembly]
+//   badCAD --headless --bench-booleans N [--bench-out file.csv]
+//   badCAD --headless --check-mesh-export [--output dir]
+//
+// Writes one PNG per view. With --bench, each view is also redrawn N times
+// and frame time statistics are printed (and appended to the CSV if given).
+// With --memory-budget the exit code is 3 when the process ends the run
+// above the budget, so scripted scenarios can gate on SPECIFICATION.md §8;
+// "idle" and "assembly" name the 200 MB and 500 MB budgets from there.
+// --bench-booleans times the built-in boolean corpus instead of rendering and
+// exits with 3 when a case's median is over the 500 ms boolean budget.
+// --check-mesh-export exports a drilled plate of more than one export batch
+// to STL and exits with 1 unless every mesh edge joins exactly two triangles.
+bool isHeadlessInvocation(int argc, char** argv);
+int runHeadless(int argc, char** argv);
+
+} // namespace badcad
@@ -0,0 +1,84 @@
+#include "boolean_benchmark.h"
+
+#include <BRep_Builder.hxx>
+#include <BRepBuilderAPI_Transform.hxx>
+#include <BRepPrimAPI_MakeBox.hxx>
+#include <BRepPrimAPI_MakeCylinder.hxx>
+#include <BRepPrimAPI_MakeSphere.hxx>
+#include <gp_Ax2.hxx>
+#include <gp_Trsf.hxx>
+#include <TopoDS_Compound.hxx>
+
+namespace badcad {
+
+namespace {
+
+TopoDS_Shape makeBox(double x, double y, double z, double dx, double dy, double dz) {
+    return BRepPrimAPI_MakeBox(gp_Pnt(x, y, z), dx, dy, dz).Shape();
+}
+
+// Vertical cylinder standing on (x, y, z)
+TopoDS_Shape makeCylinder(double x, double y, double z, double radius, double height) {
+    return BRepPrimAPI_MakeCylinder(gp_Ax2(gp_Pnt(x, y, z), gp_Dir(0, 0, 1)), radius, height).Shape();
+}
+
+TopoDS_Shape translated(const TopoDS_Shape& shape, double dx, double dy, double dz) {
+    gp_Trsf transform;
+    transform.SetTranslation(gp_Vec(dx, dy, dz));
+    return BRepBuilderAPI_Transform(shape, transform, Standard_True).Shape();
+}
+
+} // namespace
+
+std::vector<BooleanBenchmarkCase> getBooleanBenchmarkCases() {
+    std::vector<BooleanBenchmarkCase> cases;
+
+    cases.push_back({"box_union_overlap", BooleanType::Union, BooleanOptions(), []() {
+        return std::make_pair(makeBox(0, 0, 0, 100, 100, 100), makeBox(50, 50, 50, 100, 100, 100));
+    }});
+
+    cases.push_back({"box_cut_through_hole", BooleanType::Cut, BooleanOptions(), []() {
+        return std::make_pair(makeBox(0, 0, 0, 100, 100, 100), makeCylinder(50, 50, -10, 20, 120));
+    }});
+
+    // Drilled plate: one cut against a compound of 400 tools
+    cases.push_back({"plate_cut_hole_grid", BooleanType::Cut, BooleanOptions(), []() {
+        return makeHoleGridInputs(20, 20);
+    }});
+
+    cases.push_back({"sphere_intersect_box", BooleanType::Intersect, BooleanOptions(), []() {
+        TopoDS_Shape sphere = BRepPrimAPI_MakeSphere(gp_Pnt(0, 0, 0), 60).Shape();
+        return std::make_pair(sphere, makeBox(-40, -40, -40, 100, 100, 100));
+    }});
+
+    // Face-to-face contact, as when a pad is added on top of a block
+    BooleanOptions glue;
+    glue.glue = BooleanGlue::Shift;
+    cases.push_back({"coplanar_union_glue", BooleanType::Union, glue, []() {
+        return std::make_pair(makeBox(0, 0, 0, 100, 100, 20), makeBox(25, 25, 20, 50, 50, 20));
+    }});
+
+    // Faces a few microns apart, typical of imported geometry
+    BooleanOptions fuzzy;
+    fuzzy.fuzzyValue = 1e-2;
+    cases.push_back({"near_coincident_union_fuzzy", BooleanType::Union, fuzzy, []() {
+        TopoDS_Shape block = makeBox(0, 0, 0, 100, 100, 100);
+        return std::make_pair(block, translated(makeBox(0, 0, 0, 100, 100, 100), 100.002, 30, 0));
+    }});
+
+    return cases;
+}
+
+std::pair<TopoDS_Shape, TopoDS_Shape> makeHoleGridInputs(int rows, int columns) {
+    TopoDS_Compound holes;
+    BRep_Builder builder;
+    builder.MakeCompound(holes);
+    for (int row = 0; row < rows; row++) {
+        for (int column = 0; column < columns; column++) {
+            builder.Add(holes, makeCylinder(10 + column * 10, 10 + row * 10, -1, 3, 12));
+        }
+    }
+    return std::make_pair(makeBox(0, 0, 0, 10 + columns * 10, 10 + rows * 10, 10), TopoDS_Shape(holes));
+}
+
+} // namespace badcad
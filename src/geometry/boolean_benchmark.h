@@ -0,0 +1,29 @@
+#pragma once
+
+#include <functional>
+#include <string>
+#include <utility>
+#include <vector>
+#include "boolean_ops.h"
+
+namespace badcad {
+
+// One representative boolean. Inputs are built on demand so their
+// construction is not part of the timing.
+struct BooleanBenchmarkCase {
+    std::string name;
+    BooleanType type;
+    BooleanOptions options;
+    std::function<std::pair<TopoDS_Shape, TopoDS_Shape>()> makeInputs;
+};
+
+// Built-in corpus for `badCAD --headless --bench-booleans N`: overlapping
+// solids, through-holes, hole patterns, curved intersections and the
+// touching/near-coincident cases that need glue or a fuzzy value
+std::vector<BooleanBenchmarkCase> getBooleanBenchmarkCases();
+
+// Plate and a compound of rows x columns through-hole cylinders on a 10 mm
+// pitch, for a Cut. The result has 6 + rows * columns faces.
+std::pair<TopoDS_Shape, TopoDS_Shape> makeHoleGridInputs(int rows, int columns);
+
+} // namespace badcad
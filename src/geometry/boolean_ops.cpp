@@ -0,0 +1,119 @@
+#include "boolean_ops.h"
+#include "../utils/log.h"
+#include "../utils/task_scheduler.h"
+#include "../utils/trace.h"
+#include <chrono>
+#include <memory>
+#include <sstream>
+
+#include <BOPAlgo_GlueEnum.hxx>
+#include <BRepAlgoAPI_Common.hxx>
+#include <BRepAlgoAPI_Cut.hxx>
+#include <BRepAlgoAPI_Fuse.hxx>
+#include <BRepCheck_Analyzer.hxx>
+#include <Standard_Failure.hxx>
+#include <TopTools_ListOfShape.hxx>
+
+namespace badcad {
+
+namespace {
+
+BOPAlgo_GlueEnum toOcc(BooleanGlue glue) {
+    switch (glue) {
+        case BooleanGlue::Shift: return BOPAlgo_GlueShift;
+        case BooleanGlue::Full:  return BOPAlgo_GlueFull;
+        default:                 return BOPAlgo_GlueOff;
+    }
+}
+
+std::unique_ptr<BRepAlgoAPI_BooleanOperation> makeOperation(BooleanType type) {
+    switch (type) {
+        case BooleanType::Union: return std::make_unique<BRepAlgoAPI_Fuse>();
+        case BooleanType::Cut:   return std::make_unique<BRepAlgoAPI_Cut>();
+        default:                 return std::make_unique<BRepAlgoAPI_Common>();
+    }
+}
+
+} // namespace
+
+const char* getBooleanTypeName(BooleanType type) {
+    switch (type) {
+        case BooleanType::Union:     return "union";
+        case BooleanType::Cut:       return "cut";
+        case BooleanType::Intersect: return "intersect";
+    }
+    return "unknown";
+}
+
+BooleanResult performBoolean(BooleanType type, const TopoDS_Shape& object, const TopoDS_Shape& tool,
+                             const BooleanOptions& options) {
+    BADCAD_TRACE_SCOPE_CAT("performBoolean", "geometry");
+    BooleanResult result;
+    auto start = std::chrono::steady_clock::now();
+
+    try {
+        std::unique_ptr<BRepAlgoAPI_BooleanOperation> operation = makeOperation(type);
+        TopTools_ListOfShape arguments;
+        TopTools_ListOfShape tools;
+        arguments.Append(object);
+        tools.Append(tool);
+        operation->SetArguments(arguments);
+        operation->SetTools(tools);
+        operation->SetRunParallel(options.parallel);
+        operation->SetFuzzyValue(options.fuzzyValue);
+        operation->SetGlue(toOcc(options.glue));
+        operation->SetNonDestructive(Standard_True);
+        // Oriented boxes reject non-interfering sub-shapes early
+        operation->SetUseOBB(Standard_True);
+        operation->Build();
+
+        if (operation->HasErrors() || !operation->IsDone()) {
+            std::ostringstream errors;
+            operation->DumpErrors(errors);
+            result.error = errors.str().empty() ? "Boolean operation failed" : errors.str();
+        } else {
+            if (options.simplify) {
+                operation->SimplifyResult();
+            }
+            result.shape = operation->Shape();
+            result.hasWarnings = operation->HasWarnings();
+        }
+    } catch (Standard_Failure const& e) {
+        result.error = e.GetMessageString();
+    }
+
+    std::chrono::duration<double, std::milli> elapsed = std::chrono::steady_clock::now() - start;
+    result.elapsedMs = elapsed.count();
+    if (!result.error.empty()) {
+        BADCAD_LOG_WARN("Boolean ", getBooleanTypeName(type), " failed: ", result.error);
+    } else if (result.elapsedMs > kBooleanBudgetMs) {
+        BADCAD_LOG_WARN("Boolean ", getBooleanTypeName(type), " took ", (int)result.elapsedMs,
+                        " ms, over the ", (int)kBooleanBudgetMs, " ms budget");
+    }
+    return result;
+}
+
+bool isShapeValid(const TopoDS_Shape& shape) {
+    BADCAD_TRACE_SCOPE_CAT("BRepCheck_Analyzer", "geometry");
+    if (shape.IsNull()) {
+        return false;
+    }
+    try {
+        BRepCheck_Analyzer analyzer(shape, Standard_True, Standard_True);
+        return analyzer.IsValid() == Standard_True;
+    } catch (Standard_Failure const& e) {
+        BADCAD_LOG_WARN("Shape check failed: ", e.GetMessageString());
+        return false;
+    }
+}
+
+void validateShapeAsync(const TopoDS_Shape& shape, std::function<void(bool valid)> onValidated) {
+    TaskScheduler::instance().submit([shape, onValidated]() {
+        bool valid = isShapeValid(shape);
+        TaskScheduler::instance().postToMainThread([onValidated, valid]() {
+            onValidated(valid);
+        });
+    }, TaskPriority::Background);
+}
+
+} // namespace badcad
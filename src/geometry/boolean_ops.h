@@ -0,0 +1,58 @@
+#pragma once
+
+#include <functional>
+#include <string>
+#include <TopoDS_Shape.hxx>
+
+namespace badcad {
+
+// Acceptance budget for a single boolean from SPECIFICATION.md
+static constexpr double kBooleanBudgetMs = 500.0;
+
+// The `feature union` / `feature cut` records of DOCUMENT_FORMAT.md, plus intersect
+enum class BooleanType {
+    Union,
+    Cut,
+    Intersect
+};
+
+// Maps onto BOPAlgo_GlueEnum. Shift and Full speed up arguments that only
+// touch or share faces; they give wrong results on real intersections.
+enum class BooleanGlue {
+    Off,
+    Shift,      // Faces may coincide but edges do not intersect
+    Full        // Arguments only share sub-shapes, no intersections at all
+};
+
+struct BooleanOptions {
+    bool parallel = true;
+    double fuzzyValue = 0.0;        // Extra tolerance for near-coincident geometry (mm); 0 = exact
+    BooleanGlue glue = BooleanGlue::Off;
+    bool simplify = false;          // Merge faces/edges split by the operation that share a surface
+};
+
+struct BooleanResult {
+    TopoDS_Shape shape;             // Null on failure
+    std::string error;
+    bool hasWarnings = false;
+    double elapsedMs = 0.0;
+
+    bool isDone() const { return !shape.IsNull(); }
+};
+
+// Runs BRepAlgoAPI_Fuse/Cut/Common. Inputs are left untouched (non-destructive
+// mode), so cached feature results can be passed in directly.
+BooleanResult performBoolean(BooleanType type, const TopoDS_Shape& object, const TopoDS_Shape& tool,
+                             const BooleanOptions& options = BooleanOptions());
+
+// BRepCheck_Analyzer, blocking
+bool isShapeValid(const TopoDS_Shape& shape);
+
+// Same check on a background task; onValidated runs on the main thread.
+// Booleans can produce degenerate topology, so callers show the result right
+// away and revert to the pre-op state if it turns out invalid.
+void validateShapeAsync(const TopoDS_Shape& shape, std::function<void(bool valid)> onValidated);
+
+const char* getBooleanTypeName(BooleanType type);
+
+} // namespace badcad
@@ -0,0 +1,214 @@
+#include "feature_cache.h"
+#include "../utils/cache_dir.h"
+#include "../utils/hash.h"
+#include "../utils/log.h"
+#include "../utils/trace.h"
+#include <cstdio>
+#include <fstream>
+#include <sstream>
+#include <thread>
+
+#include <BinTools.hxx>
+#include <Standard_Failure.hxx>
+
+namespace badcad {
+
+namespace {
+
+// Bumped when the key derivation or file layout changes
+constexpr uint64_t kFeatureCacheVersion = 1;
+
+std::string serializeShape(const TopoDS_Shape& shape) {
+    // Geometry and topology only; meshes are cached separately
+    std::ostringstream stream(std::ios::binary);
+    BinTools::Write(shape, stream, Standard_False, Standard_False, BinTools_FormatVersion_CURRENT);
+    return stream.str();
+}
+
+} // namespace
+
+FeatureResultCache& FeatureResultCache::instance() {
+    static FeatureResultCache cache;
+    return cache;
+}
+
+uint64_t FeatureResultCache::makeKey(const std::string& definition, const std::vector<uint64_t>& inputHashes) {
+    uint64_t key = hashCombine(hashString(definition), kFeatureCacheVersion);
+    for (uint64_t input : inputHashes) {
+        key = hashCombine(key, input);
+    }
+    return key;
+}
+
+uint64_t FeatureResultCache::hashShape(const TopoDS_Shape& shape) {
+    if (shape.IsNull()) {
+        return 0;
+    }
+    try {
+        return hashString(serializeShape(shape));
+    } catch (Standard_Failure const& e) {
+        BADCAD_LOG_WARN("Cannot hash shape: ", e.GetMessageString());
+        return 0;
+    }
+}
+
+std::filesystem::path FeatureResultCache::entryPath(uint64_t key) {
+    if (!m_directoryResolved) {
+        m_directoryResolved = true;
+        m_directory = getCacheDirectory("features");
+        if (!m_directory.empty()) {
+            m_diskBytes = getCacheDirectorySize(m_directory, ".brep");
+        }
+    }
+    if (m_directory.empty()) {
+        return {};
+    }
+    char name[32];
+    std::snprintf(name, sizeof(name), "%016llx.brep", (unsigned long long)key);
+    return m_directory / name;
+}
+
+bool FeatureResultCache::find(uint64_t key, TopoDS_Shape& outShape) {
+    std::filesystem::path path;
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        auto it = m_index.find(key);
+        if (it != m_index.end()) {
+            m_entries.splice(m_entries.begin(), m_entries, it->second);
+            outShape = it->second->shape;
+            return true;
+        }
+        path = entryPath(key);
+    }
+    if (path.empty()) {
+        return false;
+    }
+
+    std::ifstream file(path, std::ios::binary | std::ios::ate);
+    if (!file.is_open()) {
+        return false;
+    }
+    BADCAD_TRACE_SCOPE_CAT("FeatureResultCache read", "io");
+    size_t size = (size_t)file.tellg();
+    file.seekg(0);
+    TopoDS_Shape shape;
+    try {
+        BinTools::Read(shape, file);
+    } catch (Standard_Failure const& e) {
+        BADCAD_LOG_WARN("Discarding unreadable feature result ", path.filename().string(), ": ",
+                        e.GetMessageString());
+        file.close();
+        std::error_code ec;
+        std::filesystem::remove(path, ec);
+        return false;
+    }
+    if (shape.IsNull()) {
+        return false;
+    }
+    touchCacheEntry(path);
+
+    std::lock_guard<std::mutex> lock(m_mutex);
+    insertLocked(key, shape, size);
+    outShape = shape;
+    return true;
+}
+
+void FeatureResultCache::insert(uint64_t key, const TopoDS_Shape& shape) {
+    if (shape.IsNull()) {
+        return;
+    }
+    BADCAD_TRACE_SCOPE_CAT("FeatureResultCache write", "io");
+    std::string bytes;
+    try {
+        bytes = serializeShape(shape);
+    } catch (Standard_Failure const& e) {
+        BADCAD_LOG_WARN("Cannot serialize feature result: ", e.GetMessageString());
+        return;
+    }
+
+    std::filesystem::path path;
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        insertLocked(key, shape, bytes.size());
+        path = entryPath(key);
+    }
+    if (path.empty()) {
+        return;
+    }
+    std::error_code ec;
+    if (std::filesystem::exists(path, ec)) {
+        // Content-addressed: the same key always holds the same shape
+        touchCacheEntry(path);
+        return;
+    }
+
+    // Write then rename, so a concurrent reader never sees a partial file
+    std::filesystem::path tempPath = path;
+    tempPath += "." + std::to_string(std::hash<std::thread::id>()(std::this_thread::get_id())) + ".tmp";
+    bool written = false;
+    {
+        std::ofstream out(tempPath, std::ios::binary);
+        if (out.is_open()) {
+            out.write(bytes.data(), bytes.size());
+            written = (bool)out;
+        }
+    }
+    if (!written) {
+        std::filesystem::remove(tempPath, ec);
+        return;
+    }
+    std::filesystem::rename(tempPath, path, ec);
+    if (ec) {
+        std::filesystem::remove(tempPath, ec);
+        return;
+    }
+
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_diskBytes += bytes.size();
+    if (m_diskBytes > kFeatureCacheDiskLimit) {
+        m_diskBytes = trimCacheDirectory(m_directory, ".brep", kFeatureCacheDiskLimit / 10 * 9);
+    }
+}
+
+void FeatureResultCache::insertLocked(uint64_t key, const TopoDS_Shape& shape, size_t bytes) {
+    auto existing = m_index.find(key);
+    if (existing != m_index.end()) {
+        m_memoryBytes.set(m_memoryBytes.get() - existing->second->bytes);
+        m_entries.erase(existing->second);
+        m_index.erase(existing);
+    }
+    m_entries.push_front({key, shape, bytes});
+    m_index[key] = m_entries.begin();
+    m_memoryBytes.set(m_memoryBytes.get() + bytes);
+    trimMemoryLocked();
+}
+
+void FeatureResultCache::trimMemoryLocked() {
+    // Evicted shapes are already on disk; keep at least the newest entry
+    while (m_memoryBytes.get() > m_memoryBudget && m_entries.size() > 1) {
+        const Entry& oldest = m_entries.back();
+        m_memoryBytes.set(m_memoryBytes.get() - oldest.bytes);
+        m_index.erase(oldest.key);
+        m_entries.pop_back();
+    }
+}
+
+void FeatureResultCache::setMemoryBudget(size_t bytes) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_memoryBudget = bytes;
+    trimMemoryLocked();
+}
+
+size_t FeatureResultCache::getMemoryBytes() {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_memoryBytes.get();
+}
+
+void FeatureResultCache::clearMemory() {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_entries.clear();
+    m_index.clear();
+    m_memoryBytes.set(0);
+}
+
+} // namespace badcad
@@ -0,0 +1,75 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <list>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include "../utils/memory_tracker.h"
+#include <TopoDS_Shape.hxx>
+
+namespace badcad {
+
+// Default in-memory budget and on-disk cap for feature results
+constexpr size_t kFeatureCacheMemoryBudget = 128u * 1024 * 1024;
+constexpr uint64_t kFeatureCacheDiskLimit = 1024ull * 1024 * 1024;
+
+// Computed feature shapes (SPECIFICATION.md §5: "persist BReps for each
+// feature, rebuild is slow"), keyed by what determines them: the feature's
+// definition and the content hashes of its input shapes. Reopening a file,
+// undo/redo and toggling suppression reproduce the same keys and get the
+// stored result back instead of re-running booleans and fillets.
+//
+// Recently used results stay in memory up to a budget; every result is also
+// written to getCacheDirectory("features") with the binary BRep writer, so
+// evicted entries and other sessions read it back from there. Thread-safe.
+class FeatureResultCache {
+public:
+    static FeatureResultCache& instance();
+
+    // definition is the feature's serialized record (type and parameters);
+    // inputHashes are hashShape() of its input shapes, in order
+    static uint64_t makeKey(const std::string& definition, const std::vector<uint64_t>& inputHashes);
+
+    // Content hash of a shape's binary BRep, to chain results into later features
+    static uint64_t hashShape(const TopoDS_Shape& shape);
+
+    bool find(uint64_t key, TopoDS_Shape& outShape);
+
+    // Serializes the shape, so call it off the UI thread for large results
+    void insert(uint64_t key, const TopoDS_Shape& shape);
+
+    void setMemoryBudget(size_t bytes);
+    size_t getMemoryBytes();
+
+    // Drops the in-memory tier; disk entries stay
+    void clearMemory();
+
+private:
+    struct Entry {
+        uint64_t key;
+        TopoDS_Shape shape;
+        size_t bytes;   // Serialized size, as an estimate of the in-memory size
+    };
+
+    FeatureResultCache() = default;
+
+    std::filesystem::path entryPath(uint64_t key);
+    void insertLocked(uint64_t key, const TopoDS_Shape& shape, size_t bytes);
+    void trimMemoryLocked();
+
+    std::mutex m_mutex;
+    std::list<Entry> m_entries;     // Most recently used first
+    std::unordered_map<uint64_t, std::list<Entry>::iterator> m_index;
+    size_t m_memoryBudget = kFeatureCacheMemoryBudget;
+    TrackedBytes m_memoryBytes{MemoryTag::Document};
+
+    std::filesystem::path m_directory;
+    bool m_directoryResolved = false;
+    uint64_t m_diskBytes = 0;
+};
+
+} // namespace badcad
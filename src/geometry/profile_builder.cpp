@@ -0,0 +1,325 @@
+#include "profile_builder.h"
+#include "../utils/hash.h"
+#include "../utils/log.h"
+#include "../utils/trace.h"
+#include <algorithm>
+#include <cmath>
+#include <numeric>
+#include <set>
+#include <utility>
+
+#include <BRep_Builder.hxx>
+#include <BRepBuilderAPI_MakeFace.hxx>
+#include <BRepBuilderAPI_MakePolygon.hxx>
+#include <gp_Pln.hxx>
+#include <Standard_Failure.hxx>
+#include <TopoDS_Compound.hxx>
+
+namespace badcad {
+
+namespace {
+
+// Loops enclosing less than this (mm²) are slivers, not regions
+constexpr double kMinLoopArea = 1e-9;
+
+using Edge = std::pair<int, int>;
+
+struct Cycle {
+    std::vector<int> vertices;
+    double area = 0.0;          // Signed: positive for bounded faces (counter-clockwise)
+    int component = -1;
+};
+
+double signedArea(const std::vector<ProfilePoint>& points, const std::vector<int>& loop) {
+    double twiceArea = 0.0;
+    for (size_t i = 0; i < loop.size(); i++) {
+        const ProfilePoint& a = points[loop[i]];
+        const ProfilePoint& b = points[loop[(i + 1) % loop.size()]];
+        twiceArea += a.x * b.y - b.x * a.y;
+    }
+    return 0.5 * twiceArea;
+}
+
+bool containsPoint(const std::vector<ProfilePoint>& points, const std::vector<int>& loop, const ProfilePoint& p) {
+    bool inside = false;
+    for (size_t i = 0, j = loop.size() - 1; i < loop.size(); j = i++) {
+        const ProfilePoint& a = points[loop[i]];
+        const ProfilePoint& b = points[loop[j]];
+        if ((a.y > p.y) != (b.y > p.y) && p.x < (b.x - a.x) * (p.y - a.y) / (b.y - a.y) + a.x) {
+            inside = !inside;
+        }
+    }
+    return inside;
+}
+
+// Hash of the loop's coordinates, independent of where the walk started
+uint64_t loopSignature(const std::vector<ProfilePoint>& points, const std::vector<int>& loop) {
+    size_t first = std::min_element(loop.begin(), loop.end()) - loop.begin();
+    uint64_t hash = kHashSeed;
+    for (size_t i = 0; i < loop.size(); i++) {
+        const ProfilePoint& p = points[loop[(first + i) % loop.size()]];
+        hash = hashBytes(&p.x, sizeof(double), hash);
+        hash = hashBytes(&p.y, sizeof(double), hash);
+    }
+    return hash;
+}
+
+int findRoot(std::vector<int>& parents, int v) {
+    while (parents[v] != v) {
+        parents[v] = parents[parents[v]];
+        v = parents[v];
+    }
+    return v;
+}
+
+// Segments that can bound a region: valid, non-degenerate, deduplicated, and
+// not part of a dangling chain
+std::vector<Edge> collectEdges(const std::vector<ProfilePoint>& points, const std::vector<ProfileSegment>& segments) {
+    std::set<Edge> unique;
+    for (const ProfileSegment& segment : segments) {
+        int a = segment.start;
+        int b = segment.end;
+        if (a < 0 || b < 0 || a >= (int)points.size() || b >= (int)points.size() || a == b) {
+            continue;
+        }
+        if (points[a].x == points[b].x && points[a].y == points[b].y) {
+            continue;
+        }
+        unique.insert(std::minmax(a, b));
+    }
+    std::vector<Edge> edges(unique.begin(), unique.end());
+
+    std::vector<int> degree(points.size(), 0);
+    for (const Edge& edge : edges) {
+        degree[edge.first]++;
+        degree[edge.second]++;
+    }
+    bool pruned = true;
+    while (pruned) {
+        pruned = false;
+        for (size_t i = 0; i < edges.size();) {
+            if (degree[edges[i].first] < 2 || degree[edges[i].second] < 2) {
+                degree[edges[i].first]--;
+                degree[edges[i].second]--;
+                edges[i] = edges.back();
+                edges.pop_back();
+                pruned = true;
+            } else {
+                i++;
+            }
+        }
+    }
+    return edges;
+}
+
+// Walks every face of the planar graph with the face on the left of each
+// half-edge. Half-edge 2e runs first->second of edge e, 2e+1 the other way.
+std::vector<Cycle> traceCycles(const std::vector<ProfilePoint>& points, const std::vector<Edge>& edges,
+                               std::vector<int>& outCycleOfHalfEdge) {
+    auto origin = [&](int h) { return (h & 1) ? edges[h / 2].second : edges[h / 2].first; };
+    auto target = [&](int h) { return (h & 1) ? edges[h / 2].first : edges[h / 2].second; };
+
+    // Outgoing half-edges per vertex, counter-clockwise by angle
+    std::vector<std::vector<int>> outgoing(points.size());
+    for (int h = 0; h < (int)edges.size() * 2; h++) {
+        outgoing[origin(h)].push_back(h);
+    }
+    std::vector<int> position(edges.size() * 2);
+    for (std::vector<int>& list : outgoing) {
+        std::sort(list.begin(), list.end(), [&](int a, int b) {
+            const ProfilePoint& from = points[origin(a)];
+            const ProfilePoint& toA = points[target(a)];
+            const ProfilePoint& toB = points[target(b)];
+            return std::atan2(toA.y - from.y, toA.x - from.x) < std::atan2(toB.y - from.y, toB.x - from.x);
+        });
+        for (size_t i = 0; i < list.size(); i++) {
+            position[list[i]] = (int)i;
+        }
+    }
+
+    std::vector<Cycle> cycles;
+    outCycleOfHalfEdge.assign(edges.size() * 2, -1);
+    for (int start = 0; start < (int)edges.size() * 2; start++) {
+        if (outCycleOfHalfEdge[start] != -1) {
+            continue;
+        }
+        Cycle cycle;
+        int h = start;
+        do {
+            outCycleOfHalfEdge[h] = (int)cycles.size();
+            cycle.vertices.push_back(origin(h));
+            // Turn as sharply left as possible at the target: the edge just
+            // clockwise of the way back. That keeps the face on the left.
+            const std::vector<int>& list = outgoing[target(h)];
+            int back = h ^ 1;
+            h = list[(position[back] + list.size() - 1) % list.size()];
+        } while (h != start);
+        cycle.area = signedArea(points, cycle.vertices);
+        cycles.push_back(std::move(cycle));
+    }
+    return cycles;
+}
+
+} // namespace
+
+bool getSketchPlaneAxes(const std::string& planeName, gp_Ax3& outAxes) {
+    // Right-handed, with local x/y along the first/second axis in the name
+    if (planeName == "planexy") {
+        outAxes = gp_Ax3(gp_Pnt(0, 0, 0), gp_Dir(0, 0, 1), gp_Dir(1, 0, 0));
+    } else if (planeName == "planexz") {
+        outAxes = gp_Ax3(gp_Pnt(0, 0, 0), gp_Dir(0, -1, 0), gp_Dir(1, 0, 0));
+    } else if (planeName == "planeyz") {
+        outAxes = gp_Ax3(gp_Pnt(0, 0, 0), gp_Dir(1, 0, 0), gp_Dir(0, 1, 0));
+    } else {
+        return false;
+    }
+    return true;
+}
+
+ProfileBuilder::ProfileBuilder(const gp_Ax3& plane) : m_plane(plane) {
+}
+
+const std::vector<ProfileRegion>& ProfileBuilder::update(const std::vector<ProfilePoint>& points,
+                                                         const std::vector<ProfileSegment>& segments) {
+    BADCAD_TRACE_SCOPE_CAT("ProfileBuilder::update", "geometry");
+
+    // Bridges (segments with the same face on both sides) cannot bound a
+    // region either; drop them and walk again until there are none
+    std::vector<Edge> edges = collectEdges(points, segments);
+    std::vector<Cycle> cycles;
+    std::vector<int> cycleOfHalfEdge;
+    while (true) {
+        cycles = traceCycles(points, edges, cycleOfHalfEdge);
+        std::vector<ProfileSegment> remaining;
+        for (size_t e = 0; e < edges.size(); e++) {
+            if (cycleOfHalfEdge[2 * e] != cycleOfHalfEdge[2 * e + 1]) {
+                remaining.push_back({edges[e].first, edges[e].second});
+            }
+        }
+        if (remaining.size() == edges.size()) {
+            break;
+        }
+        edges = collectEdges(points, remaining);
+    }
+
+    // Connected components, so holes are only matched against other sketch parts
+    std::vector<int> parents(points.size());
+    std::iota(parents.begin(), parents.end(), 0);
+    for (const Edge& edge : edges) {
+        parents[findRoot(parents, edge.first)] = findRoot(parents, edge.second);
+    }
+    for (Cycle& cycle : cycles) {
+        cycle.component = findRoot(parents, cycle.vertices.front());
+    }
+
+    std::vector<ProfileRegion> regions;
+    std::vector<const Cycle*> regionCycles;
+    for (const Cycle& cycle : cycles) {
+        if (cycle.area > kMinLoopArea) {
+            ProfileRegion region;
+            region.outer = cycle.vertices;
+            regions.push_back(std::move(region));
+            regionCycles.push_back(&cycle);
+        }
+    }
+
+    // Smallest region of another part that contains the point
+    auto innermostRegion = [&](const ProfilePoint& point, int component) {
+        int best = -1;
+        for (size_t i = 0; i < regions.size(); i++) {
+            if (regionCycles[i]->component != component && containsPoint(points, regions[i].outer, point) &&
+                (best < 0 || regionCycles[i]->area < regionCycles[best]->area)) {
+                best = (int)i;
+            }
+        }
+        return best;
+    };
+
+    // Each part's outer boundary (a clockwise walk) is a hole in the region around it
+    for (const Cycle& cycle : cycles) {
+        if (cycle.area < -kMinLoopArea) {
+            int container = innermostRegion(points[cycle.vertices.front()], cycle.component);
+            if (container >= 0) {
+                regions[container].holes.push_back(cycle.vertices);
+            }
+        }
+    }
+    for (size_t i = 0; i < regions.size(); i++) {
+        const ProfilePoint& point = points[regions[i].outer.front()];
+        for (size_t j = 0; j < regions.size(); j++) {
+            if (regionCycles[j]->component != regionCycles[i]->component &&
+                containsPoint(points, regions[j].outer, point)) {
+                regions[i].depth++;
+            }
+        }
+    }
+
+    // Reuse faces whose loops are unchanged
+    std::unordered_map<uint64_t, TopoDS_Face> faces;
+    m_lastRebuildCount = 0;
+    for (ProfileRegion& region : regions) {
+        std::vector<uint64_t> holeSignatures;
+        for (const std::vector<int>& hole : region.holes) {
+            holeSignatures.push_back(loopSignature(points, hole));
+        }
+        std::sort(holeSignatures.begin(), holeSignatures.end());
+        region.signature = loopSignature(points, region.outer);
+        for (uint64_t holeSignature : holeSignatures) {
+            region.signature = hashCombine(region.signature, holeSignature);
+        }
+
+        auto cached = m_faces.find(region.signature);
+        if (cached != m_faces.end()) {
+            region.face = cached->second;
+        } else {
+            region.face = buildFace(points, region);
+            m_lastRebuildCount++;
+        }
+        faces[region.signature] = region.face;
+    }
+    m_faces.swap(faces);
+    m_regions = std::move(regions);
+    return m_regions;
+}
+
+TopoDS_Face ProfileBuilder::buildFace(const std::vector<ProfilePoint>& points, const ProfileRegion& region) const {
+    const gp_XYZ origin = m_plane.Location().XYZ();
+    const gp_XYZ xAxis = m_plane.XDirection().XYZ();
+    const gp_XYZ yAxis = m_plane.YDirection().XYZ();
+    auto makeWire = [&](const std::vector<int>& loop) {
+        BRepBuilderAPI_MakePolygon polygon;
+        for (int index : loop) {
+            polygon.Add(gp_Pnt(origin + xAxis * points[index].x + yAxis * points[index].y));
+        }
+        polygon.Close();
+        return polygon.Wire();
+    };
+
+    try {
+        BRepBuilderAPI_MakeFace maker(gp_Pln(m_plane), makeWire(region.outer), Standard_True);
+        for (const std::vector<int>& hole : region.holes) {
+            maker.Add(makeWire(hole));
+        }
+        if (maker.IsDone()) {
+            return maker.Face();
+        }
+        BADCAD_LOG_WARN("Sketch region rejected (", region.outer.size(), " points)");
+    } catch (Standard_Failure const& e) {
+        BADCAD_LOG_WARN("Sketch region failed: ", e.GetMessageString());
+    }
+    return TopoDS_Face();
+}
+
+TopoDS_Shape ProfileBuilder::getProfile() const {
+    TopoDS_Compound profile;
+    BRep_Builder builder;
+    builder.MakeCompound(profile);
+    for (const ProfileRegion& region : m_regions) {
+        if (region.depth % 2 == 0 && !region.face.IsNull()) {
+            builder.Add(profile, region.face);
+        }
+    }
+    return profile;
+}
+
+} // namespace badcad
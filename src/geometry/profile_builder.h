@@ -0,0 +1,76 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include <gp_Ax3.hxx>
+#include <TopoDS_Face.hxx>
+#include <TopoDS_Shape.hxx>
+
+namespace badcad {
+
+// Sketch geometry in plane coordinates (mm)
+struct ProfilePoint {
+    double x;
+    double y;
+};
+
+// Straight segment between two point indices, as created by the line tool
+struct ProfileSegment {
+    int start;
+    int end;
+};
+
+// One closed region of the sketch, i.e. a bounded face of its planar graph
+struct ProfileRegion {
+    std::vector<int> outer;                 // Point indices, counter-clockwise
+    std::vector<std::vector<int>> holes;    // Loops of sketch parts drawn inside it, clockwise
+    int depth = 0;                          // How many other regions enclose it
+    uint64_t signature = 0;                 // Hash of its loops' coordinates
+    TopoDS_Face face;                       // Null if OCC rejected the loops
+};
+
+// Axes of a construction plane by document name ("planexy", "planexz",
+// "planeyz"), matching the planes the viewer draws. False for unknown names.
+bool getSketchPlaneAxes(const std::string& planeName, gp_Ax3& outAxes);
+
+// Turns sketch points and segments into closed TopoDS_Face profiles.
+//
+// Regions are found by walking the sketch's planar graph: dangling and
+// bridging segments are ignored, every bounded face becomes a region, and a
+// separate loop drawn inside a region becomes a hole in it (the loop's own
+// interior is a region too). Segments are expected to meet only at shared
+// points, which the line tool guarantees by splitting at snap points.
+//
+// Faces are cached by the coordinates of their loops, so after an edit only
+// regions whose boundary actually moved are rebuilt. Dragging one point
+// therefore costs a graph walk plus one or two MakeFace calls.
+class ProfileBuilder {
+public:
+    // Local x/y map to the axes' XDirection/YDirection
+    explicit ProfileBuilder(const gp_Ax3& plane);
+
+    const std::vector<ProfileRegion>& update(const std::vector<ProfilePoint>& points,
+                                             const std::vector<ProfileSegment>& segments);
+
+    const std::vector<ProfileRegion>& getRegions() const { return m_regions; }
+
+    // Regions at even depth combined, so a loop inside a loop is a hole and
+    // a loop inside that an island again; this is the default extrude profile
+    TopoDS_Shape getProfile() const;
+
+    // Faces built (not reused) by the last update()
+    size_t getLastRebuildCount() const { return m_lastRebuildCount; }
+
+private:
+    TopoDS_Face buildFace(const std::vector<ProfilePoint>& points, const ProfileRegion& region) const;
+
+    gp_Ax3 m_plane;
+    std::vector<ProfileRegion> m_regions;
+    std::unordered_map<uint64_t, TopoDS_Face> m_faces;
+    size_t m_lastRebuildCount = 0;
+};
+
+} // namespace badcad
@@ -0,0 +1,142 @@
+#include "shape_properties.h"
+#include "../utils/log.h"
+#include "../utils/task_scheduler.h"
+#include "../utils/trace.h"
+#include <functional>
+
+#include <BRepBndLib.hxx>
+#include <BRepGProp.hxx>
+#include <GProp_GProps.hxx>
+#include <GProp_PrincipalProps.hxx>
+#include <Standard_Failure.hxx>
+
+namespace badcad {
+
+namespace {
+
+// Shapes whose results are kept, enough for switching between the bodies of a part
+constexpr size_t kPropertiesCacheEntries = 32;
+
+} // namespace
+
+ShapePropertiesService& ShapePropertiesService::instance() {
+    static ShapePropertiesService service;
+    return service;
+}
+
+template <typename Update>
+void ShapePropertiesService::publish(const TopoDS_Shape& shape, size_t hash, Update update) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    for (Entry& entry : m_entries) {
+        if (entry.hash == hash && entry.shape.IsEqual(shape)) {
+            auto next = std::make_shared<ShapeProperties>(*entry.properties);
+            update(*next);
+            entry.properties = std::move(next);
+            return;
+        }
+    }
+}
+
+std::shared_ptr<const ShapeProperties> ShapePropertiesService::request(const TopoDS_Shape& shape) {
+    auto empty = std::make_shared<const ShapeProperties>();
+    if (shape.IsNull()) {
+        return empty;
+    }
+    const size_t hash = std::hash<TopoDS_Shape>()(shape);
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        for (auto it = m_entries.begin(); it != m_entries.end(); ++it) {
+            if (it->hash == hash && it->shape.IsEqual(shape)) {
+                m_entries.splice(m_entries.begin(), m_entries, it);
+                return it->properties;
+            }
+        }
+        m_entries.push_front({hash, shape, empty});
+        if (m_entries.size() > kPropertiesCacheEntries) {
+            m_entries.pop_back();
+        }
+    }
+
+    // Separate tasks so the cheap results are not stuck behind the volume integration
+    TaskScheduler& scheduler = TaskScheduler::instance();
+    scheduler.submit([this, shape, hash]() {
+        BADCAD_TRACE_SCOPE_CAT("ShapeProperties bounds", "geometry");
+        Bnd_Box box;
+        Bnd_OBB orientedBox;
+        std::string error;
+        try {
+            BRepBndLib::Add(shape, box, Standard_True);
+            BRepBndLib::AddOBB(shape, orientedBox, Standard_True, Standard_False, Standard_False);
+        } catch (Standard_Failure const& e) {
+            error = std::string("Bounds: ") + e.GetMessageString();
+        }
+        publish(shape, hash, [&](ShapeProperties& properties) {
+            properties.box = box;
+            properties.orientedBox = orientedBox;
+            properties.hasBounds = true;
+            if (!error.empty() && properties.error.empty()) {
+                properties.error = error;
+            }
+        });
+    }, TaskPriority::Background);
+
+    scheduler.submit([this, shape, hash]() {
+        BADCAD_TRACE_SCOPE_CAT("ShapeProperties area", "geometry");
+        double area = 0.0;
+        std::string error;
+        try {
+            GProp_GProps props;
+            BRepGProp::SurfaceProperties(shape, props, Standard_True);
+            area = props.Mass();
+        } catch (Standard_Failure const& e) {
+            error = std::string("Area: ") + e.GetMessageString();
+        }
+        publish(shape, hash, [&](ShapeProperties& properties) {
+            properties.area = area;
+            properties.hasArea = true;
+            if (!error.empty() && properties.error.empty()) {
+                properties.error = error;
+            }
+        });
+    }, TaskPriority::Background);
+
+    scheduler.submit([this, shape, hash]() {
+        BADCAD_TRACE_SCOPE_CAT("ShapeProperties volume", "geometry");
+        GProp_GProps props;
+        double moments[3] = {};
+        std::string error;
+        try {
+            // Shared faces are skipped so compounds of touching solids are not counted twice
+            BRepGProp::VolumeProperties(shape, props, Standard_False, Standard_True);
+            if (props.Mass() > 0.0) {
+                props.PrincipalProperties().Moments(moments[0], moments[1], moments[2]);
+            }
+        } catch (Standard_Failure const& e) {
+            error = std::string("Volume: ") + e.GetMessageString();
+        }
+        publish(shape, hash, [&](ShapeProperties& properties) {
+            properties.volume = props.Mass();
+            properties.centroid = props.CentreOfMass();
+            properties.inertia = props.MatrixOfInertia();
+            for (int i = 0; i < 3; i++) {
+                properties.principalMoments[i] = moments[i];
+            }
+            properties.hasVolume = true;
+            if (!error.empty() && properties.error.empty()) {
+                properties.error = error;
+            }
+        });
+        if (!error.empty()) {
+            BADCAD_LOG_WARN("Mass properties failed: ", error);
+        }
+    }, TaskPriority::Background);
+
+    return empty;
+}
+
+void ShapePropertiesService::clear() {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_entries.clear();
+}
+
+} // namespace badcad
@@ -0,0 +1,72 @@
+#pragma once
+
+#include <cstddef>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <Bnd_Box.hxx>
+#include <Bnd_OBB.hxx>
+#include <gp_Mat.hxx>
+#include <gp_Pnt.hxx>
+#include <TopoDS_Shape.hxx>
+
+namespace badcad {
+
+// Bounds and mass properties of a shape. Each group is computed by its own
+// task and becomes valid when its flag is set, fastest first.
+struct ShapeProperties {
+    bool hasBounds = false;
+    Bnd_Box box;                    // Axis-aligned
+    Bnd_OBB orientedBox;
+
+    bool hasArea = false;
+    double area = 0.0;
+
+    bool hasVolume = false;
+    double volume = 0.0;
+    gp_Pnt centroid;
+    gp_Mat inertia;                 // About the centroid, unit density
+    double principalMoments[3] = {};
+
+    std::string error;              // First stage that failed, if any
+
+    bool isComplete() const { return hasBounds && hasArea && hasVolume; }
+};
+
+// Deferred BRepBndLib/BRepGProp results (SPECIFICATION.md: mass and BOM data
+// only when a panel asks for it).
+//
+// request() never blocks: the first call for a shape starts the bounds, area
+// and volume integrations as background tasks and returns what is known so
+// far; later calls return newer snapshots as stages finish. Results are kept
+// for recently requested shapes, keyed by shape identity like
+// TopologyIndexCache. Thread-safe.
+class ShapePropertiesService {
+public:
+    static ShapePropertiesService& instance();
+
+    // Never null; empty until the first stage finishes
+    std::shared_ptr<const ShapeProperties> request(const TopoDS_Shape& shape);
+
+    void clear();
+
+private:
+    struct Entry {
+        size_t hash;
+        TopoDS_Shape shape;
+        std::shared_ptr<const ShapeProperties> properties;
+    };
+
+    ShapePropertiesService() = default;
+
+    // Copies the entry's snapshot, applies update and swaps the copy in, so
+    // snapshots handed out are never modified. Dropped if the entry is gone.
+    template <typename Update>
+    void publish(const TopoDS_Shape& shape, size_t hash, Update update);
+
+    std::mutex m_mutex;
+    std::list<Entry> m_entries;     // Most recently requested first
+};
+
+} // namespace badcad
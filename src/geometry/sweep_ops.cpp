@@ -0,0 +1,78 @@
+#include "sweep_ops.h"
+#include "feature_cache.h"
+#include "../utils/log.h"
+#include "../utils/trace.h"
+#include <chrono>
+#include <functional>
+#include <sstream>
+
+#include <BRepPrimAPI_MakePrism.hxx>
+#include <BRepPrimAPI_MakeRevol.hxx>
+#include <Standard_Failure.hxx>
+
+namespace badcad {
+
+namespace {
+
+SweepResult runSweep(const char* name, const std::string& definition, const TopoDS_Shape& profile,
+                     const std::function<TopoDS_Shape()>& build) {
+    SweepResult result;
+    auto start = std::chrono::steady_clock::now();
+    if (profile.IsNull()) {
+        result.error = "Empty profile";
+        return result;
+    }
+
+    FeatureResultCache& cache = FeatureResultCache::instance();
+    uint64_t key = FeatureResultCache::makeKey(definition, {FeatureResultCache::hashShape(profile)});
+    if (cache.find(key, result.shape)) {
+        result.fromCache = true;
+    } else {
+        try {
+            result.shape = build();
+        } catch (Standard_Failure const& e) {
+            result.error = e.GetMessageString();
+        }
+        if (result.shape.IsNull()) {
+            if (result.error.empty()) {
+                result.error = std::string(name) + " failed";
+            }
+            BADCAD_LOG_WARN(name, " failed: ", result.error);
+        } else {
+            cache.insert(key, result.shape);
+        }
+    }
+
+    std::chrono::duration<double, std::milli> elapsed = std::chrono::steady_clock::now() - start;
+    result.elapsedMs = elapsed.count();
+    return result;
+}
+
+} // namespace
+
+SweepResult makeExtrude(const TopoDS_Shape& profile, const gp_Vec& direction) {
+    BADCAD_TRACE_SCOPE_CAT("makeExtrude", "geometry");
+    std::ostringstream definition;
+    definition.precision(17);
+    definition << "feature extrude " << direction.X() << " " << direction.Y() << " " << direction.Z();
+    return runSweep("Extrude", definition.str(), profile, [&]() {
+        BRepPrimAPI_MakePrism prism(profile, direction, Standard_True);
+        return prism.IsDone() ? prism.Shape() : TopoDS_Shape();
+    });
+}
+
+SweepResult makeRevolve(const TopoDS_Shape& profile, const gp_Ax1& axis, double angle) {
+    BADCAD_TRACE_SCOPE_CAT("makeRevolve", "geometry");
+    const gp_Pnt& origin = axis.Location();
+    const gp_Dir& direction = axis.Direction();
+    std::ostringstream definition;
+    definition.precision(17);
+    definition << "feature revolve " << origin.X() << " " << origin.Y() << " " << origin.Z() << " "
+               << direction.X() << " " << direction.Y() << " " << direction.Z() << " " << angle;
+    return runSweep("Revolve", definition.str(), profile, [&]() {
+        BRepPrimAPI_MakeRevol revol(profile, axis, angle, Standard_True);
+        return revol.IsDone() ? revol.Shape() : TopoDS_Shape();
+    });
+}
+
+} // namespace badcad
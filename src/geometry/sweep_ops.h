@@ -0,0 +1,31 @@
+#pragma once
+
+#include <string>
+#include <gp_Ax1.hxx>
+#include <gp_Vec.hxx>
+#include <TopoDS_Shape.hxx>
+
+namespace badcad {
+
+struct SweepResult {
+    TopoDS_Shape shape;             // Null on failure
+    std::string error;
+    bool fromCache = false;
+    double elapsedMs = 0.0;
+
+    bool isDone() const { return !shape.IsNull(); }
+};
+
+// The `feature extrude` and `feature revolve` records of DOCUMENT_FORMAT.md.
+// Both look the result up in FeatureResultCache first and store it there
+// afterwards, keyed by the parameters and the profile's content hash. They
+// block, so commit edits from a job; while a value is being dragged the
+// viewport shows a SweepPreview instead.
+
+// Prism of the profile faces along direction (its length is the depth)
+SweepResult makeExtrude(const TopoDS_Shape& profile, const gp_Vec& direction);
+
+// Profile faces rotated about axis by angle radians
+SweepResult makeRevolve(const TopoDS_Shape& profile, const gp_Ax1& axis, double angle);
+
+} // namespace badcad
@@ -0,0 +1,173 @@
+#include "topology_index.h"
+#include "../utils/log.h"
+#include "../utils/task_scheduler.h"
+#include "../utils/trace.h"
+#include <algorithm>
+#include <functional>
+
+#include <TopExp.hxx>
+#include <TopExp_Explorer.hxx>
+#include <TopoDS.hxx>
+
+namespace badcad {
+
+namespace {
+
+// Shapes whose indices are kept; a part plus the results of the last few
+// features it was built from
+constexpr size_t kTopologyCacheEntries = 16;
+
+// Estimated size of one entry of a TopTools_IndexedMapOfShape
+constexpr size_t kMapEntryBytes = 64;
+
+} // namespace
+
+TopologyIds TopologyIndex::Adjacency::get(int row) const {
+    TopologyIds ids;
+    if (row < 0 || row + 1 >= (int)offsets.size()) {
+        return ids;
+    }
+    ids.first = this->ids.data() + offsets[row];
+    ids.last = this->ids.data() + offsets[row + 1];
+    return ids;
+}
+
+TopologyIndex::TopologyIndex(const TopoDS_Shape& shape) : m_shape(shape) {
+    BADCAD_TRACE_SCOPE_CAT("TopologyIndex::build", "geometry");
+    if (shape.IsNull()) {
+        return;
+    }
+    TopExp::MapShapes(shape, TopAbs_FACE, m_faces);
+    TopExp::MapShapes(shape, TopAbs_EDGE, m_edges);
+    TopExp::MapShapes(shape, TopAbs_VERTEX, m_vertices);
+
+    // Edges per face, in parallel: the maps are only read from here on
+    const int faceCount = m_faces.Extent();
+    std::vector<std::vector<int>> faceEdges(faceCount);
+    TaskScheduler::instance().parallelFor(0, faceCount, 256, [&](size_t begin, size_t end) {
+        for (size_t face = begin; face < end; face++) {
+            std::vector<int>& edges = faceEdges[face];
+            for (TopExp_Explorer explorer(m_faces((int)face + 1), TopAbs_EDGE); explorer.More(); explorer.Next()) {
+                int edge = m_edges.FindIndex(explorer.Current()) - 1;
+                // Seam edges appear twice, once per orientation
+                if (edge >= 0 && std::find(edges.begin(), edges.end(), edge) == edges.end()) {
+                    edges.push_back(edge);
+                }
+            }
+        }
+    });
+
+    // Flatten, then invert into faces per edge with a counting pass
+    const int edgeCount = m_edges.Extent();
+    std::vector<int> edgeFaceCounts(edgeCount, 0);
+    m_faceEdges.offsets.reserve(faceCount + 1);
+    for (const std::vector<int>& edges : faceEdges) {
+        m_faceEdges.offsets.push_back((int)m_faceEdges.ids.size());
+        m_faceEdges.ids.insert(m_faceEdges.ids.end(), edges.begin(), edges.end());
+        for (int edge : edges) {
+            edgeFaceCounts[edge]++;
+        }
+    }
+    m_faceEdges.offsets.push_back((int)m_faceEdges.ids.size());
+
+    m_edgeFaces.offsets.resize(edgeCount + 1, 0);
+    for (int edge = 0; edge < edgeCount; edge++) {
+        m_edgeFaces.offsets[edge + 1] = m_edgeFaces.offsets[edge] + edgeFaceCounts[edge];
+    }
+    m_edgeFaces.ids.resize(m_edgeFaces.offsets.back());
+    std::vector<int> cursor(m_edgeFaces.offsets.begin(), m_edgeFaces.offsets.end() - 1);
+    for (int face = 0; face < faceCount; face++) {
+        for (int edge : faceEdges[face]) {
+            m_edgeFaces.ids[cursor[edge]++] = face;
+        }
+    }
+
+    m_edgeVertices.offsets.reserve(edgeCount + 1);
+    m_edgeVertices.ids.reserve(2 * edgeCount);
+    for (int edge = 0; edge < edgeCount; edge++) {
+        m_edgeVertices.offsets.push_back((int)m_edgeVertices.ids.size());
+        TopoDS_Vertex first;
+        TopoDS_Vertex last;
+        TopExp::Vertices(TopoDS::Edge(m_edges(edge + 1)), first, last);
+        int firstId = first.IsNull() ? -1 : m_vertices.FindIndex(first) - 1;
+        int lastId = last.IsNull() ? -1 : m_vertices.FindIndex(last) - 1;
+        if (firstId >= 0) {
+            m_edgeVertices.ids.push_back(firstId);
+        }
+        if (lastId >= 0 && lastId != firstId) {
+            m_edgeVertices.ids.push_back(lastId);
+        }
+    }
+    m_edgeVertices.offsets.push_back((int)m_edgeVertices.ids.size());
+
+    m_bytes.set(getByteSize());
+}
+
+const TopoDS_Face& TopologyIndex::getFace(int id) const {
+    return TopoDS::Face(m_faces(id + 1));
+}
+
+const TopoDS_Edge& TopologyIndex::getEdge(int id) const {
+    return TopoDS::Edge(m_edges(id + 1));
+}
+
+const TopoDS_Vertex& TopologyIndex::getVertex(int id) const {
+    return TopoDS::Vertex(m_vertices(id + 1));
+}
+
+size_t TopologyIndex::getByteSize() const {
+    size_t mapEntries = (size_t)(m_faces.Extent() + m_edges.Extent() + m_vertices.Extent());
+    return mapEntries * kMapEntryBytes + m_faceEdges.getByteSize() + m_edgeFaces.getByteSize() +
+           m_edgeVertices.getByteSize();
+}
+
+TopologyIndexCache& TopologyIndexCache::instance() {
+    static TopologyIndexCache cache;
+    return cache;
+}
+
+std::shared_ptr<const TopologyIndex> TopologyIndexCache::get(const TopoDS_Shape& shape) {
+    const size_t hash = std::hash<TopoDS_Shape>()(shape);
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        for (auto it = m_entries.begin(); it != m_entries.end(); ++it) {
+            if (it->hash == hash && it->index->getShape().IsEqual(shape)) {
+                m_entries.splice(m_entries.begin(), m_entries, it);
+                return it->index;
+            }
+        }
+    }
+
+    // Built outside the lock so other shapes are not held up meanwhile
+    auto index = std::make_shared<const TopologyIndex>(shape);
+    BADCAD_LOG_DEBUG("Indexed ", index->getFaceCount(), " faces, ", index->getEdgeCount(), " edges, ",
+                     index->getVertexCount(), " vertices");
+
+    std::lock_guard<std::mutex> lock(m_mutex);
+    for (auto it = m_entries.begin(); it != m_entries.end(); ++it) {
+        if (it->hash == hash && it->index->getShape().IsEqual(shape)) {
+            m_entries.splice(m_entries.begin(), m_entries, it);
+            return it->index;
+        }
+    }
+    m_entries.push_front({hash, index});
+    if (m_entries.size() > kTopologyCacheEntries) {
+        m_entries.pop_back();
+    }
+    return index;
+}
+
+void TopologyIndexCache::invalidate(const TopoDS_Shape& shape) {
+    const size_t hash = std::hash<TopoDS_Shape>()(shape);
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_entries.remove_if([&](const Entry& entry) {
+        return entry.hash == hash && entry.index->getShape().IsEqual(shape);
+    });
+}
+
+void TopologyIndexCache::clear() {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_entries.clear();
+}
+
+} // namespace badcad
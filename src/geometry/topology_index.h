@@ -0,0 +1,116 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <vector>
+#include "../utils/memory_tracker.h"
+#include <TopoDS_Edge.hxx>
+#include <TopoDS_Face.hxx>
+#include <TopoDS_Shape.hxx>
+#include <TopoDS_Vertex.hxx>
+#include <TopTools_IndexedMapOfShape.hxx>
+
+namespace badcad {
+
+// A run of IDs from one of TopologyIndex's adjacency tables
+struct TopologyIds {
+    const int* first = nullptr;
+    const int* last = nullptr;
+
+    const int* begin() const { return first; }
+    const int* end() const { return last; }
+    size_t size() const { return (size_t)(last - first); }
+    bool empty() const { return first == last; }
+};
+
+// Faces, edges and vertices of a shape with their adjacency, i.e. the cached
+// TopExp_Explorer results of SPECIFICATION.md §7.
+//
+// IDs are 0-based positions in TopTools_IndexedMapOfShape, filled in explorer
+// order with shared sub-shapes counted once, so the same shape always gets
+// the same IDs. Built once in the constructor and never modified afterwards;
+// concurrent reads from any number of threads are safe.
+class TopologyIndex {
+public:
+    explicit TopologyIndex(const TopoDS_Shape& shape);
+
+    TopologyIndex(const TopologyIndex&) = delete;
+    TopologyIndex& operator=(const TopologyIndex&) = delete;
+
+    const TopoDS_Shape& getShape() const { return m_shape; }
+
+    int getFaceCount() const { return m_faces.Extent(); }
+    int getEdgeCount() const { return m_edges.Extent(); }
+    int getVertexCount() const { return m_vertices.Extent(); }
+
+    const TopoDS_Face& getFace(int id) const;
+    const TopoDS_Edge& getEdge(int id) const;
+    const TopoDS_Vertex& getVertex(int id) const;
+
+    // -1 if it is not a sub-shape; orientation is ignored
+    int findFace(const TopoDS_Shape& face) const { return m_faces.FindIndex(face) - 1; }
+    int findEdge(const TopoDS_Shape& edge) const { return m_edges.FindIndex(edge) - 1; }
+    int findVertex(const TopoDS_Shape& vertex) const { return m_vertices.FindIndex(vertex) - 1; }
+
+    // Faces an edge bounds: two on a closed solid, one on an open boundary
+    TopologyIds getEdgeFaces(int edgeId) const { return m_edgeFaces.get(edgeId); }
+    TopologyIds getFaceEdges(int faceId) const { return m_faceEdges.get(faceId); }
+    // One vertex for closed edges such as full circles
+    TopologyIds getEdgeVertices(int edgeId) const { return m_edgeVertices.get(edgeId); }
+
+    size_t getByteSize() const;
+
+private:
+    // Compressed rows: the IDs of row i are ids[offsets[i] .. offsets[i + 1])
+    struct Adjacency {
+        std::vector<int> offsets;
+        std::vector<int> ids;
+
+        TopologyIds get(int row) const;
+        size_t getByteSize() const { return (offsets.size() + ids.size()) * sizeof(int); }
+    };
+
+    TopoDS_Shape m_shape;
+    TopTools_IndexedMapOfShape m_faces;
+    TopTools_IndexedMapOfShape m_edges;
+    TopTools_IndexedMapOfShape m_vertices;
+    Adjacency m_faceEdges;
+    Adjacency m_edgeFaces;
+    Adjacency m_edgeVertices;
+    TrackedBytes m_bytes{MemoryTag::Document};
+};
+
+// Indices of recently used shapes, shared by selection, picking,
+// tessellation and export so a part is walked once per version.
+//
+// Entries are keyed by shape identity (TShape, location and orientation,
+// which the sub-shapes inherit). OCC never edits the topology of a built
+// shape in place, so a modified part is a different TShape and gets a new
+// index; the old one ages out. Thread-safe.
+class TopologyIndexCache {
+public:
+    static TopologyIndexCache& instance();
+
+    // Builds the index on a miss. Concurrent misses for the same shape may
+    // both build; one result is kept.
+    std::shared_ptr<const TopologyIndex> get(const TopoDS_Shape& shape);
+
+    void invalidate(const TopoDS_Shape& shape);
+    void clear();
+
+private:
+    struct Entry {
+        size_t hash;
+        std::shared_ptr<const TopologyIndex> index;
+    };
+
+    TopologyIndexCache() = default;
+
+    std::mutex m_mutex;
+    std::list<Entry> m_entries;     // Most recently used first
+};
+
+} // namespace badcad
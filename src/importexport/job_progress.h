@@ -0,0 +1,26 @@
+#pragma once
+
+#include "../utils/job.h"
+#include <Message_ProgressIndicator.hxx>
+#include <Message_ProgressScope.hxx>
+
+namespace badcad {
+
+// Maps OCC progress (transfers, BRepMesh) onto a span of a job's progress
+// bar and lets the OCC algorithm stop early when the job is cancelled
+class JobProgress : public Message_ProgressIndicator {
+public:
+    JobProgress(Job& job, float start, float span) : m_job(job), m_start(start), m_span(span) {}
+
+    Standard_Boolean UserBreak() override { return m_job.isCancelled(); }
+    void Show(const Message_ProgressScope&, const Standard_Boolean) override {
+        m_job.setProgress(m_start + m_span * (float)GetPosition());
+    }
+
+private:
+    Job& m_job;
+    float m_start;
+    float m_span;
+};
+
+} // namespace badcad
@@ -0,0 +1,635 @@
+#include "mesh_exporter.h"
+#include "job_progress.h"
+#include "../utils/log.h"
+#include "../utils/task_scheduler.h"
+#include "../utils/trace.h"
+#include <algorithm>
+#include <atomic>
+#include <cctype>
+#include <charconv>
+#include <chrono>
+#include <cmath>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <limits>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+#include <BRep_Builder.hxx>
+#include <BRep_Tool.hxx>
+#include <BRepBuilderAPI_Copy.hxx>
+#include <BRepMesh_IncrementalMesh.hxx>
+#include <BRepTools.hxx>
+#include <IMeshTools_Parameters.hxx>
+#include <Poly_Triangulation.hxx>
+#include <Standard_Failure.hxx>
+#include <TopExp.hxx>
+#include <TopoDS.hxx>
+#include <TopoDS_Compound.hxx>
+#include <TopTools_IndexedDataMapOfShapeListOfShape.hxx>
+#include <TopTools_IndexedMapOfShape.hxx>
+#include <TopTools_ListIteratorOfListOfShape.hxx>
+
+#if defined(__AVX__)
+#include <immintrin.h>
+#define BADCAD_EXPORT_AVX 1
+#elif defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define BADCAD_EXPORT_SSE 1
+#endif
+
+namespace badcad {
+
+namespace {
+
+// Faces meshed and serialized per pass, which bounds the triangulations and
+// output held in memory
+constexpr size_t kExportBatchFaces = 512;
+
+// Bytes collected before each write to the file
+constexpr size_t kWriteBufferSize = 4 * 1024 * 1024;
+
+constexpr size_t kStlHeaderSize = 80;
+constexpr size_t kStlTriangleSize = 50;     // Normal, three corners, attribute word
+
+// Collects small writes into one large block per file write
+class BufferedWriter {
+public:
+    explicit BufferedWriter(const std::string& path)
+        : m_file(path, std::ios::binary), m_buffer(kWriteBufferSize) {}
+
+    bool isOpen() const { return m_file.is_open(); }
+    uint64_t getByteCount() const { return m_byteCount; }
+
+    void write(const void* data, size_t size) {
+        if (m_used + size > m_buffer.size()) {
+            flush();
+            // Large face chunks skip the copy
+            if (size >= m_buffer.size()) {
+                m_file.write(static_cast<const char*>(data), (std::streamsize)size);
+                m_byteCount += size;
+                return;
+            }
+        }
+        std::memcpy(m_buffer.data() + m_used, data, size);
+        m_used += size;
+        m_byteCount += size;
+    }
+
+    // Overwrites bytes already written, e.g. a count known only at the end
+    void writeAt(uint64_t offset, const void* data, size_t size) {
+        flush();
+        m_file.seekp((std::streamoff)offset);
+        m_file.write(static_cast<const char*>(data), (std::streamsize)size);
+        m_file.seekp(0, std::ios::end);
+    }
+
+    // False if any write failed
+    bool close() {
+        flush();
+        m_file.close();
+        return !m_file.fail();
+    }
+
+private:
+    void flush() {
+        if (m_used > 0) {
+            m_file.write(m_buffer.data(), (std::streamsize)m_used);
+            m_used = 0;
+        }
+    }
+
+    std::ofstream m_file;
+    std::vector<char> m_buffer;
+    size_t m_used = 0;
+    uint64_t m_byteCount = 0;
+};
+
+// One face's triangulation in structure-of-arrays form for the kernels below.
+// Reused for every face of a chunk so serializing does not allocate per face.
+struct FaceScratch {
+    std::vector<float> x, y, z;                 // Nodes in world space
+    std::vector<uint32_t> triangles;            // Node indices, three per triangle, outward winding
+    std::vector<float> corners[9];              // ax, ay, az, bx, by, bz, cx, cy, cz per triangle
+    std::vector<float> nx, ny, nz;              // Per triangle, twice the area long
+    std::vector<float> vx, vy, vz;              // Per node, OBJ only
+};
+
+// n = (b - a) x (c - a) per triangle. Left unnormalized: its length is
+// twice the triangle's area, so summing them weights vertex normals by area.
+void crossTriangles(const std::vector<float> (&c)[9], size_t count, float* nx, float* ny, float* nz) {
+    size_t i = 0;
+
+#if defined(BADCAD_EXPORT_AVX)
+    for (; i + 8 <= count; i += 8) {
+        __m256 ax = _mm256_loadu_ps(c[0].data() + i), ay = _mm256_loadu_ps(c[1].data() + i), az = _mm256_loadu_ps(c[2].data() + i);
+        __m256 ux = _mm256_sub_ps(_mm256_loadu_ps(c[3].data() + i), ax);
+        __m256 uy = _mm256_sub_ps(_mm256_loadu_ps(c[4].data() + i), ay);
+        __m256 uz = _mm256_sub_ps(_mm256_loadu_ps(c[5].data() + i), az);
+        __m256 vx = _mm256_sub_ps(_mm256_loadu_ps(c[6].data() + i), ax);
+        __m256 vy = _mm256_sub_ps(_mm256_loadu_ps(c[7].data() + i), ay);
+        __m256 vz = _mm256_sub_ps(_mm256_loadu_ps(c[8].data() + i), az);
+        _mm256_storeu_ps(nx + i, _mm256_sub_ps(_mm256_mul_ps(uy, vz), _mm256_mul_ps(uz, vy)));
+        _mm256_storeu_ps(ny + i, _mm256_sub_ps(_mm256_mul_ps(uz, vx), _mm256_mul_ps(ux, vz)));
+        _mm256_storeu_ps(nz + i, _mm256_sub_ps(_mm256_mul_ps(ux, vy), _mm256_mul_ps(uy, vx)));
+    }
+#elif defined(BADCAD_EXPORT_SSE)
+    for (; i + 4 <= count; i += 4) {
+        __m128 ax = _mm_loadu_ps(c[0].data() + i), ay = _mm_loadu_ps(c[1].data() + i), az = _mm_loadu_ps(c[2].data() + i);
+        __m128 ux = _mm_sub_ps(_mm_loadu_ps(c[3].data() + i), ax);
+        __m128 uy = _mm_sub_ps(_mm_loadu_ps(c[4].data() + i), ay);
+        __m128 uz = _mm_sub_ps(_mm_loadu_ps(c[5].data() + i), az);
+        __m128 vx = _mm_sub_ps(_mm_loadu_ps(c[6].data() + i), ax);
+        __m128 vy = _mm_sub_ps(_mm_loadu_ps(c[7].data() + i), ay);
+        __m128 vz = _mm_sub_ps(_mm_loadu_ps(c[8].data() + i), az);
+        _mm_storeu_ps(nx + i, _mm_sub_ps(_mm_mul_ps(uy, vz), _mm_mul_ps(uz, vy)));
+        _mm_storeu_ps(ny + i, _mm_sub_ps(_mm_mul_ps(uz, vx), _mm_mul_ps(ux, vz)));
+        _mm_storeu_ps(nz + i, _mm_sub_ps(_mm_mul_ps(ux, vy), _mm_mul_ps(uy, vx)));
+    }
+#endif
+
+    // Scalar tail (and the whole face on targets without SSE2)
+    for (; i < count; i++) {
+        float ux = c[3][i] - c[0][i], uy = c[4][i] - c[1][i], uz = c[5][i] - c[2][i];
+        float vx = c[6][i] - c[0][i], vy = c[7][i] - c[1][i], vz = c[8][i] - c[2][i];
+        nx[i] = uy * vz - uz * vy;
+        ny[i] = uz * vx - ux * vz;
+        nz[i] = ux * vy - uy * vx;
+    }
+}
+
+// Scales vectors to unit length; zero vectors (degenerate triangles) stay zero
+void normalizeVectors(float* x, float* y, float* z, size_t count) {
+    size_t i = 0;
+
+#if defined(BADCAD_EXPORT_AVX)
+    const __m256 zero = _mm256_setzero_ps();
+    const __m256 one = _mm256_set1_ps(1.0f);
+    for (; i + 8 <= count; i += 8) {
+        __m256 px = _mm256_loadu_ps(x + i), py = _mm256_loadu_ps(y + i), pz = _mm256_loadu_ps(z + i);
+        __m256 length2 = _mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(px, px), _mm256_mul_ps(py, py)), _mm256_mul_ps(pz, pz));
+        __m256 scale = _mm256_and_ps(_mm256_cmp_ps(length2, zero, _CMP_GT_OQ),
+                                     _mm256_div_ps(one, _mm256_sqrt_ps(length2)));
+        _mm256_storeu_ps(x + i, _mm256_mul_ps(px, scale));
+        _mm256_storeu_ps(y + i, _mm256_mul_ps(py, scale));
+        _mm256_storeu_ps(z + i, _mm256_mul_ps(pz, scale));
+    }
+#elif defined(BADCAD_EXPORT_SSE)
+    const __m128 zero = _mm_setzero_ps();
+    const __m128 one = _mm_set1_ps(1.0f);
+    for (; i + 4 <= count; i += 4) {
+        __m128 px = _mm_loadu_ps(x + i), py = _mm_loadu_ps(y + i), pz = _mm_loadu_ps(z + i);
+        __m128 length2 = _mm_add_ps(_mm_add_ps(_mm_mul_ps(px, px), _mm_mul_ps(py, py)), _mm_mul_ps(pz, pz));
+        __m128 scale = _mm_and_ps(_mm_cmpgt_ps(length2, zero), _mm_div_ps(one, _mm_sqrt_ps(length2)));
+        _mm_storeu_ps(x + i, _mm_mul_ps(px, scale));
+        _mm_storeu_ps(y + i, _mm_mul_ps(py, scale));
+        _mm_storeu_ps(z + i, _mm_mul_ps(pz, scale));
+    }
+#endif
+
+    for (; i < count; i++) {
+        float length2 = x[i] * x[i] + y[i] * y[i] + z[i] * z[i];
+        float scale = length2 > 0.0f ? 1.0f / std::sqrt(length2) : 0.0f;
+        x[i] *= scale;
+        y[i] *= scale;
+        z[i] *= scale;
+    }
+}
+
+// Fills scratch with the face's triangulation and triangle cross products.
+// False for faces BRepMesh left without triangles (degenerate ones).
+bool loadFace(const TopoDS_Face& face, FaceScratch& scratch) {
+    TopLoc_Location location;
+    Handle(Poly_Triangulation) triangulation = BRep_Tool::Triangulation(face, location);
+    if (triangulation.IsNull() || triangulation->NbTriangles() == 0) {
+        return false;
+    }
+    const bool transformed = !location.IsIdentity();
+    const gp_Trsf& transform = location.Transformation();
+    const bool reversed = face.Orientation() == TopAbs_REVERSED;
+
+    const size_t nodeCount = (size_t)triangulation->NbNodes();
+    scratch.x.resize(nodeCount);
+    scratch.y.resize(nodeCount);
+    scratch.z.resize(nodeCount);
+    for (size_t i = 0; i < nodeCount; i++) {
+        gp_Pnt point = triangulation->Node((int)i + 1);
+        if (transformed) {
+            point.Transform(transform);
+        }
+        scratch.x[i] = (float)point.X();
+        scratch.y[i] = (float)point.Y();
+        scratch.z[i] = (float)point.Z();
+    }
+
+    const size_t triangleCount = (size_t)triangulation->NbTriangles();
+    scratch.triangles.resize(3 * triangleCount);
+    for (std::vector<float>& corner : scratch.corners) {
+        corner.resize(triangleCount);
+    }
+    for (size_t i = 0; i < triangleCount; i++) {
+        int n[3];
+        triangulation->Triangle((int)i + 1).Get(n[0], n[1], n[2]);
+        if (reversed) {
+            std::swap(n[1], n[2]);
+        }
+        for (int k = 0; k < 3; k++) {
+            uint32_t node = (uint32_t)(n[k] - 1);
+            scratch.triangles[3 * i + k] = node;
+            scratch.corners[3 * k][i] = scratch.x[node];
+            scratch.corners[3 * k + 1][i] = scratch.y[node];
+            scratch.corners[3 * k + 2][i] = scratch.z[node];
+        }
+    }
+
+    scratch.nx.resize(triangleCount);
+    scratch.ny.resize(triangleCount);
+    scratch.nz.resize(triangleCount);
+    crossTriangles(scratch.corners, triangleCount, scratch.nx.data(), scratch.ny.data(), scratch.nz.data());
+    return true;
+}
+
+// Binary STL records. Written as raw floats: the format is little-endian,
+// like every platform we build for.
+void appendStlFace(FaceScratch& scratch, std::string& out) {
+    const size_t triangleCount = scratch.nx.size();
+    normalizeVectors(scratch.nx.data(), scratch.ny.data(), scratch.nz.data(), triangleCount);
+
+    const size_t start = out.size();
+    out.resize(start + triangleCount * kStlTriangleSize);
+    char* record = &out[start];
+    for (size_t i = 0; i < triangleCount; i++) {
+        const float values[12] = {
+            scratch.nx[i], scratch.ny[i], scratch.nz[i],
+            scratch.corners[0][i], scratch.corners[1][i], scratch.corners[2][i],
+            scratch.corners[3][i], scratch.corners[4][i], scratch.corners[5][i],
+            scratch.corners[6][i], scratch.corners[7][i], scratch.corners[8][i],
+        };
+        std::memcpy(record, values, sizeof(values));
+        record[48] = 0;
+        record[49] = 0;
+        record += kStlTriangleSize;
+    }
+}
+
+char* appendFloat(char* first, char* last, float value) {
+    return std::to_chars(first, last, value).ptr;
+}
+
+// v and vn lines for every node, then f lines. firstVertex is the 1-based
+// OBJ index of the face's first node.
+void appendObjFace(FaceScratch& scratch, uint64_t firstVertex, std::string& out) {
+    const size_t nodeCount = scratch.x.size();
+    const size_t triangleCount = scratch.nx.size();
+
+    // Area-weighted vertex normals; nodes are not shared between faces, so
+    // edges between faces stay sharp
+    scratch.vx.assign(nodeCount, 0.0f);
+    scratch.vy.assign(nodeCount, 0.0f);
+    scratch.vz.assign(nodeCount, 0.0f);
+    for (size_t i = 0; i < triangleCount; i++) {
+        for (int k = 0; k < 3; k++) {
+            uint32_t node = scratch.triangles[3 * i + k];
+            scratch.vx[node] += scratch.nx[i];
+            scratch.vy[node] += scratch.ny[i];
+            scratch.vz[node] += scratch.nz[i];
+        }
+    }
+    normalizeVectors(scratch.vx.data(), scratch.vy.data(), scratch.vz.data(), nodeCount);
+
+    char line[192];
+    char* const end = line + sizeof(line);
+    auto appendVector = [&](const char* prefix, float x, float y, float z) {
+        char* p = line;
+        *p++ = prefix[0];
+        if (prefix[1]) {
+            *p++ = prefix[1];
+        }
+        *p++ = ' ';
+        p = appendFloat(p, end, x);
+        *p++ = ' ';
+        p = appendFloat(p, end, y);
+        *p++ = ' ';
+        p = appendFloat(p, end, z);
+        *p++ = '\n';
+        out.append(line, p - line);
+    };
+    for (size_t i = 0; i < nodeCount; i++) {
+        appendVector("v", scratch.x[i], scratch.y[i], scratch.z[i]);
+    }
+    for (size_t i = 0; i < nodeCount; i++) {
+        appendVector("vn", scratch.vx[i], scratch.vy[i], scratch.vz[i]);
+    }
+    for (size_t i = 0; i < triangleCount; i++) {
+        char* p = line;
+        *p++ = 'f';
+        for (int k = 0; k < 3; k++) {
+            uint64_t index = firstVertex + scratch.triangles[3 * i + k];
+            *p++ = ' ';
+            p = std::to_chars(p, end, index).ptr;
+            *p++ = '/';
+            *p++ = '/';
+            p = std::to_chars(p, end, index).ptr;
+        }
+        *p++ = '\n';
+        out.append(line, p - line);
+    }
+}
+
+enum class FaceState : uint8_t {
+    Unmeshed,
+    Kept,           // Meshed, but borders an unmeshed face
+    Released        // Written and its triangulation dropped
+};
+
+// Faces breadth-first over shared edges, as indices into the map, so that
+// consecutive faces form connected patches. outNeighbours gets each face's
+// distinct neighbours.
+std::vector<int> orderByAdjacency(const TopoDS_Shape& shape, const TopTools_IndexedMapOfShape& faces,
+                                  std::vector<std::vector<int>>& outNeighbours) {
+    const int faceCount = faces.Extent();
+    outNeighbours.assign(faceCount, {});
+    TopTools_IndexedDataMapOfShapeListOfShape edgeFaces;
+    TopExp::MapShapesAndAncestors(shape, TopAbs_EDGE, TopAbs_FACE, edgeFaces);
+    for (int edge = 1; edge <= edgeFaces.Extent(); edge++) {
+        const TopTools_ListOfShape& adjacent = edgeFaces(edge);
+        for (TopTools_ListIteratorOfListOfShape a(adjacent); a.More(); a.Next()) {
+            const int faceA = faces.FindIndex(a.Value()) - 1;
+            for (TopTools_ListIteratorOfListOfShape b(adjacent); b.More(); b.Next()) {
+                const int faceB = faces.FindIndex(b.Value()) - 1;
+                // Seam edges list their face twice
+                if (faceA >= 0 && faceB >= 0 && faceA != faceB) {
+                    outNeighbours[faceA].push_back(faceB);
+                }
+            }
+        }
+    }
+    for (std::vector<int>& list : outNeighbours) {
+        std::sort(list.begin(), list.end());
+        list.erase(std::unique(list.begin(), list.end()), list.end());
+    }
+
+    std::vector<int> order;
+    order.reserve(faceCount);
+    std::vector<bool> queued(faceCount, false);
+    for (int seed = 0; seed < faceCount; seed++) {
+        if (queued[seed]) {
+            continue;
+        }
+        queued[seed] = true;
+        size_t head = order.size();
+        order.push_back(seed);
+        for (; head < order.size(); head++) {
+            for (int neighbour : outNeighbours[order[head]]) {
+                if (!queued[neighbour]) {
+                    queued[neighbour] = true;
+                    order.push_back(neighbour);
+                }
+            }
+        }
+    }
+    return order;
+}
+
+} // namespace
+
+bool getMeshFormat(const std::string& path, MeshFormat& outFormat) {
+    std::string extension = std::filesystem::path(path).extension().string();
+    std::transform(extension.begin(), extension.end(), extension.begin(),
+                   [](unsigned char c) { return (char)std::tolower(c); });
+    if (extension == ".stl") {
+        outFormat = MeshFormat::Stl;
+        return true;
+    }
+    if (extension == ".obj") {
+        outFormat = MeshFormat::Obj;
+        return true;
+    }
+    return false;
+}
+
+JobHandle exportMesh(const TopoDS_Shape& shape, const std::string& path, const MeshExportOptions& options,
+                     std::function<void(Job& job, const MeshExportSummary& summary)> onFinished) {
+    auto summary = std::make_shared<MeshExportSummary>();
+    std::string name = "Exporting " + std::filesystem::path(path).filename().string();
+
+    return JobManager::instance().start(name, [shape, path, options, summary](Job& job) {
+        BADCAD_TRACE_SCOPE_CAT("exportMesh", "io");
+        auto startTime = std::chrono::steady_clock::now();
+        if (shape.IsNull()) {
+            throw std::runtime_error("Nothing to export");
+        }
+
+        // Meshed on a copy, like Tessellator, so the document's shape never
+        // gets a triangulation attached from a worker
+        TopTools_IndexedMapOfShape faces;
+        TopoDS_Shape copy;
+        try {
+            BRepBuilderAPI_Copy copier(shape, Standard_False, Standard_False);
+            copy = copier.Shape();
+            TopExp::MapShapes(copy, TopAbs_FACE, faces);
+        } catch (Standard_Failure const& e) {
+            throw std::runtime_error(std::string("Copying the shape failed: ") + e.GetMessageString());
+        }
+        const size_t faceCount = (size_t)faces.Extent();
+        MeshParams meshParams = Tessellator::getMeshParams(options.lod);
+        IMeshTools_Parameters parameters;
+        parameters.Deflection = meshParams.linearDeflection;
+        parameters.Angle = meshParams.angularDeflection;
+        parameters.InParallel = Standard_True;
+
+        const std::string tempPath = path + ".tmp";
+        BufferedWriter writer(tempPath);
+        if (!writer.isOpen()) {
+            throw std::runtime_error("Could not create " + tempPath);
+        }
+        if (options.format == MeshFormat::Stl) {
+            // Must not start with "solid", which readers take for ASCII STL.
+            // The count is filled in at the end.
+            char header[kStlHeaderSize] = "badCAD binary STL";
+            uint32_t count = 0;
+            writer.write(header, sizeof(header));
+            writer.write(&count, sizeof(count));
+        } else {
+            std::string header = "# badCAD mesh export, " + std::to_string(faceCount) + " faces\n";
+            writer.write(header.data(), header.size());
+        }
+
+        // One batch at a time: mesh its faces, serialize them in parallel,
+        // write them in order, then drop the triangulations nothing needs any
+        // more, so neither the mesh nor the output of the whole body is ever
+        // held at once. A face keeps its triangulation while it borders an
+        // unmeshed face and joins the batch that meshes that neighbour, where
+        // BRepMesh takes the shared edge's nodes from the existing
+        // triangulation instead of discretizing the edge again. Batches are
+        // connected patches, which keeps that border short.
+        std::vector<std::vector<int>> neighbours;
+        const std::vector<int> order = orderByAdjacency(copy, faces, neighbours);
+        std::vector<int> unmeshedNeighbours(faceCount);
+        for (size_t face = 0; face < faceCount; face++) {
+            unmeshedNeighbours[face] = (int)neighbours[face].size();
+        }
+        std::vector<FaceState> states(faceCount, FaceState::Unmeshed);
+        std::vector<size_t> joinedBatch(faceCount, faceCount);
+        auto faceAt = [&](size_t position) { return TopoDS::Face(faces(order[position] + 1)); };
+
+        std::vector<std::string> chunks(std::min(kExportBatchFaces, faceCount));
+        std::vector<uint64_t> firstVertex(chunks.size() + 1);
+        uint64_t vertexCount = 0;
+        uint64_t triangleCount = 0;
+        std::atomic<bool> failed{false};
+        std::string error;
+        BRep_Builder builder;
+        for (size_t batch = 0; batch < faceCount; batch += kExportBatchFaces) {
+            if (job.isCancelled() || failed) {
+                break;
+            }
+            BADCAD_TRACE_SCOPE_CAT("exportMesh batch", "io");
+            const size_t batchEnd = std::min(batch + kExportBatchFaces, faceCount);
+            const float progressBegin = (float)batch / (float)faceCount;
+            const float progressEnd = (float)batchEnd / (float)faceCount;
+
+            // The compound holds the copy's own faces, so the triangulations
+            // land on them. Meshed neighbours are consistent with the
+            // parameters and are left as they are.
+            job.setStatusText("Meshing");
+            TopoDS_Compound batchFaces;
+            builder.MakeCompound(batchFaces);
+            for (size_t position = batch; position < batchEnd; position++) {
+                builder.Add(batchFaces, faceAt(position));
+                for (int neighbour : neighbours[order[position]]) {
+                    if (states[neighbour] == FaceState::Kept && joinedBatch[neighbour] != batch) {
+                        joinedBatch[neighbour] = batch;
+                        builder.Add(batchFaces, faces(neighbour + 1));
+                    }
+                }
+            }
+            try {
+                BADCAD_TRACE_SCOPE_CAT("BRepMesh_IncrementalMesh", "mesh");
+                Handle(JobProgress) progress =
+                    new JobProgress(job, progressBegin, progressBegin + (progressEnd - progressBegin) * 0.5f);
+                BRepMesh_IncrementalMesh mesher(batchFaces, parameters, progress->Start());
+            } catch (Standard_Failure const& e) {
+                error = std::string("Meshing failed: ") + e.GetMessageString();
+                break;
+            }
+            if (job.isCancelled()) {
+                break;
+            }
+
+            // OBJ indices are global, so each face's first vertex follows on
+            // from everything written before it
+            for (size_t position = batch; position < batchEnd; position++) {
+                TopLoc_Location location;
+                Handle(Poly_Triangulation) triangulation = BRep_Tool::Triangulation(faceAt(position), location);
+                firstVertex[position - batch] = vertexCount + 1;
+                if (!triangulation.IsNull() && triangulation->NbTriangles() > 0) {
+                    vertexCount += (uint64_t)triangulation->NbNodes();
+                    triangleCount += (uint64_t)triangulation->NbTriangles();
+                }
+            }
+            if (options.format == MeshFormat::Stl && triangleCount > std::numeric_limits<uint32_t>::max()) {
+                error = "Too many triangles for STL";
+                break;
+            }
+
+            job.setStatusText("Writing");
+            TaskScheduler::instance().parallelFor(batch, batchEnd, 16, [&](size_t begin, size_t end) {
+                FaceScratch scratch;
+                for (size_t position = begin; position < end; position++) {
+                    std::string& chunk = chunks[position - batch];
+                    chunk.clear();
+                    try {
+                        if (!loadFace(faceAt(position), scratch)) {
+                            continue;
+                        }
+                        if (options.format == MeshFormat::Stl) {
+                            appendStlFace(scratch, chunk);
+                        } else {
+                            appendObjFace(scratch, firstVertex[position - batch], chunk);
+                        }
+                    } catch (Standard_Failure const& e) {
+                        // A missing face would break the header count and the indices after it
+                        BADCAD_LOG_ERROR("Failed to export face: ", e.GetMessageString());
+                        failed = true;
+                    } catch (...) {
+                        // Out of memory for the chunk, most likely; must not escape the worker
+                        BADCAD_LOG_ERROR("Failed to export face");
+                        failed = true;
+                    }
+                }
+            }, TaskPriority::Background);
+
+            for (size_t position = batch; position < batchEnd; position++) {
+                writer.write(chunks[position - batch].data(), chunks[position - batch].size());
+            }
+
+            // Drop the triangulations of faces whose neighbours are all meshed
+            for (size_t position = batch; position < batchEnd; position++) {
+                states[order[position]] = FaceState::Kept;
+                for (int neighbour : neighbours[order[position]]) {
+                    unmeshedNeighbours[neighbour]--;
+                }
+            }
+            TopoDS_Compound finished;
+            builder.MakeCompound(finished);
+            bool hasFinished = false;
+            auto release = [&](int face) {
+                if (states[face] == FaceState::Kept && unmeshedNeighbours[face] == 0) {
+                    states[face] = FaceState::Released;
+                    builder.Add(finished, faces(face + 1));
+                    hasFinished = true;
+                }
+            };
+            for (size_t position = batch; position < batchEnd; position++) {
+                release(order[position]);
+                for (int neighbour : neighbours[order[position]]) {
+                    release(neighbour);
+                }
+            }
+            if (hasFinished) {
+                BRepTools::Clean(finished);
+            }
+            job.setProgress(progressEnd);
+        }
+
+        if (failed) {
+            error = "Failed to export a face";
+        }
+        if (options.format == MeshFormat::Stl) {
+            uint32_t count = (uint32_t)triangleCount;
+            writer.writeAt(kStlHeaderSize, &count, sizeof(count));
+        } else {
+            std::string footer = "# " + std::to_string(triangleCount) + " triangles\n";
+            writer.write(footer.data(), footer.size());
+        }
+        const bool written = writer.close();
+        std::error_code ec;
+        if (job.isCancelled() || !error.empty() || !written) {
+            std::filesystem::remove(tempPath, ec);
+            if (job.isCancelled()) {
+                return false;
+            }
+            throw std::runtime_error(!error.empty() ? error : "Could not write " + tempPath);
+        }
+        std::filesystem::rename(tempPath, path, ec);
+        if (ec) {
+            throw std::runtime_error("Could not replace " + path + ": " + ec.message());
+        }
+
+        summary->faceCount = faceCount;
+        summary->triangleCount = triangleCount;
+        summary->byteCount = writer.getByteCount();
+        summary->elapsedMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - startTime).count();
+        BADCAD_LOG_INFO("Exported ", triangleCount, " triangles to ", path, " in ", (int)summary->elapsedMs, " ms");
+        return true;
+    }, [summary, onFinished](Job& job) {
+        if (onFinished) {
+            onFinished(job, *summary);
+        }
+    });
+}
+
+} // namespace badcad
@@ -0,0 +1,46 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <string>
+#include "../render/tessellator.h"
+#include "../utils/job.h"
+#include <TopoDS_Shape.hxx>
+
+namespace badcad {
+
+enum class MeshFormat {
+    Stl,        // Binary, facet normals
+    Obj         // Text, smoothed vertex normals per face
+};
+
+struct MeshExportOptions {
+    MeshFormat format = MeshFormat::Stl;
+    MeshLod lod = MeshLod::High;    // Deflection from Tessellator::getMeshParams()
+};
+
+struct MeshExportSummary {
+    size_t faceCount = 0;
+    uint64_t triangleCount = 0;
+    uint64_t byteCount = 0;
+    double elapsedMs = 0.0;
+};
+
+// Format from the file extension (.stl or .obj, any case); false otherwise
+bool getMeshFormat(const std::string& path, MeshFormat& outFormat);
+
+// STL/OBJ export from SPECIFICATION.md §5, as a Job.
+//
+// The faces of a private copy of the shape are handled in batches of
+// connected faces: BRepMesh meshes a batch in parallel, the task scheduler
+// serializes it and it is streamed to the file in order. Triangulations are
+// dropped once no unmeshed face borders them; until then they supply the
+// shared edges' nodes to the next batch, so the seams between batches stay
+// closed. Memory stays at about one batch of mesh and output no matter how
+// many triangles the body has. The file is written next to the target and
+// only renamed over it when complete, like saving a part.
+JobHandle exportMesh(const TopoDS_Shape& shape, const std::string& path, const MeshExportOptions& options,
+                     std::function<void(Job& job, const MeshExportSummary& summary)> onFinished);
+
+} // namespace badcad
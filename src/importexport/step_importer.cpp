@@ -0,0 +1,239 @@
+#include "step_importer.h"
+#include "job_progress.h"
+#include "../geometry/boolean_ops.h"
+#include "../utils/log.h"
+#include "../utils/task_scheduler.h"
+#include "../utils/trace.h"
+#include <atomic>
+#include <chrono>
+#include <filesystem>
+#include <stdexcept>
+#include <vector>
+
+#include <Bnd_Box.hxx>
+#include <BRep_Builder.hxx>
+#include <BRepBndLib.hxx>
+#include <BRepBuilderAPI_Copy.hxx>
+#include <IFSelect_ReturnStatus.hxx>
+#include <ShapeFix_Shape.hxx>
+#include <Standard_Failure.hxx>
+#include <STEPControl_Reader.hxx>
+#include <TopExp_Explorer.hxx>
+#include <TopLoc_Location.hxx>
+#include <TopoDS_Compound.hxx>
+#include <TopTools_IndexedMapOfShape.hxx>
+
+namespace badcad {
+
+namespace {
+
+// Share of the progress bar for the transfer; the rest is per-solid work
+constexpr float kTransferProgress = 0.3f;
+
+// A solid as it is placed in the file; instances share their definition
+struct Instance {
+    std::string name;
+    int definition;
+    TopLoc_Location location;
+};
+
+// The definition's mesh moved to where an instance sits
+std::shared_ptr<const MeshBuffers> placeMesh(const MeshBuffers& mesh, const gp_Trsf& trsf) {
+    auto placed = std::make_shared<MeshBuffers>();
+    placed->positions.resize(mesh.positions.size());
+    placed->normals.resize(mesh.normals.size());
+    placed->indices = mesh.indices;
+    const gp_Mat rotation = trsf.HVectorialPart();
+    for (size_t i = 0; i + 2 < mesh.positions.size(); i += 3) {
+        gp_XYZ point(mesh.positions[i], mesh.positions[i + 1], mesh.positions[i + 2]);
+        trsf.Transforms(point);
+        placed->positions[i] = (float)point.X();
+        placed->positions[i + 1] = (float)point.Y();
+        placed->positions[i + 2] = (float)point.Z();
+    }
+    for (size_t i = 0; i + 2 < mesh.normals.size(); i += 3) {
+        gp_XYZ normal(mesh.normals[i], mesh.normals[i + 1], mesh.normals[i + 2]);
+        normal.Multiply(rotation);
+        placed->normals[i] = (float)normal.X();
+        placed->normals[i + 1] = (float)normal.Y();
+        placed->normals[i + 2] = (float)normal.Z();
+    }
+    return placed;
+}
+
+// Squared bounding box diagonal; 0 if it has no extent
+double squareExtent(const TopoDS_Shape& shape) {
+    try {
+        Bnd_Box box;
+        BRepBndLib::Add(shape, box, Standard_False);
+        return box.IsVoid() ? 0.0 : box.SquareExtent();
+    } catch (Standard_Failure const&) {
+        return 0.0;
+    }
+}
+
+} // namespace
+
+JobHandle importStep(const std::string& path, const StepImportOptions& options,
+                     std::function<void(const ImportedPart& part)> onPart,
+                     std::function<void(Job& job, const StepImportSummary& summary)> onFinished) {
+    auto summary = std::make_shared<StepImportSummary>();
+    std::string name = "Importing " + std::filesystem::path(path).filename().string();
+
+    return JobManager::instance().start(name, [path, options, onPart, summary](Job& job) {
+        BADCAD_TRACE_SCOPE_CAT("importStep", "io");
+        auto startTime = std::chrono::steady_clock::now();
+
+        // The reader has no progress for parsing, only for the transfer
+        job.setStatusText("Reading");
+        STEPControl_Reader reader;
+        TopoDS_Shape result;
+        try {
+            if (reader.ReadFile(path.c_str()) != IFSelect_RetDone) {
+                throw std::runtime_error("Could not read " + path);
+            }
+            if (job.isCancelled()) {
+                return false;
+            }
+            job.setStatusText("Transferring");
+            Handle(JobProgress) progress = new JobProgress(job, 0.0f, kTransferProgress);
+            reader.TransferRoots(progress->Start());
+            result = reader.OneShape();
+        } catch (Standard_Failure const& e) {
+            throw std::runtime_error(std::string("STEP transfer failed: ") + e.GetMessageString());
+        }
+        if (job.isCancelled()) {
+            return false;
+        }
+        if (result.IsNull()) {
+            throw std::runtime_error("No shapes in " + path);
+        }
+
+        // Split into solids, then shells and faces that belong to none. The
+        // map ignores placement, so repeated assembly components become one
+        // definition with several instances.
+        TopTools_IndexedMapOfShape definitions;
+        std::vector<Instance> instances;
+        auto addInstance = [&](const TopoDS_Shape& shape, const std::string& instanceName) {
+            int definition = definitions.Add(shape.Located(TopLoc_Location())) - 1;
+            instances.push_back({instanceName, definition, shape.Location()});
+        };
+        int solidCount = 0;
+        for (TopExp_Explorer explorer(result, TopAbs_SOLID); explorer.More(); explorer.Next()) {
+            addInstance(explorer.Current(), "Solid " + std::to_string(++solidCount));
+        }
+        int shellCount = 0;
+        for (TopExp_Explorer explorer(result, TopAbs_SHELL, TopAbs_SOLID); explorer.More(); explorer.Next()) {
+            addInstance(explorer.Current(), "Shell " + std::to_string(++shellCount));
+        }
+        // Loose faces become one part; surface-only files can have thousands
+        BRep_Builder builder;
+        TopoDS_Compound looseFaces;
+        builder.MakeCompound(looseFaces);
+        bool hasLooseFaces = false;
+        for (TopExp_Explorer explorer(result, TopAbs_FACE, TopAbs_SHELL); explorer.More(); explorer.Next()) {
+            builder.Add(looseFaces, explorer.Current());
+            hasLooseFaces = true;
+        }
+        if (hasLooseFaces) {
+            addInstance(looseFaces, "Loose faces");
+        }
+        if (instances.empty()) {
+            throw std::runtime_error("No solids or surfaces in " + path);
+        }
+
+        const size_t definitionCount = (size_t)definitions.Extent();
+        std::vector<std::vector<size_t>> definitionInstances(definitionCount);
+        for (size_t i = 0; i < instances.size(); i++) {
+            definitionInstances[instances[i].definition].push_back(i);
+        }
+        BADCAD_LOG_INFO("STEP ", path, ": ", instances.size(), " parts, ", definitionCount, " distinct");
+
+        // Parts are meshed once, at the LOD they get while the whole file is
+        // in view, where the share of the viewport a part covers is roughly
+        // its share of the file's extent
+        const double fileExtent = squareExtent(result);
+
+        // Grain 1: solids range from a bolt to a casting, so every one is
+        // its own chunk and idle workers keep taking the next
+        job.setStatusText("Healing and meshing");
+        std::atomic<size_t> finished{0};
+        std::atomic<size_t> delivered{0};
+        std::atomic<size_t> invalid{0};
+        TaskScheduler::instance().parallelFor(0, definitionCount, 1, [&](size_t begin, size_t end) {
+            for (size_t definition = begin; definition < end; definition++) {
+                if (job.isCancelled()) {
+                    return;
+                }
+                BADCAD_TRACE_SCOPE_CAT("importStep part", "io");
+                const std::vector<size_t>& placed = definitionInstances[definition];
+                TopoDS_Shape shape = definitions((int)definition + 1);
+
+                // Healing edits edges in place (pcurves, tolerances) and the
+                // solids of a compsolid share them, so each is healed on its
+                // own copy of the topology
+                if (options.heal) {
+                    try {
+                        BRepBuilderAPI_Copy copy(shape, Standard_False, Standard_False);
+                        Handle(ShapeFix_Shape) fixer = new ShapeFix_Shape(copy.Shape());
+                        fixer->Perform();
+                        shape = fixer->Shape();
+                    } catch (Standard_Failure const& e) {
+                        BADCAD_LOG_WARN("Healing ", instances[placed.front()].name, " failed: ",
+                                        e.GetMessageString());
+                    }
+                }
+                const bool valid = isShapeValid(shape);
+
+                MeshLod lod = MeshLod::Medium;
+                if (fileExtent > 0.0) {
+                    lod = Tessellator::selectLod((float)(squareExtent(shape) / fileExtent));
+                }
+                std::shared_ptr<const MeshBuffers> mesh = Tessellator::tessellateLevel(shape, lod, job.getCancelFlag());
+                if (job.isCancelled()) {
+                    return;
+                }
+
+                for (size_t instanceIndex : placed) {
+                    const Instance& instance = instances[instanceIndex];
+                    ImportedPart part;
+                    part.index = instanceIndex;
+                    part.name = instance.name;
+                    part.shape = shape.Moved(instance.location);
+                    part.valid = valid;
+                    if (mesh) {
+                        part.mesh = instance.location.IsIdentity() ? mesh
+                                                                   : placeMesh(*mesh, instance.location.Transformation());
+                    }
+                    TaskScheduler::instance().postToMainThread([onPart, part = std::move(part)]() {
+                        if (onPart) {
+                            onPart(part);
+                        }
+                    });
+                }
+                delivered += placed.size();
+                if (!valid) {
+                    invalid += placed.size();
+                }
+                float fraction = (float)(++finished) / (float)definitionCount;
+                job.setProgress(kTransferProgress + (1.0f - kTransferProgress) * fraction);
+            }
+        }, TaskPriority::Background);
+
+        summary->partCount = delivered;
+        summary->definitionCount = definitionCount;
+        summary->invalidCount = invalid;
+        summary->elapsedMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - startTime).count();
+        if (summary->invalidCount > 0) {
+            BADCAD_LOG_WARN("STEP ", path, ": ", summary->invalidCount, " parts failed validation after healing");
+        }
+        return !job.isCancelled();
+    }, [summary, onFinished](Job& job) {
+        // Queued after every part, so all onPart calls have run by now
+        if (onFinished) {
+            onFinished(job, *summary);
+        }
+    });
+}
+
+} // namespace badcad
@@ -0,0 +1,47 @@
+#pragma once
+
+#include <cstddef>
+#include <functional>
+#include <memory>
+#include <string>
+#include "../render/tessellator.h"
+#include "../utils/job.h"
+#include <TopoDS_Shape.hxx>
+
+namespace badcad {
+
+struct StepImportOptions {
+    bool heal = true;                   // ShapeFix_Shape before validation
+};
+
+// One solid of an imported file, or a free shell or the loose faces
+struct ImportedPart {
+    size_t index = 0;                   // Position in the file, parts arrive out of order
+    std::string name;
+    TopoDS_Shape shape;                 // Healed, at its place in the assembly
+    std::shared_ptr<const MeshBuffers> mesh;    // World space, one LOD; nullptr if meshing failed
+    bool valid = false;                 // BRepCheck_Analyzer result after healing
+};
+
+struct StepImportSummary {
+    size_t partCount = 0;               // Parts delivered
+    size_t definitionCount = 0;         // Distinct solids; the rest are instances
+    size_t invalidCount = 0;
+    double elapsedMs = 0.0;
+};
+
+// STEP import from SPECIFICATION.md §5, as a Job.
+//
+// STEPControl_Reader reads and transfers the file on the job's worker, then
+// the result is split into solids. Assembly instances of the same solid are
+// healed, checked and tessellated once, the distinct solids in parallel on
+// the task scheduler. Each is meshed at the single LOD Tessellator::selectLod
+// picks for its size relative to the whole file. onPart runs on the main
+// thread for every part as soon as it is done, so the viewer fills while the
+// rest is still meshing; onFinished runs once after the last part, also when
+// cancelled or failed.
+JobHandle importStep(const std::string& path, const StepImportOptions& options,
+                     std::function<void(const ImportedPart& part)> onPart,
+                     std::function<void(Job& job, const StepImportSummary& summary)> onFinished);
+
+} // namespace badcad
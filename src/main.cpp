@@ -1,20 +1,70 @@
 #include "ui/application.h"
+#include "core/headless_app.h"
+#include "utils/log.h"
+#include "utils/startup_timer.h"
+#include "utils/trace.h"
+#include <cstring>
 #include <iostream>
 
 int main(int argc, char** argv) {
+    badcad::StartupTimer::mark("main");
     std::cout << "badCAD - 3D CAD Application" << std::endl;
     std::cout << "=============================" << std::endl;
 
+    // --trace file.json records a timeline of this run for chrome://tracing / Perfetto
+    std::string tracePath;
+    for (int i = 1; i + 1 < argc; i++) {
+        if (std::strcmp(argv[i], "--trace") == 0) {
+            tracePath = argv[i + 1];
+        } else if (std::strcmp(argv[i], "--log-level") == 0) {
+            badcad::LogLevel level;
+            if (badcad::Logger::parseLevel(argv[i + 1], level)) {
+                badcad::Logger::setLevel(level);
+            } else {
+                std::cerr << "Unknown log level: " << argv[i + 1] << std::endl;
+            }
+        }
+    }
+    if (!tracePath.empty()) {
+        badcad::Tracer::enable();
+        badcad::Tracer::setThreadName("Main");
+    }
+
+    // Offscreen rendering for CI and batch thumbnails, no window is created
+    if (badcad::isHeadlessInvocation(argc, argv)) {
+        int result = badcad::runHeadless(argc, argv);
+        if (!tracePath.empty()) {
+            badcad::Tracer::writeChromeTrace(tracePath);
+        }
+        badcad::Logger::shutdown();
+        return result;
+    }
+
     badcad::Application app;
+    for (int i = 1; i < argc; i++) {
+        if (std::strcmp(argv[i], "--profile-out") == 0 && i + 1 < argc) {
+            app.setProfileOutput(argv[++i]);
+        } else if (std::strcmp(argv[i], "--memory-report") == 0) {
+            app.setMemoryReport(true);
+        } else if (std::strcmp(argv[i], "--exit-after-startup") == 0) {
+            app.setExitAfterStartup(true);
+        }
+    }
 
     if (!app.init()) {
-        std::cerr << "Failed to initialize application" << std::endl;
+        BADCAD_LOG_ERROR("Failed to initialize application");
+        badcad::Logger::shutdown();
         return -1;
     }
 
     app.run();
     app.shutdown();
+    
+    if (!tracePath.empty()) {
+        badcad::Tracer::writeChromeTrace(tracePath);
+    }
 
-    std::cout << "\nApplication closed successfully" << std::endl;
+    BADCAD_LOG_INFO("Application closed successfully");
+    badcad::Logger::shutdown();
     return 0;
 }
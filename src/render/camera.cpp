@@ -0,0 +1,299 @@
+#define _USE_MATH_DEFINES
+#include <cmath>
+
+#include "camera.h"
+#include <algorithm>
+
+#if defined(__AVX__)
+#include <immintrin.h>
+#define BADCAD_CAMERA_AVX 1
+#elif defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define BADCAD_CAMERA_SSE 1
+#endif
+
+namespace badcad {
+
+// Half extent of the orthographic volume in depth, matches the old glOrtho(-100, 100)
+static constexpr float kDepthRange = 100.0f;
+
+// out = a * b, column-major
+static void multiply(const float* a, const float* b, float* out) {
+    float result[16];
+    for (int col = 0; col < 4; col++) {
+        for (int row = 0; row < 4; row++) {
+            result[col * 4 + row] = a[0 * 4 + row] * b[col * 4 + 0] +
+                                    a[1 * 4 + row] * b[col * 4 + 1] +
+                                    a[2 * 4 + row] * b[col * 4 + 2] +
+                                    a[3 * 4 + row] * b[col * 4 + 3];
+        }
+    }
+    std::copy(result, result + 16, out);
+}
+
+static void identity(float* m) {
+    std::fill(m, m + 16, 0.0f);
+    m[0] = m[5] = m[10] = m[15] = 1.0f;
+}
+
+// Transforms (x, y, z, 1) by m and divides by w. Rows 0-2 of the result are
+// written to outX/outY/outZ; outZ may be null. When z is null, zConstant is
+// used for every point.
+static void transformPoints(const float* m, const float* x, const float* y, const float* z,
+                            float zConstant, size_t count, float* outX, float* outY, float* outZ) {
+    size_t i = 0;
+
+#if defined(BADCAD_CAMERA_AVX)
+    const __m256 m0 = _mm256_set1_ps(m[0]), m1 = _mm256_set1_ps(m[1]), m2 = _mm256_set1_ps(m[2]), m3 = _mm256_set1_ps(m[3]);
+    const __m256 m4 = _mm256_set1_ps(m[4]), m5 = _mm256_set1_ps(m[5]), m6 = _mm256_set1_ps(m[6]), m7 = _mm256_set1_ps(m[7]);
+    const __m256 m8 = _mm256_set1_ps(m[8]), m9 = _mm256_set1_ps(m[9]), m10 = _mm256_set1_ps(m[10]), m11 = _mm256_set1_ps(m[11]);
+    const __m256 m12 = _mm256_set1_ps(m[12]), m13 = _mm256_set1_ps(m[13]), m14 = _mm256_set1_ps(m[14]), m15 = _mm256_set1_ps(m[15]);
+    const __m256 zc = _mm256_set1_ps(zConstant);
+
+    for (; i + 8 <= count; i += 8) {
+        __m256 px = _mm256_loadu_ps(x + i);
+        __m256 py = _mm256_loadu_ps(y + i);
+        __m256 pz = z ? _mm256_loadu_ps(z + i) : zc;
+
+        __m256 rx = _mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(m0, px), _mm256_mul_ps(m4, py)), _mm256_add_ps(_mm256_mul_ps(m8, pz), m12));
+        __m256 ry = _mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(m1, px), _mm256_mul_ps(m5, py)), _mm256_add_ps(_mm256_mul_ps(m9, pz), m13));
+        __m256 rw = _mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(m3, px), _mm256_mul_ps(m7, py)), _mm256_add_ps(_mm256_mul_ps(m11, pz), m15));
+        __m256 invW = _mm256_div_ps(_mm256_set1_ps(1.0f), rw);
+
+        _mm256_storeu_ps(outX + i, _mm256_mul_ps(rx, invW));
+        _mm256_storeu_ps(outY + i, _mm256_mul_ps(ry, invW));
+        if (outZ) {
+            __m256 rz = _mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(m2, px), _mm256_mul_ps(m6, py)), _mm256_add_ps(_mm256_mul_ps(m10, pz), m14));
+            _mm256_storeu_ps(outZ + i, _mm256_mul_ps(rz, invW));
+        }
+    }
+#elif defined(BADCAD_CAMERA_SSE)
+    const __m128 m0 = _mm_set1_ps(m[0]), m1 = _mm_set1_ps(m[1]), m2 = _mm_set1_ps(m[2]), m3 = _mm_set1_ps(m[3]);
+    const __m128 m4 = _mm_set1_ps(m[4]), m5 = _mm_set1_ps(m[5]), m6 = _mm_set1_ps(m[6]), m7 = _mm_set1_ps(m[7]);
+    const __m128 m8 = _mm_set1_ps(m[8]), m9 = _mm_set1_ps(m[9]), m10 = _mm_set1_ps(m[10]), m11 = _mm_set1_ps(m[11]);
+    const __m128 m12 = _mm_set1_ps(m[12]), m13 = _mm_set1_ps(m[13]), m14 = _mm_set1_ps(m[14]), m15 = _mm_set1_ps(m[15]);
+    const __m128 zc = _mm_set1_ps(zConstant);
+
+    for (; i + 4 <= count; i += 4) {
+        __m128 px = _mm_loadu_ps(x + i);
+        __m128 py = _mm_loadu_ps(y + i);
+        __m128 pz = z ? _mm_loadu_ps(z + i) : zc;
+
+        __m128 rx = _mm_add_ps(_mm_add_ps(_mm_mul_ps(m0, px), _mm_mul_ps(m4, py)), _mm_add_ps(_mm_mul_ps(m8, pz), m12));
+        __m128 ry = _mm_add_ps(_mm_add_ps(_mm_mul_ps(m1, px), _mm_mul_ps(m5, py)), _mm_add_ps(_mm_mul_ps(m9, pz), m13));
+        __m128 rw = _mm_add_ps(_mm_add_ps(_mm_mul_ps(m3, px), _mm_mul_ps(m7, py)), _mm_add_ps(_mm_mul_ps(m11, pz), m15));
+        __m128 invW = _mm_div_ps(_mm_set1_ps(1.0f), rw);
+
+        _mm_storeu_ps(outX + i, _mm_mul_ps(rx, invW));
+        _mm_storeu_ps(outY + i, _mm_mul_ps(ry, invW));
+        if (outZ) {
+            __m128 rz = _mm_add_ps(_mm_add_ps(_mm_mul_ps(m2, px), _mm_mul_ps(m6, py)), _mm_add_ps(_mm_mul_ps(m10, pz), m14));
+            _mm_storeu_ps(outZ + i, _mm_mul_ps(rz, invW));
+        }
+    }
+#endif
+
+    // Scalar tail (and the whole batch on targets without SSE2)
+    for (; i < count; i++) {
+        float px = x[i];
+        float py = y[i];
+        float pz = z ? z[i] : zConstant;
+        float invW = 1.0f / (m[3] * px + m[7] * py + m[11] * pz + m[15]);
+        outX[i] = (m[0] * px + m[4] * py + m[8] * pz + m[12]) * invW;
+        outY[i] = (m[1] * px + m[5] * py + m[9] * pz + m[13]) * invW;
+        if (outZ) {
+            outZ[i] = (m[2] * px + m[6] * py + m[10] * pz + m[14]) * invW;
+        }
+    }
+}
+
+bool Camera::State::operator==(const State& other) const {
+    return distance == other.distance &&
+           rotX == other.rotX &&
+           rotY == other.rotY &&
+           rotZ == other.rotZ &&
+           panX == other.panX &&
+           panY == other.panY;
+}
+
+Camera::Camera() {
+    update();
+}
+
+void Camera::setState(const State& state) {
+    if (state != m_state) {
+        m_state = state;
+        m_dirty = true;
+    }
+}
+
+void Camera::setRotation(float rotX, float rotY, float rotZ) {
+    State state = m_state;
+    state.rotX = rotX;
+    state.rotY = rotY;
+    state.rotZ = rotZ;
+    setState(state);
+}
+
+void Camera::setPan(float panX, float panY) {
+    State state = m_state;
+    state.panX = panX;
+    state.panY = panY;
+    setState(state);
+}
+
+void Camera::setDistance(float distance) {
+    State state = m_state;
+    state.distance = distance;
+    setState(state);
+}
+
+void Camera::setViewport(int width, int height) {
+    width = std::max(1, width);
+    height = std::max(1, height);
+    if (width != m_viewportWidth || height != m_viewportHeight) {
+        m_viewportWidth = width;
+        m_viewportHeight = height;
+        m_dirty = true;
+    }
+}
+
+const float* Camera::getViewMatrix() const {
+    update();
+    return m_view;
+}
+
+const float* Camera::getProjectionMatrix() const {
+    update();
+    return m_projection;
+}
+
+const float* Camera::getInverseViewProjectionMatrix() const {
+    update();
+    return m_inverseViewProjection;
+}
+
+void Camera::update() const {
+    if (!m_dirty) {
+        return;
+    }
+
+    // Rotation R = Rx * Ry * Rz (same order the fixed-function path used)
+    const float toRad = (float)M_PI / 180.0f;
+    float cx = std::cos(m_state.rotX * toRad), sx = std::sin(m_state.rotX * toRad);
+    float cy = std::cos(m_state.rotY * toRad), sy = std::sin(m_state.rotY * toRad);
+    float cz = std::cos(m_state.rotZ * toRad), sz = std::sin(m_state.rotZ * toRad);
+
+    // r[row][col]
+    float r[3][3] = {
+        { cy * cz,                 -cy * sz,                 sy      },
+        { sx * sy * cz + cx * sz,  -sx * sy * sz + cx * cz,  -sx * cy },
+        { -cx * sy * cz + sx * sz, cx * sy * sz + sx * cz,   cx * cy }
+    };
+
+    // View = Scale(1/distance) * Translate(pan) * R
+    float invDistance = 1.0f / m_state.distance;
+    identity(m_view);
+    for (int row = 0; row < 3; row++) {
+        for (int col = 0; col < 3; col++) {
+            m_view[col * 4 + row] = r[row][col] * invDistance;
+        }
+    }
+    m_view[12] = m_state.panX * invDistance;
+    m_view[13] = m_state.panY * invDistance;
+
+    // Inverse view = R^T * Translate(-pan) * Scale(distance)
+    float inverseView[16];
+    identity(inverseView);
+    for (int row = 0; row < 3; row++) {
+        for (int col = 0; col < 3; col++) {
+            inverseView[col * 4 + row] = r[col][row] * m_state.distance;
+        }
+    }
+    for (int row = 0; row < 3; row++) {
+        inverseView[12 + row] = -(r[0][row] * m_state.panX + r[1][row] * m_state.panY);
+    }
+
+    // Symmetric orthographic projection, wider axis spans [-aspect, aspect]
+    float aspect = (float)m_viewportWidth / (float)m_viewportHeight;
+    float halfWidth = aspect > 1.0f ? aspect : 1.0f;
+    float halfHeight = aspect > 1.0f ? 1.0f : 1.0f / aspect;
+
+    identity(m_projection);
+    m_projection[0] = 1.0f / halfWidth;
+    m_projection[5] = 1.0f / halfHeight;
+    m_projection[10] = -1.0f / kDepthRange;
+
+    float inverseProjection[16];
+    identity(inverseProjection);
+    inverseProjection[0] = halfWidth;
+    inverseProjection[5] = halfHeight;
+    inverseProjection[10] = -kDepthRange;
+
+    float viewProjection[16];
+    multiply(m_projection, m_view, viewProjection);
+    multiply(inverseView, inverseProjection, m_inverseViewProjection);
+
+    // NDC <-> normalized viewport (Y flipped, screen Y is top-down)
+    float ndcToViewport[16];
+    identity(ndcToViewport);
+    ndcToViewport[0] = 0.5f;
+    ndcToViewport[5] = -0.5f;
+    ndcToViewport[12] = 0.5f;
+    ndcToViewport[13] = 0.5f;
+
+    float viewportToNdc[16];
+    identity(viewportToNdc);
+    viewportToNdc[0] = 2.0f;
+    viewportToNdc[5] = -2.0f;
+    viewportToNdc[12] = -1.0f;
+    viewportToNdc[13] = 1.0f;
+
+    multiply(ndcToViewport, viewProjection, m_worldToViewport);
+    multiply(m_inverseViewProjection, viewportToNdc, m_viewportToWorld);
+
+    m_dirty = false;
+}
+
+void Camera::project(const float* x, const float* y, const float* z, size_t count,
+                     float* outU, float* outV) const {
+    update();
+    transformPoints(m_worldToViewport, x, y, z, 0.0f, count, outU, outV, nullptr);
+}
+
+void Camera::unproject(const float* u, const float* v, size_t count, float depth,
+                       float* outX, float* outY, float* outZ) const {
+    update();
+    transformPoints(m_viewportToWorld, u, v, nullptr, depth, count, outX, outY, outZ);
+}
+
+void Camera::projectPoint(float x, float y, float z, float& outU, float& outV) const {
+    project(&x, &y, &z, 1, &outU, &outV);
+}
+
+void Camera::getRay(float u, float v, float outOrigin[3], float outDirection[3]) const {
+    // Ray from the near plane to the far plane through the given point
+    float us[2] = {u, u};
+    float vs[2] = {v, v};
+    float xs[2], ys[2], zs[2];
+    update();
+    transformPoints(m_viewportToWorld, us, vs, nullptr, -1.0f, 1, &xs[0], &ys[0], &zs[0]);
+    transformPoints(m_viewportToWorld, us, vs, nullptr, 1.0f, 1, &xs[1], &ys[1], &zs[1]);
+
+    float dx = xs[1] - xs[0];
+    float dy = ys[1] - ys[0];
+    float dz = zs[1] - zs[0];
+    float length = std::sqrt(dx * dx + dy * dy + dz * dz);
+    if (length <= 0.0f) {
+        length = 1.0f;
+    }
+
+    outOrigin[0] = xs[0];
+    outOrigin[1] = ys[0];
+    outOrigin[2] = zs[0];
+    outDirection[0] = dx / length;
+    outDirection[1] = dy / length;
+    outDirection[2] = dz / length;
+}
+
+} // namespace badcad
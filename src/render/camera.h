@@ -0,0 +1,77 @@
+#pragma once
+
+#include <cstddef>
+
+namespace badcad {
+
+// Orbit camera shared by the render and pick paths, so both always agree on
+// the transform. View, projection and their inverses are cached and rebuilt
+// at most once after a change.
+//
+// Matrices are column-major (OpenGL order). Viewport coordinates are
+// normalized: (0,0) is the top-left corner, (1,1) the bottom-right.
+class Camera {
+public:
+    struct State {
+        float distance = 2.0f;
+        float rotX = 30.0f;   // degrees
+        float rotY = 0.0f;
+        float rotZ = -45.0f;
+        float panX = 0.0f;
+        float panY = 0.0f;
+
+        bool operator==(const State& other) const;
+        bool operator!=(const State& other) const { return !(*this == other); }
+    };
+
+    Camera();
+
+    const State& getState() const { return m_state; }
+    void setState(const State& state);
+
+    void setRotation(float rotX, float rotY, float rotZ);
+    void setPan(float panX, float panY);
+    void setDistance(float distance);
+    void setViewport(int width, int height);
+
+    float getRotationX() const { return m_state.rotX; }
+    float getRotationY() const { return m_state.rotY; }
+    float getRotationZ() const { return m_state.rotZ; }
+    float getPanX() const { return m_state.panX; }
+    float getPanY() const { return m_state.panY; }
+    float getDistance() const { return m_state.distance; }
+
+    const float* getViewMatrix() const;
+    const float* getProjectionMatrix() const;
+    const float* getInverseViewProjectionMatrix() const;
+
+    // Batch world -> viewport over structure-of-arrays input. Vectorized with
+    // AVX/SSE where available; used for box selection and label placement.
+    void project(const float* x, const float* y, const float* z, size_t count,
+                 float* outU, float* outV) const;
+
+    // Batch viewport -> world at a fixed depth (-1 = near plane, 1 = far plane)
+    void unproject(const float* u, const float* v, size_t count, float depth,
+                   float* outX, float* outY, float* outZ) const;
+
+    // Single-point convenience wrappers
+    void projectPoint(float x, float y, float z, float& outU, float& outV) const;
+    void getRay(float u, float v, float outOrigin[3], float outDirection[3]) const;
+
+private:
+    void update() const;
+
+    State m_state;
+    int m_viewportWidth = 1;
+    int m_viewportHeight = 1;
+
+    // Cached matrices, rebuilt lazily when m_dirty is set
+    mutable bool m_dirty = true;
+    mutable float m_view[16];
+    mutable float m_projection[16];
+    mutable float m_inverseViewProjection[16];
+    mutable float m_worldToViewport[16];
+    mutable float m_viewportToWorld[16];
+};
+
+} // namespace badcad
@@ -0,0 +1,239 @@
+#include "frame_profiler.h"
+#include "gl_loader.h"
+#include "../utils/log.h"
+#include "imgui.h"
+#include <algorithm>
+#include <cstdio>
+#include <ctime>
+#include <fstream>
+
+namespace badcad {
+
+static double percentileOf(const std::vector<double>& sorted, double p) {
+    if (sorted.empty()) {
+        return 0.0;
+    }
+    size_t index = (size_t)(p * (sorted.size() - 1) + 0.5);
+    return sorted[std::min(index, sorted.size() - 1)];
+}
+
+void FrameProfiler::History::push(double value) {
+    if (samples.size() < (size_t)kHistorySize) {
+        samples.push_back(value);
+        return;
+    }
+    samples[next] = value;
+    next = (next + 1) % samples.size();
+}
+
+FrameProfiler::FrameProfiler() {
+}
+
+FrameProfiler::~FrameProfiler() {
+}
+
+void FrameProfiler::init() {
+    m_gpuTiming = glGenQueries && glDeleteQueries && glBeginQuery && glEndQuery &&
+                  glGetQueryObjectiv && glGetQueryObjectui64v;
+    if (!m_gpuTiming) {
+        BADCAD_LOG_WARN("Timer queries unavailable, profiling CPU time only");
+        return;
+    }
+    for (int slot = 0; slot < kQueryLatency; slot++) {
+        glGenQueries(kSectionCount, m_queries[slot]);
+    }
+}
+
+void FrameProfiler::shutdown() {
+    if (!m_gpuTiming) {
+        return;
+    }
+    for (int slot = 0; slot < kQueryLatency; slot++) {
+        glDeleteQueries(kSectionCount, m_queries[slot]);
+        std::fill(m_queries[slot], m_queries[slot] + kSectionCount, 0u);
+        std::fill(m_queryIssued[slot], m_queryIssued[slot] + kSectionCount, false);
+    }
+    m_gpuTiming = false;
+}
+
+void FrameProfiler::beginFrame() {
+    m_frameSlot = (m_frameSlot + 1) % kQueryLatency;
+
+    // The queries in this slot were issued kQueryLatency frames ago and have
+    // normally finished by now; if not, the sample is dropped instead of stalling
+    if (m_gpuTiming) {
+        for (int i = 0; i < kSectionCount; i++) {
+            if (!m_queryIssued[m_frameSlot][i]) {
+                continue;
+            }
+            m_queryIssued[m_frameSlot][i] = false;
+
+            GLint available = 0;
+            glGetQueryObjectiv(m_queries[m_frameSlot][i], GL_QUERY_RESULT_AVAILABLE, &available);
+            if (available) {
+                GLuint64 elapsedNs = 0;
+                glGetQueryObjectui64v(m_queries[m_frameSlot][i], GL_QUERY_RESULT, &elapsedNs);
+                addSample((FrameSection)i, -1.0, elapsedNs / 1.0e6);
+            }
+        }
+    }
+
+    beginSection(FrameSection::Frame);
+}
+
+void FrameProfiler::endFrame() {
+    endSection(FrameSection::Frame);
+}
+
+void FrameProfiler::beginSection(FrameSection section, bool gpu) {
+    int i = (int)section;
+    if (gpu && m_gpuTiming) {
+        glBeginQuery(GL_TIME_ELAPSED, m_queries[m_frameSlot][i]);
+    }
+    m_sectionStart[i] = std::chrono::steady_clock::now();
+}
+
+void FrameProfiler::endSection(FrameSection section, bool gpu) {
+    int i = (int)section;
+    std::chrono::duration<double, std::milli> elapsed = std::chrono::steady_clock::now() - m_sectionStart[i];
+    if (gpu && m_gpuTiming) {
+        glEndQuery(GL_TIME_ELAPSED);
+        m_queryIssued[m_frameSlot][i] = true;
+    }
+    addSample(section, elapsed.count(), -1.0);
+}
+
+void FrameProfiler::addSample(FrameSection section, double cpuMs, double gpuMs) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    if (cpuMs >= 0.0) {
+        m_cpu[(int)section].push(cpuMs);
+    }
+    if (gpuMs >= 0.0) {
+        m_gpu[(int)section].push(gpuMs);
+    }
+}
+
+FrameProfiler::Stats FrameProfiler::getStats(FrameSection section, bool gpu) const {
+    std::vector<double> sorted;
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        sorted = (gpu ? m_gpu : m_cpu)[(int)section].samples;
+    }
+
+    Stats stats;
+    if (sorted.empty()) {
+        return stats;
+    }
+    std::sort(sorted.begin(), sorted.end());
+
+    double total = 0.0;
+    for (double value : sorted) {
+        total += value;
+    }
+    stats.count = (int)sorted.size();
+    stats.mean = total / sorted.size();
+    stats.p50 = percentileOf(sorted, 0.50);
+    stats.p95 = percentileOf(sorted, 0.95);
+    stats.p99 = percentileOf(sorted, 0.99);
+    stats.max = sorted.back();
+    return stats;
+}
+
+void FrameProfiler::drawOverlay(float right, float top) {
+    if (!m_overlayVisible) {
+        return;
+    }
+
+    ImGui::SetNextWindowPos(ImVec2(right - 10.0f, top + 10.0f), ImGuiCond_Always, ImVec2(1.0f, 0.0f));
+    ImGui::SetNextWindowBgAlpha(0.75f);
+    ImGuiWindowFlags flags = ImGuiWindowFlags_NoDecoration |
+                             ImGuiWindowFlags_AlwaysAutoResize |
+                             ImGuiWindowFlags_NoSavedSettings |
+                             ImGuiWindowFlags_NoFocusOnAppearing |
+                             ImGuiWindowFlags_NoNav;
+    if (ImGui::Begin("Frame Profiler", nullptr, flags)) {
+        ImGui::TextDisabled("Frame profiler (F3)  last %d frames, ms", kHistorySize);
+
+        if (ImGui::BeginTable("##profile", 6, ImGuiTableFlags_SizingFixedFit | ImGuiTableFlags_RowBg)) {
+            ImGui::TableSetupColumn("Section");
+            ImGui::TableSetupColumn("CPU p50");
+            ImGui::TableSetupColumn("p95");
+            ImGui::TableSetupColumn("p99");
+            ImGui::TableSetupColumn("GPU p50");
+            ImGui::TableSetupColumn("p95");
+            ImGui::TableHeadersRow();
+
+            for (int i = 0; i < kSectionCount; i++) {
+                Stats cpu = getStats((FrameSection)i, false);
+                Stats gpu = getStats((FrameSection)i, true);
+
+                ImGui::TableNextRow();
+                ImGui::TableNextColumn();
+                ImGui::TextUnformatted(getSectionName((FrameSection)i));
+                ImGui::TableNextColumn();
+                ImGui::Text("%.2f", cpu.p50);
+                ImGui::TableNextColumn();
+                ImGui::Text("%.2f", cpu.p95);
+                ImGui::TableNextColumn();
+                ImGui::Text("%.2f", cpu.p99);
+                ImGui::TableNextColumn();
+                if (gpu.count > 0) {
+                    ImGui::Text("%.2f", gpu.p50);
+                } else {
+                    ImGui::TextDisabled("-");
+                }
+                ImGui::TableNextColumn();
+                if (gpu.count > 0) {
+                    ImGui::Text("%.2f", gpu.p95);
+                } else {
+                    ImGui::TextDisabled("-");
+                }
+            }
+            ImGui::EndTable();
+        }
+
+        if (ImGui::SmallButton("Save CSV")) {
+            char path[64];
+            std::snprintf(path, sizeof(path), "frame_profile_%lld.csv", (long long)std::time(nullptr));
+            if (dumpToFile(path)) {
+                BADCAD_LOG_INFO("Frame profile written to ", path);
+            }
+        }
+    }
+    ImGui::End();
+}
+
+bool FrameProfiler::dumpToFile(const std::string& path) const {
+    std::ofstream file(path);
+    if (!file.is_open()) {
+        BADCAD_LOG_ERROR("Failed to write frame profile: ", path);
+        return false;
+    }
+
+    file << "section,clock,samples,mean_ms,p50_ms,p95_ms,p99_ms,max_ms\n";
+    for (int i = 0; i < kSectionCount; i++) {
+        for (int gpu = 0; gpu < 2; gpu++) {
+            Stats stats = getStats((FrameSection)i, gpu != 0);
+            if (stats.count == 0) {
+                continue;
+            }
+            file << getSectionName((FrameSection)i) << "," << (gpu ? "gpu" : "cpu") << ","
+                 << stats.count << "," << stats.mean << "," << stats.p50 << ","
+                 << stats.p95 << "," << stats.p99 << "," << stats.max << "\n";
+        }
+    }
+    return true;
+}
+
+const char* FrameProfiler::getSectionName(FrameSection section) {
+    switch (section) {
+        case FrameSection::Frame: return "Frame";
+        case FrameSection::ImGuiBuild: return "ImGui build";
+        case FrameSection::Viewport: return "Viewport";
+        case FrameSection::Resolve: return "Resolve";
+        case FrameSection::Swap: return "Swap";
+        default: return "?";
+    }
+}
+
+} // namespace badcad
@@ -0,0 +1,118 @@
+#pragma once
+
+#include <chrono>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace badcad {
+
+// Phases of a UI frame. GL_TIME_ELAPSED queries cannot nest, so GPU timing is
+// only requested for leaf phases (Viewport, Resolve).
+enum class FrameSection {
+    Frame,        // Whole frame on the UI thread, CPU only
+    ImGuiBuild,   // NewFrame .. ImGui::Render, includes Viewport
+    Viewport,     // OccViewer redraws (on the render thread when it runs)
+    Resolve,      // ImGui draw data, which composites the viewport FBO to the back buffer
+    Swap,         // glfwSwapBuffers, includes waiting for vsync
+    Count
+};
+
+// Rolling CPU/GPU timings per frame section, with a small overlay showing
+// percentiles and a CSV dump for comparing runs.
+class FrameProfiler {
+public:
+    struct Stats {
+        int count = 0;
+        double mean = 0.0;
+        double p50 = 0.0;
+        double p95 = 0.0;
+        double p99 = 0.0;
+        double max = 0.0;
+    };
+
+    FrameProfiler();
+    ~FrameProfiler();
+
+    // Creates the GPU queries; call with the UI context current. Without
+    // timer query support only CPU timings are recorded.
+    void init();
+    void shutdown();
+
+    // beginFrame() also collects GPU results issued a few frames earlier
+    void beginFrame();
+    void endFrame();
+
+    // UI thread only. gpu = true brackets the section with a timer query.
+    void beginSection(FrameSection section, bool gpu = false);
+    void endSection(FrameSection section, bool gpu = false);
+
+    // Thread-safe; for timings measured elsewhere, e.g. the render thread.
+    // A negative gpuMs means no GPU sample.
+    void addSample(FrameSection section, double cpuMs, double gpuMs);
+
+    Stats getStats(FrameSection section, bool gpu) const;
+
+    bool isOverlayVisible() const { return m_overlayVisible; }
+    void toggleOverlay() { m_overlayVisible = !m_overlayVisible; }
+
+    // ImGui window anchored with its top-right corner at (right, top)
+    void drawOverlay(float right, float top);
+
+    // One row per section and clock: count, mean and percentiles in ms
+    bool dumpToFile(const std::string& path) const;
+
+    static const char* getSectionName(FrameSection section);
+
+private:
+    static constexpr int kSectionCount = (int)FrameSection::Count;
+    static constexpr int kHistorySize = 300;    // ~5 s at 60 Hz
+    static constexpr int kQueryLatency = 3;     // Frames before a query result is read back
+
+    struct History {
+        std::vector<double> samples;
+        size_t next = 0;
+
+        void push(double value);
+    };
+
+    History m_cpu[kSectionCount];
+    History m_gpu[kSectionCount];
+    mutable std::mutex m_mutex;
+
+    std::chrono::steady_clock::time_point m_sectionStart[kSectionCount];
+
+    // Timer queries, one set per in-flight frame
+    unsigned int m_queries[kQueryLatency][kSectionCount] = {};
+    bool m_queryIssued[kQueryLatency][kSectionCount] = {};
+    int m_frameSlot = 0;
+    bool m_gpuTiming = false;
+
+    bool m_overlayVisible = false;
+};
+
+// Times the enclosing scope. A null profiler makes it a no-op.
+class ProfileScope {
+public:
+    ProfileScope(FrameProfiler* profiler, FrameSection section, bool gpu = false)
+        : m_profiler(profiler), m_section(section), m_gpu(gpu) {
+        if (m_profiler) {
+            m_profiler->beginSection(m_section, m_gpu);
+        }
+    }
+    ~ProfileScope() {
+        if (m_profiler) {
+            m_profiler->endSection(m_section, m_gpu);
+        }
+    }
+
+    ProfileScope(const ProfileScope&) = delete;
+    ProfileScope& operator=(const ProfileScope&) = delete;
+
+private:
+    FrameProfiler* m_profiler;
+    FrameSection m_section;
+    bool m_gpu;
+};
+
+} // namespace badcad
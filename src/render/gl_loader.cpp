@@ -0,0 +1,74 @@
+#include "gl_loader.h"
+
+namespace badcad {
+
+PFNGLGENFRAMEBUFFERSPROC glGenFramebuffers = nullptr;
+PFNGLBINDFRAMEBUFFERPROC glBindFramebuffer = nullptr;
+PFNGLFRAMEBUFFERTEXTURE2DPROC glFramebufferTexture2D = nullptr;
+PFNGLGENRENDERBUFFERSPROC glGenRenderbuffers = nullptr;
+PFNGLBINDRENDERBUFFERPROC glBindRenderbuffer = nullptr;
+PFNGLRENDERBUFFERSTORAGEPROC glRenderbufferStorage = nullptr;
+PFNGLFRAMEBUFFERRENDERBUFFERPROC glFramebufferRenderbuffer = nullptr;
+PFNGLCHECKFRAMEBUFFERSTATUSPROC glCheckFramebufferStatus = nullptr;
+PFNGLDELETEFRAMEBUFFERSPROC glDeleteFramebuffers = nullptr;
+PFNGLDELETERENDERBUFFERSPROC glDeleteRenderbuffers = nullptr;
+PFNGLFENCESYNCPROC glFenceSync = nullptr;
+PFNGLWAITSYNCPROC glWaitSync = nullptr;
+PFNGLCLIENTWAITSYNCPROC glClientWaitSync = nullptr;
+PFNGLDELETESYNCPROC glDeleteSync = nullptr;
+PFNGLGENQUERIESPROC glGenQueries = nullptr;
+PFNGLDELETEQUERIESPROC glDeleteQueries = nullptr;
+PFNGLBEGINQUERYPROC glBeginQuery = nullptr;
+PFNGLENDQUERYPROC glEndQuery = nullptr;
+PFNGLGETQUERYOBJECTIVPROC glGetQueryObjectiv = nullptr;
+PFNGLGETQUERYOBJECTUI64VPROC glGetQueryObjectui64v = nullptr;
+PFNGLGENBUFFERSPROC glGenBuffers = nullptr;
+PFNGLDELETEBUFFERSPROC glDeleteBuffers = nullptr;
+PFNGLBINDBUFFERPROC glBindBuffer = nullptr;
+PFNGLBUFFERDATAPROC glBufferData = nullptr;
+PFNGLBUFFERSUBDATAPROC glBufferSubData = nullptr;
+
+static void* glfwLoader(const char* name) {
+    return (void*)glfwGetProcAddress(name);
+}
+
+static GLProcLoader s_loader = glfwLoader;
+
+void setGLProcLoader(GLProcLoader loader) {
+    s_loader = loader ? loader : glfwLoader;
+}
+
+bool loadGLFunctions() {
+    glGenFramebuffers = (PFNGLGENFRAMEBUFFERSPROC)s_loader("glGenFramebuffers");
+    glBindFramebuffer = (PFNGLBINDFRAMEBUFFERPROC)s_loader("glBindFramebuffer");
+    glFramebufferTexture2D = (PFNGLFRAMEBUFFERTEXTURE2DPROC)s_loader("glFramebufferTexture2D");
+    glGenRenderbuffers = (PFNGLGENRENDERBUFFERSPROC)s_loader("glGenRenderbuffers");
+    glBindRenderbuffer = (PFNGLBINDRENDERBUFFERPROC)s_loader("glBindRenderbuffer");
+    glRenderbufferStorage = (PFNGLRENDERBUFFERSTORAGEPROC)s_loader("glRenderbufferStorage");
+    glFramebufferRenderbuffer = (PFNGLFRAMEBUFFERRENDERBUFFERPROC)s_loader("glFramebufferRenderbuffer");
+    glCheckFramebufferStatus = (PFNGLCHECKFRAMEBUFFERSTATUSPROC)s_loader("glCheckFramebufferStatus");
+    glDeleteFramebuffers = (PFNGLDELETEFRAMEBUFFERSPROC)s_loader("glDeleteFramebuffers");
+    glDeleteRenderbuffers = (PFNGLDELETERENDERBUFFERSPROC)s_loader("glDeleteRenderbuffers");
+    glFenceSync = (PFNGLFENCESYNCPROC)s_loader("glFenceSync");
+    glWaitSync = (PFNGLWAITSYNCPROC)s_loader("glWaitSync");
+    glClientWaitSync = (PFNGLCLIENTWAITSYNCPROC)s_loader("glClientWaitSync");
+    glDeleteSync = (PFNGLDELETESYNCPROC)s_loader("glDeleteSync");
+    glGenQueries = (PFNGLGENQUERIESPROC)s_loader("glGenQueries");
+    glDeleteQueries = (PFNGLDELETEQUERIESPROC)s_loader("glDeleteQueries");
+    glBeginQuery = (PFNGLBEGINQUERYPROC)s_loader("glBeginQuery");
+    glEndQuery = (PFNGLENDQUERYPROC)s_loader("glEndQuery");
+    glGetQueryObjectiv = (PFNGLGETQUERYOBJECTIVPROC)s_loader("glGetQueryObjectiv");
+    glGetQueryObjectui64v = (PFNGLGETQUERYOBJECTUI64VPROC)s_loader("glGetQueryObjectui64v");
+    glGenBuffers = (PFNGLGENBUFFERSPROC)s_loader("glGenBuffers");
+    glDeleteBuffers = (PFNGLDELETEBUFFERSPROC)s_loader("glDeleteBuffers");
+    glBindBuffer = (PFNGLBINDBUFFERPROC)s_loader("glBindBuffer");
+    glBufferData = (PFNGLBUFFERDATAPROC)s_loader("glBufferData");
+    glBufferSubData = (PFNGLBUFFERSUBDATAPROC)s_loader("glBufferSubData");
+
+    return glGenFramebuffers && glBindFramebuffer && glFramebufferTexture2D &&
+           glGenRenderbuffers && glBindRenderbuffer && glRenderbufferStorage &&
+           glFramebufferRenderbuffer && glCheckFramebufferStatus &&
+           glDeleteFramebuffers && glDeleteRenderbuffers;
+}
+
+} // namespace badcad
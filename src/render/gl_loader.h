@@ -0,0 +1,59 @@
+#pragma once
+
+// OpenGL and GLFW must be included before platform-specific headers
+#include <GLFW/glfw3.h>
+
+#ifdef _WIN32
+#include <GL/glext.h>  // For OpenGL framebuffer extensions
+#endif
+
+namespace badcad {
+
+// Resolves a GL entry point by name for the context that is current
+using GLProcLoader = void* (*)(const char* name);
+
+// The windowed app uses glfwGetProcAddress. The headless backend installs
+// eglGetProcAddress before the viewer is initialized.
+void setGLProcLoader(GLProcLoader loader);
+
+// Load GL 3.x entry points that are not exported by opengl32/libGL directly.
+// Must be called with a context current. Safe to call more than once.
+// Returns false if the FBO entry points are missing; sync objects are
+// optional and left null on contexts older than 3.2, as are timer queries
+// before 3.3 and buffer objects if the driver does not export them.
+bool loadGLFunctions();
+
+// OpenGL FBO function pointers (loaded at runtime)
+extern PFNGLGENFRAMEBUFFERSPROC glGenFramebuffers;
+extern PFNGLBINDFRAMEBUFFERPROC glBindFramebuffer;
+extern PFNGLFRAMEBUFFERTEXTURE2DPROC glFramebufferTexture2D;
+extern PFNGLGENRENDERBUFFERSPROC glGenRenderbuffers;
+extern PFNGLBINDRENDERBUFFERPROC glBindRenderbuffer;
+extern PFNGLRENDERBUFFERSTORAGEPROC glRenderbufferStorage;
+extern PFNGLFRAMEBUFFERRENDERBUFFERPROC glFramebufferRenderbuffer;
+extern PFNGLCHECKFRAMEBUFFERSTATUSPROC glCheckFramebufferStatus;
+extern PFNGLDELETEFRAMEBUFFERSPROC glDeleteFramebuffers;
+extern PFNGLDELETERENDERBUFFERSPROC glDeleteRenderbuffers;
+
+// Sync objects, used to hand frames between the render thread and the UI
+extern PFNGLFENCESYNCPROC glFenceSync;
+extern PFNGLWAITSYNCPROC glWaitSync;
+extern PFNGLCLIENTWAITSYNCPROC glClientWaitSync;
+extern PFNGLDELETESYNCPROC glDeleteSync;
+
+// Queries, used by the frame profiler for GPU timings
+extern PFNGLGENQUERIESPROC glGenQueries;
+extern PFNGLDELETEQUERIESPROC glDeleteQueries;
+extern PFNGLBEGINQUERYPROC glBeginQuery;
+extern PFNGLENDQUERYPROC glEndQuery;
+extern PFNGLGETQUERYOBJECTIVPROC glGetQueryObjectiv;
+extern PFNGLGETQUERYOBJECTUI64VPROC glGetQueryObjectui64v;
+
+// Buffer objects, used for meshes the viewport redraws every frame
+extern PFNGLGENBUFFERSPROC glGenBuffers;
+extern PFNGLDELETEBUFFERSPROC glDeleteBuffers;
+extern PFNGLBINDBUFFERPROC glBindBuffer;
+extern PFNGLBUFFERDATAPROC glBufferData;
+extern PFNGLBUFFERSUBDATAPROC glBufferSubData;
+
+} // namespace badcad
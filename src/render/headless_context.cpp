@@ -0,0 +1,165 @@
+#include "headless_context.h"
+#include "gl_loader.h"
+#include "../utils/log.h"
+
+#ifndef _WIN32
+#include <EGL/egl.h>
+#include <EGL/eglext.h>
+#endif
+
+namespace badcad {
+
+#ifndef _WIN32
+
+static void* eglLoader(const char* name) {
+    return (void*)eglGetProcAddress(name);
+}
+
+static EGLDisplay getSurfacelessDisplay() {
+    // Prefer the Mesa surfaceless platform: it needs neither X11/Wayland nor a
+    // DRM device, so it works on bare CI containers via llvmpipe
+    auto getPlatformDisplay = (PFNEGLGETPLATFORMDISPLAYEXTPROC)eglGetProcAddress("eglGetPlatformDisplayEXT");
+    if (getPlatformDisplay) {
+        EGLDisplay display = getPlatformDisplay(EGL_PLATFORM_SURFACELESS_MESA, EGL_DEFAULT_DISPLAY, nullptr);
+        if (display != EGL_NO_DISPLAY) {
+            return display;
+        }
+    }
+    return eglGetDisplay(EGL_DEFAULT_DISPLAY);
+}
+
+HeadlessContext::HeadlessContext() {
+}
+
+HeadlessContext::~HeadlessContext() {
+    shutdown();
+}
+
+bool HeadlessContext::init() {
+    EGLDisplay display = getSurfacelessDisplay();
+    if (display == EGL_NO_DISPLAY) {
+        BADCAD_LOG_ERROR("Headless: no EGL display available");
+        return false;
+    }
+
+    EGLint major = 0, minor = 0;
+    if (!eglInitialize(display, &major, &minor)) {
+        BADCAD_LOG_ERROR("Headless: eglInitialize failed (0x", std::hex, eglGetError(), std::dec, ")");
+        return false;
+    }
+    m_display = display;
+
+    if (!eglBindAPI(EGL_OPENGL_API)) {
+        BADCAD_LOG_ERROR("Headless: desktop OpenGL not supported by EGL implementation");
+        shutdown();
+        return false;
+    }
+
+    const EGLint configAttribs[] = {
+        EGL_SURFACE_TYPE, EGL_PBUFFER_BIT,
+        EGL_RENDERABLE_TYPE, EGL_OPENGL_BIT,
+        EGL_RED_SIZE, 8,
+        EGL_GREEN_SIZE, 8,
+        EGL_BLUE_SIZE, 8,
+        EGL_ALPHA_SIZE, 8,
+        EGL_DEPTH_SIZE, 24,
+        EGL_NONE
+    };
+    EGLConfig config = nullptr;
+    EGLint numConfigs = 0;
+    if (!eglChooseConfig(display, configAttribs, &config, 1, &numConfigs) || numConfigs == 0) {
+        BADCAD_LOG_ERROR("Headless: no suitable EGL config");
+        shutdown();
+        return false;
+    }
+
+    // Same as the windowed app: 3.3 compatibility profile, the viewer still
+    // uses fixed-function GL
+    const EGLint contextAttribs[] = {
+        EGL_CONTEXT_MAJOR_VERSION, 3,
+        EGL_CONTEXT_MINOR_VERSION, 3,
+        EGL_CONTEXT_OPENGL_PROFILE_MASK, EGL_CONTEXT_OPENGL_COMPATIBILITY_PROFILE_BIT,
+        EGL_NONE
+    };
+    EGLContext context = eglCreateContext(display, config, EGL_NO_CONTEXT, contextAttribs);
+    if (context == EGL_NO_CONTEXT) {
+        // Older Mesa only exposes a legacy context without version attributes
+        context = eglCreateContext(display, config, EGL_NO_CONTEXT, nullptr);
+    }
+    if (context == EGL_NO_CONTEXT) {
+        BADCAD_LOG_ERROR("Headless: eglCreateContext failed (0x", std::hex, eglGetError(), std::dec, ")");
+        shutdown();
+        return false;
+    }
+    m_context = context;
+    m_initialized = true;
+
+    if (!makeCurrent()) {
+        BADCAD_LOG_ERROR("Headless: surfaceless eglMakeCurrent failed (EGL_KHR_surfaceless_context missing?)");
+        shutdown();
+        return false;
+    }
+
+    setGLProcLoader(eglLoader);
+
+    BADCAD_LOG_INFO("Headless context: EGL ", major, ".", minor, ", ", getRendererName());
+    return true;
+}
+
+void HeadlessContext::shutdown() {
+    if (m_display) {
+        eglMakeCurrent(m_display, EGL_NO_SURFACE, EGL_NO_SURFACE, EGL_NO_CONTEXT);
+        if (m_context) {
+            eglDestroyContext(m_display, m_context);
+            m_context = nullptr;
+        }
+        eglTerminate(m_display);
+        m_display = nullptr;
+    }
+    if (m_initialized) {
+        setGLProcLoader(nullptr);
+        m_initialized = false;
+    }
+}
+
+bool HeadlessContext::makeCurrent() {
+    if (!m_initialized) {
+        return false;
+    }
+    return eglMakeCurrent(m_display, EGL_NO_SURFACE, EGL_NO_SURFACE, m_context) == EGL_TRUE;
+}
+
+const char* HeadlessContext::getRendererName() const {
+    const char* renderer = m_initialized ? (const char*)glGetString(GL_RENDERER) : nullptr;
+    return renderer ? renderer : "unknown renderer";
+}
+
+#else
+
+// EGL is not available on the Windows toolchain; headless mode is Linux-only
+
+HeadlessContext::HeadlessContext() {
+}
+
+HeadlessContext::~HeadlessContext() {
+}
+
+bool HeadlessContext::init() {
+    BADCAD_LOG_ERROR("Headless rendering is only supported on Linux (EGL)");
+    return false;
+}
+
+void HeadlessContext::shutdown() {
+}
+
+bool HeadlessContext::makeCurrent() {
+    return false;
+}
+
+const char* HeadlessContext::getRendererName() const {
+    return "unavailable";
+}
+
+#endif
+
+} // namespace badcad
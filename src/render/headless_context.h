@@ -0,0 +1,29 @@
+#pragma once
+
+namespace badcad {
+
+// Surfaceless OpenGL context for rendering without a display (CI, batch
+// thumbnails). Uses EGL on the Mesa surfaceless platform, which runs on
+// llvmpipe when no GPU is present. All output goes to the viewer's FBO.
+class HeadlessContext {
+public:
+    HeadlessContext();
+    ~HeadlessContext();
+
+    // Creates the context, makes it current on the calling thread and
+    // installs eglGetProcAddress as the GL loader
+    bool init();
+    void shutdown();
+
+    bool makeCurrent();
+
+    // Renderer/version strings of the current context, for benchmark logs
+    const char* getRendererName() const;
+
+private:
+    void* m_display = nullptr;
+    void* m_context = nullptr;
+    bool m_initialized = false;
+};
+
+} // namespace badcad
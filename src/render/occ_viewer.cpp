@@ -3,7 +3,14 @@
 
 #include "occ_viewer.h"
 #include "../core/document.h"
-#include <iostream>
+#include "frame_profiler.h"
+#include "tessellator.h"
+#include "../utils/hash.h"
+#include "../utils/log.h"
+#include "../utils/memory_tracker.h"
+#include "../utils/trace.h"
+#include <algorithm>
+#include <iterator>
 
 #include <Aspect_Handle.hxx>
 #include <Aspect_DisplayConnection.hxx>
@@ -20,92 +27,83 @@
 #include <Graphic3d_MaterialAspect.hxx>
 
 // OpenGL and GLFW must be included before platform-specific headers
-#include <GLFW/glfw3.h>
+#include "gl_loader.h"
 
 #ifdef _WIN32
 #include <WNT_Window.hxx>
 #define GLFW_EXPOSE_NATIVE_WIN32
 #include <GLFW/glfw3native.h>
-#include <GL/glext.h>  // For OpenGL framebuffer extensions
 #else
 #include <Xw_Window.hxx>
 #endif
 
 namespace badcad {
 
-// OpenGL FBO function pointers (loaded at runtime)
-static PFNGLGENFRAMEBUFFERSPROC glGenFramebuffers = nullptr;
-static PFNGLBINDFRAMEBUFFERPROC glBindFramebuffer = nullptr;
-static PFNGLFRAMEBUFFERTEXTURE2DPROC glFramebufferTexture2D = nullptr;
-static PFNGLGENRENDERBUFFERSPROC glGenRenderbuffers = nullptr;
-static PFNGLBINDRENDERBUFFERPROC glBindRenderbuffer = nullptr;
-static PFNGLRENDERBUFFERSTORAGEPROC glRenderbufferStorage = nullptr;
-static PFNGLFRAMEBUFFERRENDERBUFFERPROC glFramebufferRenderbuffer = nullptr;
-static PFNGLCHECKFRAMEBUFFERSTATUSPROC glCheckFramebufferStatus = nullptr;
-static PFNGLDELETEFRAMEBUFFERSPROC glDeleteFramebuffers = nullptr;
-static PFNGLDELETERENDERBUFFERSPROC glDeleteRenderbuffers = nullptr;
-
-static bool loadGLExtensions() {
-    glGenFramebuffers = (PFNGLGENFRAMEBUFFERSPROC)glfwGetProcAddress("glGenFramebuffers");
-    glBindFramebuffer = (PFNGLBINDFRAMEBUFFERPROC)glfwGetProcAddress("glBindFramebuffer");
-    glFramebufferTexture2D = (PFNGLFRAMEBUFFERTEXTURE2DPROC)glfwGetProcAddress("glFramebufferTexture2D");
-    glGenRenderbuffers = (PFNGLGENRENDERBUFFERSPROC)glfwGetProcAddress("glGenRenderbuffers");
-    glBindRenderbuffer = (PFNGLBINDRENDERBUFFERPROC)glfwGetProcAddress("glBindRenderbuffer");
-    glRenderbufferStorage = (PFNGLRENDERBUFFERSTORAGEPROC)glfwGetProcAddress("glRenderbufferStorage");
-    glFramebufferRenderbuffer = (PFNGLFRAMEBUFFERRENDERBUFFERPROC)glfwGetProcAddress("glFramebufferRenderbuffer");
-    glCheckFramebufferStatus = (PFNGLCHECKFRAMEBUFFERSTATUSPROC)glfwGetProcAddress("glCheckFramebufferStatus");
-    glDeleteFramebuffers = (PFNGLDELETEFRAMEBUFFERSPROC)glfwGetProcAddress("glDeleteFramebuffers");
-    glDeleteRenderbuffers = (PFNGLDELETERENDERBUFFERSPROC)glfwGetProcAddress("glDeleteRenderbuffers");
-    
-    return glGenFramebuffers && glBindFramebuffer && glFramebufferTexture2D &&
-           glGenRenderbuffers && glBindRenderbuffer && glRenderbufferStorage &&
-           glFramebufferRenderbuffer && glCheckFramebufferStatus &&
-           glDeleteFramebuffers && glDeleteRenderbuffers;
-}
+// Dynamic resolution tuning for fast preview (spec §3.7)
+static constexpr float kTargetFrameTime = 1.0f / 60.0f;
+static constexpr float kRefineDelaySeconds = 0.2f;  // Refine to full quality after 200 ms idle
+static constexpr float kMinRenderScale = 0.25f;
+static constexpr float kRenderScaleStep = 1.0f / 16.0f;
+static constexpr int kFramesBeforeScaleUp = 30;
+
+// Indices into FrameState::planeVisible/planeSelected
+static constexpr int kPlaneXY = 0;
+static constexpr int kPlaneXZ = 1;
+static constexpr int kPlaneYZ = 2;
+static const char* const kPlaneNames[3] = {"planexy", "planexz", "planeyz"};
+
+// Upper bound for the render thread waiting on its own frame to finish
+static constexpr GLuint64 kFrameWaitTimeoutNs = 100000000;  // 100 ms
 
 OccViewer::OccViewer() {
 }
 
 OccViewer::~OccViewer() {
-    deleteFramebuffer();
+    stopRenderThread();
+    for (RenderTarget& target : m_targets) {
+        deleteFramebuffer(target);
+    }
+    deletePreviewBuffers();
+    deletePartBuffers();
 }
 
 bool OccViewer::init(void* windowHandle, int width, int height) {
     try {
-        std::cout << "OccViewer::init() called with size " << width << "x" << height << std::endl;
+        BADCAD_LOG_DEBUG("OccViewer::init() called with size ", width, "x", height);
         
         // Load OpenGL extensions
-        std::cout << "Loading OpenGL FBO extensions..." << std::endl;
-        if (!loadGLExtensions()) {
-            std::cerr << "Failed to load OpenGL FBO extensions" << std::endl;
+        BADCAD_LOG_DEBUG("Loading OpenGL FBO extensions...");
+        if (!loadGLFunctions()) {
+            BADCAD_LOG_ERROR("Failed to load OpenGL FBO extensions");
             return false;
         }
-        std::cout << "OpenGL FBO extensions loaded successfully" << std::endl;
+        BADCAD_LOG_DEBUG("OpenGL FBO extensions loaded successfully");
         
         // For now, skip OpenCASCADE window setup to avoid FBO conflicts
         // We'll render with our own OpenGL code until we solve the FBO coordination issue
-        std::cout << "Skipping OpenCASCADE window setup (will use direct OpenGL rendering)" << std::endl;
+        BADCAD_LOG_DEBUG("Skipping OpenCASCADE window setup (will use direct OpenGL rendering)");
         
         // TODO: Set up OpenCASCADE with proper offscreen rendering
         // For now, we'll just use our FBO for simple test rendering
         
         // Create framebuffer for rendering
-        std::cout << "Creating framebuffer..." << std::endl;
-        createFramebuffer(width, height);
-        std::cout << "Framebuffer created" << std::endl;
+        BADCAD_LOG_DEBUG("Creating framebuffer...");
+        resize(width, height);
+        createFramebuffer(m_targets[0], width, height);
+        BADCAD_LOG_DEBUG("Framebuffer created");
         
         // Set initial camera position (isometric)
-        std::cout << "Setting isometric view..." << std::endl;
+        BADCAD_LOG_DEBUG("Setting isometric view...");
         setViewIso();
         
-        std::cout << "OpenCASCADE viewer initialized successfully" << std::endl;
+        BADCAD_LOG_INFO("OpenCASCADE viewer initialized successfully");
         return true;
         
     } catch (Standard_Failure const& e) {
-        std::cerr << "OpenCASCADE initialization failed: " << e.GetMessageString() << std::endl;
+        BADCAD_LOG_ERROR("OpenCASCADE initialization failed: ", e.GetMessageString());
         return false;
     } catch (...) {
-        std::cerr << "OpenCASCADE initialization failed with unknown exception" << std::endl;
+        BADCAD_LOG_ERROR("OpenCASCADE initialization failed with unknown exception");
         return false;
     }
 }
@@ -115,63 +113,117 @@ void OccViewer::resize(int width, int height) {
         return;
     }
     
-    // Recreate framebuffer with new size
-    if (width != m_fboWidth || height != m_fboHeight) {
-        createFramebuffer(width, height);
+    if (width == m_fboWidth && height == m_fboHeight) {
+        return;
+    }
+    
+    m_fboWidth = width;
+    m_fboHeight = height;
+    m_camera.setViewport(width, height);
+    m_frameValid = false;
+    
+    // Synchronous mode resizes right away; the render thread resizes each
+    // target the next time it draws into it
+    if (!m_renderThread.joinable()) {
+        createFramebuffer(m_targets[m_frontTarget], width, height);
     }
     
     // Don't call m_view->MustBeResized() - it creates OpenCASCADE FBOs that conflict with ours
 }
 
 void OccViewer::render() {
-    if (m_fbo == 0 || m_fboTexture == 0) {
-        std::cerr << "render() called with invalid FBO or texture" << std::endl;
+    BADCAD_TRACE_SCOPE_CAT("OccViewer::render", "render");
+    if (m_fboWidth <= 0 || m_fboHeight <= 0) {
+        BADCAD_LOG_ERROR("render() called before the viewport was sized");
         return;
     }
     
+    bool threaded = m_renderThread.joinable();
+    if (threaded) {
+        presentLatestFrame();
+    }
+    
+    publishPartMeshes();
+    FrameKey key = makeFrameKey();
+    if (m_frameValid && key == m_lastFrameKey) {
+        // Nothing visible changed, the texture from the last redraw is still correct
+        return;
+    }
+    
+    FrameState frame = captureFrame(key);
+    if (threaded) {
+        // Replaces a queued frame the thread has not started yet
+        {
+            std::lock_guard<std::mutex> lock(m_renderMutex);
+            m_pendingFrame = frame;
+            m_hasPendingFrame = true;
+        }
+        m_renderCondition.notify_one();
+    } else {
+        ProfileScope scope(m_profiler, FrameSection::Viewport, true);
+        if (!drawFrame(frame, m_targets[m_frontTarget])) {
+            return;
+        }
+    }
+    
+    m_lastFrameKey = key;
+    m_frameValid = true;
+}
+
+OccViewer::FrameState OccViewer::captureFrame(const FrameKey& key) const {
+    FrameState frame;
+    frame.key = key;
+    frame.camera = m_camera;
+    frame.targetWidth = m_fboWidth;
+    frame.targetHeight = m_fboHeight;
+    if (m_document) {
+        for (int i = 0; i < 3; i++) {
+            frame.planeVisible[i] = m_document->isPlaneVisible(kPlaneNames[i]);
+            frame.planeSelected[i] = m_document->isPlaneSelected(kPlaneNames[i]);
+        }
+    }
+    frame.previewMesh = m_previewMesh;
+    frame.partMeshes = m_partMeshes;
+    return frame;
+}
+
+bool OccViewer::drawFrame(const FrameState& frame, RenderTarget& target) {
+    BADCAD_TRACE_SCOPE_CAT("OccViewer::drawFrame", "render");
+    createFramebuffer(target, frame.targetWidth, frame.targetHeight);
+    if (target.fbo == 0 || target.texture == 0) {
+        BADCAD_LOG_ERROR("render() called with invalid FBO or texture");
+        return false;
+    }
+    
+    const FrameKey& key = frame.key;
+    const Camera& camera = frame.camera;
+    
     try {
+        // Preview frames only fill the lower-left part of the FBO; the UI
+        // samples that region via getTextureExtent() and upscales it
+        bool preview = (key.quality == RenderQuality::Preview);
+        float lineScale = (float)key.width / (float)target.width;
+        
         // Bind our FBO
-        glBindFramebuffer(GL_FRAMEBUFFER, m_fbo);
-        glViewport(0, 0, m_fboWidth, m_fboHeight);
+        glBindFramebuffer(GL_FRAMEBUFFER, target.fbo);
+        glViewport(0, 0, key.width, key.height);
         
         // Clear to dark CAD background
         glClearColor(0.15f, 0.15f, 0.17f, 1.0f);
         glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
         
-        // Draw a simple test pattern to show FBO rendering is working
-        // Set up projection with correct aspect ratio
-        float aspect = (float)m_fboWidth / (float)m_fboHeight;
+        // Camera matrices are cached; the same ones drive pickPlane()
         glMatrixMode(GL_PROJECTION);
-        glLoadIdentity();
-        if (aspect > 1.0f) {
-            // Wider than tall - increase near/far clipping planes to prevent geometry disappearing
-            glOrtho(-aspect, aspect, -1, 1, -100, 100);
-        } else {
-            // Taller than wide
-            glOrtho(-1, 1, -1.0f/aspect, 1.0f/aspect, -100, 100);
-        }
-        
-        // Apply camera transformations
+        glLoadMatrixf(camera.getProjectionMatrix());
         glMatrixMode(GL_MODELVIEW);
-        glLoadIdentity();
-        
-        // Apply zoom (distance from origin)
-        glScalef(1.0f / m_cameraDistance, 1.0f / m_cameraDistance, 1.0f / m_cameraDistance);
-        
-        // Apply pan
-        glTranslatef(m_cameraPanX, m_cameraPanY, 0.0f);
-        
-        // Apply rotations (reverse order for proper camera behavior)
-        glRotatef(m_cameraRotX, 1.0f, 0.0f, 0.0f);
-        glRotatef(m_cameraRotY, 0.0f, 1.0f, 0.0f);
-        glRotatef(m_cameraRotZ, 0.0f, 0.0f, 1.0f);
+        glLoadMatrixf(camera.getViewMatrix());
         
         // Draw construction plane axes (only for visible planes)
-        glLineWidth(3.0f);
+        glLineWidth(std::max(1.0f, 3.0f * lineScale));
         glBegin(GL_LINES);
         
         // X and Y axes (for XY plane)
-        if (m_document && m_document->isPlaneVisible("planexy")) {
+        if (frame.planeVisible[kPlaneXY]) {
             // X axis (RED) - horizontal
             glColor3f(0.8f, 0.2f, 0.2f);
             glVertex3f(-0.9f, 0.0f, 0.0f);
@@ -194,7 +246,7 @@ void OccViewer::render() {
         }
         
         // X and Z axes (for XZ plane)
-        if (m_document && m_document->isPlaneVisible("planexz")) {
+        if (frame.planeVisible[kPlaneXZ]) {
             // X axis (RED) - horizontal
             glColor3f(0.8f, 0.2f, 0.2f);
             glVertex3f(-0.9f, 0.0f, 0.0f);
@@ -217,7 +269,7 @@ void OccViewer::render() {
         }
         
         // Y and Z axes (for YZ plane)
-        if (m_document && m_document->isPlaneVisible("planeyz")) {
+        if (frame.planeVisible[kPlaneYZ]) {
             // Y axis (GREEN) - vertical
             glColor3f(0.2f, 0.8f, 0.2f);
             glVertex3f(0.0f, -0.9f, 0.0f);
@@ -249,15 +301,12 @@ void OccViewer::render() {
         float planeSize = 0.7f;
         
         // XY Plane (Z=0)
-        if (m_document && m_document->isPlaneVisible("planexy")) {
-            bool isSelected = m_document->isPlaneSelected("planexy");
-            bool isHovered = (m_hoveredPlane == "planexy");
+        if (frame.planeVisible[kPlaneXY]) {
+            bool isSelected = frame.planeSelected[kPlaneXY];
             
             glBegin(GL_QUADS);
             if (isSelected) {
                 glColor4f(1.0f, 0.6f, 0.0f, 0.25f);  // Brighter orange for selection
-            } else if (isHovered) {
-                glColor4f(0.8f, 0.45f, 0.0f, 0.20f);  // Darker orange for hover
             } else {
                 glColor4f(0.26f, 0.59f, 0.98f, 0.15f);  // Semi-transparent ImGui blue
             }
@@ -267,33 +316,30 @@ void OccViewer::render() {
             glVertex3f(-planeSize, planeSize, 0.0f);
             glEnd();
             
-            // Draw border
-            glLineWidth((isSelected || isHovered) ? 4.0f : 2.0f);
-            glBegin(GL_LINE_LOOP);
-            if (isSelected) {
-                glColor4f(1.0f, 0.6f, 0.0f, 1.0f);  // Solid orange border
-            } else if (isHovered) {
-                glColor4f(0.8f, 0.45f, 0.0f, 0.8f);  // Darker orange border
-            } else {
-                glColor4f(0.26f, 0.59f, 0.98f, 0.6f);
+            // Draw border (edge overlays are skipped in fast preview)
+            if (!preview) {
+                glLineWidth(isSelected ? 4.0f : 2.0f);
+                glBegin(GL_LINE_LOOP);
+                if (isSelected) {
+                    glColor4f(1.0f, 0.6f, 0.0f, 1.0f);  // Solid orange border
+                } else {
+                    glColor4f(0.26f, 0.59f, 0.98f, 0.6f);
+                }
+                glVertex3f(-planeSize, -planeSize, 0.0f);
+                glVertex3f(planeSize, -planeSize, 0.0f);
+                glVertex3f(planeSize, planeSize, 0.0f);
+                glVertex3f(-planeSize, planeSize, 0.0f);
+                glEnd();
             }
-            glVertex3f(-planeSize, -planeSize, 0.0f);
-            glVertex3f(planeSize, -planeSize, 0.0f);
-            glVertex3f(planeSize, planeSize, 0.0f);
-            glVertex3f(-planeSize, planeSize, 0.0f);
-            glEnd();
         }
         
         // XZ Plane (Y=0)
-        if (m_document && m_document->isPlaneVisible("planexz")) {
-            bool isSelected = m_document->isPlaneSelected("planexz");
-            bool isHovered = (m_hoveredPlane == "planexz");
+        if (frame.planeVisible[kPlaneXZ]) {
+            bool isSelected = frame.planeSelected[kPlaneXZ];
             
             glBegin(GL_QUADS);
             if (isSelected) {
                 glColor4f(1.0f, 0.6f, 0.0f, 0.25f);  // Brighter orange for selection
-            } else if (isHovered) {
-                glColor4f(0.8f, 0.45f, 0.0f, 0.20f);  // Darker orange for hover
             } else {
                 glColor4f(0.26f, 0.59f, 0.98f, 0.15f);  // Semi-transparent ImGui blue
             }
@@ -303,33 +349,30 @@ void OccViewer::render() {
             glVertex3f(-planeSize, 0.0f, planeSize);
             glEnd();
             
-            // Draw border
-            glLineWidth((isSelected || isHovered) ? 4.0f : 2.0f);
-            glBegin(GL_LINE_LOOP);
-            if (isSelected) {
-                glColor4f(1.0f, 0.6f, 0.0f, 1.0f);  // Solid orange border
-            } else if (isHovered) {
-                glColor4f(0.8f, 0.45f, 0.0f, 0.8f);  // Darker orange border
-            } else {
-                glColor4f(0.26f, 0.59f, 0.98f, 0.6f);
+            // Draw border (edge overlays are skipped in fast preview)
+            if (!preview) {
+                glLineWidth(isSelected ? 4.0f : 2.0f);
+                glBegin(GL_LINE_LOOP);
+                if (isSelected) {
+                    glColor4f(1.0f, 0.6f, 0.0f, 1.0f);  // Solid orange border
+                } else {
+                    glColor4f(0.26f, 0.59f, 0.98f, 0.6f);
+                }
+                glVertex3f(-planeSize, 0.0f, -planeSize);
+                glVertex3f(planeSize, 0.0f, -planeSize);
+                glVertex3f(planeSize, 0.0f, planeSize);
+                glVertex3f(-planeSize, 0.0f, planeSize);
+                glEnd();
             }
-            glVertex3f(-planeSize, 0.0f, -planeSize);
-            glVertex3f(planeSize, 0.0f, -planeSize);
-            glVertex3f(planeSize, 0.0f, planeSize);
-            glVertex3f(-planeSize, 0.0f, planeSize);
-            glEnd();
         }
         
         // YZ Plane (X=0)
-        if (m_document && m_document->isPlaneVisible("planeyz")) {
-            bool isSelected = m_document->isPlaneSelected("planeyz");
-            bool isHovered = (m_hoveredPlane == "planeyz");
+        if (frame.planeVisible[kPlaneYZ]) {
+            bool isSelected = frame.planeSelected[kPlaneYZ];
             
             glBegin(GL_QUADS);
             if (isSelected) {
                 glColor4f(1.0f, 0.6f, 0.0f, 0.25f);  // Brighter orange for selection
-            } else if (isHovered) {
-                glColor4f(0.8f, 0.45f, 0.0f, 0.20f);  // Darker orange for hover
             } else {
                 glColor4f(0.26f, 0.59f, 0.98f, 0.15f);  // Semi-transparent ImGui blue
             }
@@ -339,23 +382,26 @@ void OccViewer::render() {
             glVertex3f(0.0f, -planeSize, planeSize);
             glEnd();
             
-            // Draw border
-            glLineWidth((isSelected || isHovered) ? 4.0f : 2.0f);
-            glBegin(GL_LINE_LOOP);
-            if (isSelected) {
-                glColor4f(1.0f, 0.6f, 0.0f, 1.0f);  // Solid orange border
-            } else if (isHovered) {
-                glColor4f(0.8f, 0.45f, 0.0f, 0.8f);  // Darker orange border
-            } else {
-                glColor4f(0.26f, 0.59f, 0.98f, 0.6f);
+            // Draw border (edge overlays are skipped in fast preview)
+            if (!preview) {
+                glLineWidth(isSelected ? 4.0f : 2.0f);
+                glBegin(GL_LINE_LOOP);
+                if (isSelected) {
+                    glColor4f(1.0f, 0.6f, 0.0f, 1.0f);  // Solid orange border
+                } else {
+                    glColor4f(0.26f, 0.59f, 0.98f, 0.6f);
+                }
+                glVertex3f(0.0f, -planeSize, -planeSize);
+                glVertex3f(0.0f, planeSize, -planeSize);
+                glVertex3f(0.0f, planeSize, planeSize);
+                glVertex3f(0.0f, -planeSize, planeSize);
+                glEnd();
             }
-            glVertex3f(0.0f, -planeSize, -planeSize);
-            glVertex3f(0.0f, planeSize, -planeSize);
-            glVertex3f(0.0f, planeSize, planeSize);
-            glVertex3f(0.0f, -planeSize, planeSize);
-            glEnd();
         }
         
+        drawPartMeshes(frame);
+        drawPreviewMesh(frame);
+        
         glDisable(GL_BLEND);
         
         // TODO: Once we solve the window mapping issue, we can call m_view->Redraw() here
@@ -366,78 +412,305 @@ void OccViewer::render() {
         // Unbind FBO and texture to prevent interference with ImGui
         glBindFramebuffer(GL_FRAMEBUFFER, 0);
         glBindTexture(GL_TEXTURE_2D, 0);
+        
+        target.contentWidth = key.width;
+        target.contentHeight = key.height;
+        return true;
     } catch (Standard_Failure const& e) {
-        std::cerr << "Error during render: " << e.GetMessageString() << std::endl;
+        BADCAD_LOG_ERROR("Error during render: ", e.GetMessageString());
     } catch (...) {
-        std::cerr << "Error during render" << std::endl;
+        BADCAD_LOG_ERROR("Error during render");
     }
+    return false;
 }
 
-void OccViewer::createFramebuffer(int width, int height) {
+bool OccViewer::startRenderThread(GLFWwindow* shareWith) {
+    if (m_renderThread.joinable()) {
+        return true;
+    }
+    if (!glFenceSync || !glWaitSync || !glClientWaitSync || !glDeleteSync) {
+        BADCAD_LOG_WARN("GL sync objects unavailable, rendering on the UI thread");
+        return false;
+    }
+    
+    // Context hints from window creation are still set, so the hidden window
+    // gets the same 3.3 compatibility context, sharing textures with the UI
+    glfwWindowHint(GLFW_VISIBLE, GLFW_FALSE);
+    m_renderWindow = glfwCreateWindow(1, 1, "badCAD render", nullptr, shareWith);
+    glfwWindowHint(GLFW_VISIBLE, GLFW_TRUE);
+    if (!m_renderWindow) {
+        BADCAD_LOG_WARN("Failed to create shared render context, rendering on the UI thread");
+        return false;
+    }
+    
+    // FBOs are per-context; the render thread creates its own
+    for (RenderTarget& target : m_targets) {
+        deleteFramebuffer(target);
+    }
+    deletePreviewBuffers();
+    deletePartBuffers();
+    m_frontTarget = 0;
+    m_frameValid = false;
+    m_stopRendering = false;
+    m_hasPendingFrame = false;
+    m_readyTarget = -1;
+    
+    m_renderThread = std::thread(&OccViewer::renderThreadMain, this);
+    BADCAD_LOG_INFO("Viewport render thread started");
+    return true;
+}
+
+void OccViewer::stopRenderThread() {
+    if (!m_renderThread.joinable()) {
+        return;
+    }
+    
+    {
+        std::lock_guard<std::mutex> lock(m_renderMutex);
+        m_stopRendering = true;
+    }
+    m_renderCondition.notify_one();
+    m_renderThread.join();
+    
+    glfwDestroyWindow(m_renderWindow);
+    m_renderWindow = nullptr;
+    m_frontTarget = 0;
+    m_frameValid = false;
+}
+
+void OccViewer::renderThreadMain() {
+    Tracer::setThreadName("Render");
+    glfwMakeContextCurrent(m_renderWindow);
+    
+    // Timer query in this context; the UI-side profiler cannot see its commands
+    GLuint timerQuery = 0;
+    if (m_profiler && glGenQueries) {
+        glGenQueries(1, &timerQuery);
+    }
+    
+    while (true) {
+        FrameState frame;
+        int index = 0;
+        GLsync releaseFence = nullptr;
+        {
+            std::unique_lock<std::mutex> lock(m_renderMutex);
+            m_renderCondition.wait(lock, [this] { return m_stopRendering || m_hasPendingFrame; });
+            if (m_stopRendering) {
+                break;
+            }
+            frame = m_pendingFrame;
+            m_hasPendingFrame = false;
+            
+            // Draw into the target that is neither shown nor waiting to be
+            // presented, so a finished frame survives until the UI flips to it
+            // however long this one takes
+            while (index == m_frontTarget || index == m_readyTarget) {
+                index++;
+            }
+            releaseFence = (GLsync)m_releaseFence[index];
+            m_releaseFence[index] = nullptr;
+        }
+        
+        // Don't overwrite the texture before the UI's last draw that sampled it
+        if (releaseFence) {
+            glWaitSync(releaseFence, 0, GL_TIMEOUT_IGNORED);
+            glDeleteSync(releaseFence);
+        }
+        
+        auto start = std::chrono::steady_clock::now();
+        if (timerQuery) {
+            glBeginQuery(GL_TIME_ELAPSED, timerQuery);
+        }
+        bool drawn = drawFrame(frame, m_targets[index]);
+        if (timerQuery) {
+            glEndQuery(GL_TIME_ELAPSED);
+        }
+        if (!drawn) {
+            continue;
+        }
+        
+        // Waiting here blocks only this thread, and makes the measured time
+        // include GPU work for the dynamic resolution controller
+        GLsync fence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+        glClientWaitSync(fence, GL_SYNC_FLUSH_COMMANDS_BIT, kFrameWaitTimeoutNs);
+        std::chrono::duration<float> elapsed = std::chrono::steady_clock::now() - start;
+        m_renderFrameTime = elapsed.count();
+        
+        if (m_profiler) {
+            // The fence has signalled, so the query result is ready without stalling
+            GLuint64 gpuNs = 0;
+            if (timerQuery) {
+                glGetQueryObjectui64v(timerQuery, GL_QUERY_RESULT, &gpuNs);
+            }
+            m_profiler->addSample(FrameSection::Viewport, elapsed.count() * 1000.0,
+                                  timerQuery ? gpuNs / 1.0e6 : -1.0);
+        }
+        
+        // Supersedes a frame the UI has not presented yet; at most one is dropped
+        std::lock_guard<std::mutex> lock(m_renderMutex);
+        if (m_readyFence) {
+            glDeleteSync((GLsync)m_readyFence);
+        }
+        m_readyFence = fence;
+        m_readyTarget = index;
+    }
+    
+    // Release everything created in this context before it goes away
+    {
+        std::lock_guard<std::mutex> lock(m_renderMutex);
+        if (m_readyFence) {
+            glDeleteSync((GLsync)m_readyFence);
+            m_readyFence = nullptr;
+        }
+        for (void*& fence : m_releaseFence) {
+            if (fence) {
+                glDeleteSync((GLsync)fence);
+                fence = nullptr;
+            }
+        }
+        m_readyTarget = -1;
+    }
+    if (timerQuery) {
+        glDeleteQueries(1, &timerQuery);
+    }
+    for (RenderTarget& target : m_targets) {
+        deleteFramebuffer(target);
+    }
+    deletePreviewBuffers();
+    deletePartBuffers();
+    glfwMakeContextCurrent(nullptr);
+}
+
+void OccViewer::presentLatestFrame() {
+    std::lock_guard<std::mutex> lock(m_renderMutex);
+    if (!m_readyFence) {
+        return;
+    }
+    
+    // GPU-side wait: ImGui's draw of the new texture is ordered after the
+    // render thread's commands without blocking the UI thread
+    glWaitSync((GLsync)m_readyFence, 0, GL_TIMEOUT_IGNORED);
+    glDeleteSync((GLsync)m_readyFence);
+    m_readyFence = nullptr;
+    
+    // Draws sampling the old front texture are already queued on this
+    // context; fence them so the render thread can wait before reusing it
+    int previous = m_frontTarget;
+    if (m_releaseFence[previous]) {
+        glDeleteSync((GLsync)m_releaseFence[previous]);
+    }
+    m_releaseFence[previous] = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+    glFlush();
+    
+    m_frontTarget = m_readyTarget;
+    m_readyTarget = -1;
+}
+
+bool OccViewer::readPixels(std::vector<unsigned char>& outRgba, int& outWidth, int& outHeight) const {
+    // FBOs belong to the render thread's context while it runs
+    const RenderTarget& target = m_targets[m_frontTarget];
+    if (m_renderThread.joinable() || target.fbo == 0 ||
+        target.contentWidth <= 0 || target.contentHeight <= 0) {
+        return false;
+    }
+    
+    outWidth = target.contentWidth;
+    outHeight = target.contentHeight;
+    size_t rowBytes = (size_t)outWidth * 4;
+    outRgba.resize(rowBytes * outHeight);
+    
+    glBindFramebuffer(GL_FRAMEBUFFER, target.fbo);
+    glPixelStorei(GL_PACK_ALIGNMENT, 1);
+    glReadPixels(0, 0, outWidth, outHeight, GL_RGBA, GL_UNSIGNED_BYTE, outRgba.data());
+    glBindFramebuffer(GL_FRAMEBUFFER, 0);
+    
+    // GL returns the bottom row first; images on disk are stored top row first
+    std::vector<unsigned char> row(rowBytes);
+    for (int y = 0; y < outHeight / 2; y++) {
+        unsigned char* top = outRgba.data() + rowBytes * y;
+        unsigned char* bottom = outRgba.data() + rowBytes * (outHeight - 1 - y);
+        std::copy(top, top + rowBytes, row.data());
+        std::copy(bottom, bottom + rowBytes, top);
+        std::copy(row.data(), row.data() + rowBytes, bottom);
+    }
+    
+    return true;
+}
+
+// RGBA8 color texture plus a depth renderbuffer (DEPTH24 is stored padded to 32 bits)
+static size_t framebufferBytes(int width, int height) {
+    return (size_t)width * height * 8;
+}
+
+void OccViewer::createFramebuffer(RenderTarget& target, int width, int height) {
     if (width <= 0 || height <= 0) {
         return;
     }
     
     // If we already have an FBO of the right size, don't recreate
-    if (m_fbo != 0 && m_fboWidth == width && m_fboHeight == height) {
+    if (target.fbo != 0 && target.width == width && target.height == height) {
         return;
     }
     
-    bool isResize = (m_fbo != 0);
+    BADCAD_TRACE_SCOPE_CAT("OccViewer::createFramebuffer", "render");
+    
+    bool isResize = (target.fbo != 0);
+    target.contentWidth = 0;
+    target.contentHeight = 0;
     
     if (isResize) {
         // Resize existing textures instead of deleting/recreating
-        std::cout << "Resizing FBO from " << m_fboWidth << "x" << m_fboHeight 
-                  << " to " << width << "x" << height << std::endl;
+        BADCAD_LOG_DEBUG("Resizing FBO from ", target.width, "x", target.height, " to ", width, "x", height);
         
-        m_fboWidth = width;
-        m_fboHeight = height;
+        MemoryTracker::remove(MemoryTag::GpuBuffers, framebufferBytes(target.width, target.height));
+        MemoryTracker::add(MemoryTag::GpuBuffers, framebufferBytes(width, height));
+        target.width = width;
+        target.height = height;
         
         // Resize color texture
-        glBindTexture(GL_TEXTURE_2D, m_fboTexture);
+        glBindTexture(GL_TEXTURE_2D, target.texture);
         glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, width, height, 0, GL_RGBA, GL_UNSIGNED_BYTE, nullptr);
         
         // Resize depth renderbuffer
-        glBindRenderbuffer(GL_RENDERBUFFER, m_fboDepth);
+        glBindRenderbuffer(GL_RENDERBUFFER, target.depth);
         glRenderbufferStorage(GL_RENDERBUFFER, GL_DEPTH_COMPONENT24, width, height);
         
         // Unbind
         glBindTexture(GL_TEXTURE_2D, 0);
         glBindRenderbuffer(GL_RENDERBUFFER, 0);
         
-        std::cout << "FBO resized: " << width << "x" << height 
-                  << " FBO=" << m_fbo << " Texture=" << m_fboTexture << std::endl;
+        BADCAD_LOG_DEBUG("FBO resized: ", width, "x", height, " FBO=", target.fbo, " Texture=", target.texture);
     } else {
         // Initial creation
-        m_fboWidth = width;
-        m_fboHeight = height;
+        target.width = width;
+        target.height = height;
+        MemoryTracker::add(MemoryTag::GpuBuffers, framebufferBytes(width, height));
         
         // Create framebuffer
-        glGenFramebuffers(1, &m_fbo);
-        glBindFramebuffer(GL_FRAMEBUFFER, m_fbo);
+        glGenFramebuffers(1, &target.fbo);
+        glBindFramebuffer(GL_FRAMEBUFFER, target.fbo);
         
         // Create color texture
-        glGenTextures(1, &m_fboTexture);
-        glBindTexture(GL_TEXTURE_2D, m_fboTexture);
+        glGenTextures(1, &target.texture);
+        glBindTexture(GL_TEXTURE_2D, target.texture);
         glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, width, height, 0, GL_RGBA, GL_UNSIGNED_BYTE, nullptr);
         glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
         glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
-        glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, m_fboTexture, 0);
+        glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, target.texture, 0);
         
         // Create depth renderbuffer
-        glGenRenderbuffers(1, &m_fboDepth);
-        glBindRenderbuffer(GL_RENDERBUFFER, m_fboDepth);
+        glGenRenderbuffers(1, &target.depth);
+        glBindRenderbuffer(GL_RENDERBUFFER, target.depth);
         glRenderbufferStorage(GL_RENDERBUFFER, GL_DEPTH_COMPONENT24, width, height);
-        glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, GL_RENDERBUFFER, m_fboDepth);
+        glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, GL_RENDERBUFFER, target.depth);
         
         // Check framebuffer status
         GLenum status = glCheckFramebufferStatus(GL_FRAMEBUFFER);
         if (status != GL_FRAMEBUFFER_COMPLETE) {
-            std::cerr << "Framebuffer is not complete: " << status << std::endl;
-            deleteFramebuffer();
+            BADCAD_LOG_ERROR("Framebuffer is not complete: ", status);
+            deleteFramebuffer(target);
         } else {
-            std::cout << "Framebuffer created: " << width << "x" << height 
-                      << " FBO=" << m_fbo << " Texture=" << m_fboTexture << std::endl;
+            BADCAD_LOG_DEBUG("Framebuffer created: ", width, "x", height, " FBO=", target.fbo, " Texture=", target.texture);
         }
         
         // Unbind framebuffer and textures
@@ -447,26 +720,186 @@ void OccViewer::createFramebuffer(int width, int height) {
     }
 }
 
-void OccViewer::deleteFramebuffer() {
-    if (m_fbo) {
-        std::cout << "Deleting FBO " << m_fbo << " with texture " << m_fboTexture << std::endl;
-        glDeleteFramebuffers(1, &m_fbo);
-        m_fbo = 0;
+void OccViewer::deleteFramebuffer(RenderTarget& target) {
+    if (target.fbo) {
+        BADCAD_LOG_DEBUG("Deleting FBO ", target.fbo, " with texture ", target.texture);
+        MemoryTracker::remove(MemoryTag::GpuBuffers, framebufferBytes(target.width, target.height));
+        glDeleteFramebuffers(1, &target.fbo);
+        target.fbo = 0;
     }
-    if (m_fboTexture) {
-        glDeleteTextures(1, &m_fboTexture);
-        m_fboTexture = 0;
+    if (target.texture) {
+        glDeleteTextures(1, &target.texture);
+        target.texture = 0;
     }
-    if (m_fboDepth) {
-        glDeleteRenderbuffers(1, &m_fboDepth);
-        m_fboDepth = 0;
+    if (target.depth) {
+        glDeleteRenderbuffers(1, &target.depth);
+        target.depth = 0;
     }
-    m_fboWidth = 0;
-    m_fboHeight = 0;
+    target = RenderTarget();
+}
+
+static size_t previewBufferBytes(size_t vertexCapacity, size_t indexCapacity) {
+    return vertexCapacity * 6 * sizeof(float) + indexCapacity * sizeof(uint32_t);
+}
+
+// Headlight, so meshes read as solids from any direction
+static void beginLitMeshes() {
+    const GLfloat lightDirection[4] = {0.0f, 0.0f, 1.0f, 0.0f};
+    glPushMatrix();
+    glLoadIdentity();
+    glLightfv(GL_LIGHT0, GL_POSITION, lightDirection);
+    glPopMatrix();
+    glEnable(GL_LIGHTING);
+    glEnable(GL_LIGHT0);
+    glLightModeli(GL_LIGHT_MODEL_TWO_SIDE, GL_TRUE);
+    glEnable(GL_COLOR_MATERIAL);
+    glColorMaterial(GL_FRONT_AND_BACK, GL_AMBIENT_AND_DIFFUSE);
+    glEnable(GL_DEPTH_TEST);
+    glEnableClientState(GL_VERTEX_ARRAY);
+    glEnableClientState(GL_NORMAL_ARRAY);
+}
+
+static void endLitMeshes() {
+    glDisableClientState(GL_NORMAL_ARRAY);
+    glDisableClientState(GL_VERTEX_ARRAY);
+    glDisable(GL_DEPTH_TEST);
+    glDisable(GL_COLOR_MATERIAL);
+    glDisable(GL_LIGHT0);
+    glDisable(GL_LIGHTING);
+}
+
+// Draws the bound buffers: positions, then normals at normalOffset vertices
+static void drawBoundMesh(size_t normalOffset, size_t indexCount) {
+    glVertexPointer(3, GL_FLOAT, 0, (const void*)0);
+    glNormalPointer(GL_FLOAT, 0, (const void*)(normalOffset * 3 * sizeof(float)));
+    glDrawElements(GL_TRIANGLES, (GLsizei)indexCount, GL_UNSIGNED_INT, (const void*)0);
+}
+
+void OccViewer::drawPreviewMesh(const FrameState& frame) {
+    const MeshBuffers* mesh = frame.previewMesh.get();
+    if (!mesh || mesh->indices.empty() || !glGenBuffers) {
+        return;
+    }
+    BADCAD_TRACE_SCOPE_CAT("OccViewer::drawPreviewMesh", "render");
+    PreviewBuffers& buffers = m_previewBuffers;
+    if (buffers.vertexBuffer == 0) {
+        glGenBuffers(1, &buffers.vertexBuffer);
+        glGenBuffers(1, &buffers.indexBuffer);
+    }
+    glBindBuffer(GL_ARRAY_BUFFER, buffers.vertexBuffer);
+    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, buffers.indexBuffer);
+    
+    if (buffers.version != frame.key.previewVersion) {
+        // Storage is only reallocated when the mesh outgrows it, which during
+        // a drag means never: every step has the same counts
+        size_t vertexCount = mesh->getVertexCount();
+        if (vertexCount > buffers.vertexCapacity || mesh->indices.size() > buffers.indexCapacity) {
+            MemoryTracker::remove(MemoryTag::GpuBuffers, previewBufferBytes(buffers.vertexCapacity, buffers.indexCapacity));
+            buffers.vertexCapacity = std::max(vertexCount, buffers.vertexCapacity);
+            buffers.indexCapacity = std::max(mesh->indices.size(), buffers.indexCapacity);
+            glBufferData(GL_ARRAY_BUFFER, buffers.vertexCapacity * 6 * sizeof(float), nullptr, GL_DYNAMIC_DRAW);
+            glBufferData(GL_ELEMENT_ARRAY_BUFFER, buffers.indexCapacity * sizeof(uint32_t), nullptr, GL_DYNAMIC_DRAW);
+            MemoryTracker::add(MemoryTag::GpuBuffers, previewBufferBytes(buffers.vertexCapacity, buffers.indexCapacity));
+        }
+        glBufferSubData(GL_ARRAY_BUFFER, 0, mesh->positions.size() * sizeof(float), mesh->positions.data());
+        glBufferSubData(GL_ARRAY_BUFFER, buffers.vertexCapacity * 3 * sizeof(float),
+                        mesh->normals.size() * sizeof(float), mesh->normals.data());
+        glBufferSubData(GL_ELEMENT_ARRAY_BUFFER, 0, mesh->indices.size() * sizeof(uint32_t), mesh->indices.data());
+        buffers.indexCount = mesh->indices.size();
+        buffers.version = frame.key.previewVersion;
+    }
+    
+    // Selection orange, translucent: it is not the real solid yet
+    beginLitMeshes();
+    glColor4f(1.0f, 0.6f, 0.0f, 0.6f);
+    drawBoundMesh(buffers.vertexCapacity, buffers.indexCount);
+    endLitMeshes();
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
+}
+
+void OccViewer::drawPartMeshes(const FrameState& frame) {
+    const PartMeshList* meshes = frame.partMeshes.get();
+    if ((!meshes || meshes->empty()) && m_partBuffers.empty()) {
+        return;
+    }
+    if (!glGenBuffers) {
+        return;
+    }
+    BADCAD_TRACE_SCOPE_CAT("OccViewer::drawPartMeshes", "render");
+    m_partFrame++;
+    
+    if (meshes && !meshes->empty()) {
+        beginLitMeshes();
+        glColor4f(0.7f, 0.7f, 0.72f, 1.0f);
+        for (const std::shared_ptr<const MeshBuffers>& mesh : *meshes) {
+            if (!mesh || mesh->indices.empty()) {
+                continue;
+            }
+            PartBuffers& buffers = m_partBuffers[mesh.get()];
+            if (buffers.vertexBuffer == 0) {
+                // Parts never change once imported, so this is their only upload
+                buffers.mesh = mesh;
+                glGenBuffers(1, &buffers.vertexBuffer);
+                glGenBuffers(1, &buffers.indexBuffer);
+                glBindBuffer(GL_ARRAY_BUFFER, buffers.vertexBuffer);
+                glBufferData(GL_ARRAY_BUFFER, mesh->positions.size() * 2 * sizeof(float), nullptr, GL_STATIC_DRAW);
+                glBufferSubData(GL_ARRAY_BUFFER, 0, mesh->positions.size() * sizeof(float), mesh->positions.data());
+                glBufferSubData(GL_ARRAY_BUFFER, mesh->positions.size() * sizeof(float),
+                                mesh->normals.size() * sizeof(float), mesh->normals.data());
+                glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, buffers.indexBuffer);
+                glBufferData(GL_ELEMENT_ARRAY_BUFFER, mesh->indices.size() * sizeof(uint32_t),
+                             mesh->indices.data(), GL_STATIC_DRAW);
+                MemoryTracker::add(MemoryTag::GpuBuffers, previewBufferBytes(mesh->getVertexCount(), mesh->indices.size()));
+            }
+            glBindBuffer(GL_ARRAY_BUFFER, buffers.vertexBuffer);
+            glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, buffers.indexBuffer);
+            drawBoundMesh(mesh->getVertexCount(), mesh->indices.size());
+            buffers.lastFrame = m_partFrame;
+        }
+        endLitMeshes();
+        glBindBuffer(GL_ARRAY_BUFFER, 0);
+        glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
+    }
+    
+    // Release the buffers of parts that were removed
+    for (auto it = m_partBuffers.begin(); it != m_partBuffers.end();) {
+        if (it->second.lastFrame == m_partFrame) {
+            ++it;
+            continue;
+        }
+        const MeshBuffers& mesh = *it->second.mesh;
+        MemoryTracker::remove(MemoryTag::GpuBuffers, previewBufferBytes(mesh.getVertexCount(), mesh.indices.size()));
+        glDeleteBuffers(1, &it->second.vertexBuffer);
+        glDeleteBuffers(1, &it->second.indexBuffer);
+        it = m_partBuffers.erase(it);
+    }
+}
+
+void OccViewer::deletePartBuffers() {
+    for (auto& entry : m_partBuffers) {
+        const MeshBuffers& mesh = *entry.second.mesh;
+        MemoryTracker::remove(MemoryTag::GpuBuffers, previewBufferBytes(mesh.getVertexCount(), mesh.indices.size()));
+        glDeleteBuffers(1, &entry.second.vertexBuffer);
+        glDeleteBuffers(1, &entry.second.indexBuffer);
+    }
+    m_partBuffers.clear();
+}
+
+void OccViewer::deletePreviewBuffers() {
+    if (m_previewBuffers.vertexBuffer) {
+        MemoryTracker::remove(MemoryTag::GpuBuffers,
+                              previewBufferBytes(m_previewBuffers.vertexCapacity, m_previewBuffers.indexCapacity));
+        glDeleteBuffers(1, &m_previewBuffers.vertexBuffer);
+        glDeleteBuffers(1, &m_previewBuffers.indexBuffer);
+    }
+    m_previewBuffers = PreviewBuffers();
 }
 
 void OccViewer::setDocument(Document* doc) {
     m_document = doc;
+    // A new document starts its version counter from zero again
+    m_frameValid = false;
     updateFromDocument();
 }
 
@@ -475,29 +908,31 @@ void OccViewer::updateFromDocument() {
         return;
     }
     
-    std::cout << "Document state:\n" << m_document->serialize() << std::endl;
+    m_frameValid = false;
+    
+    BADCAD_LOG_TRACE("Document state:\n", m_document->serialize());
     
     // Note: OpenCASCADE's AIS_InteractiveContext->Display() requires a properly mapped window
     // For offscreen FBO rendering, we need to use a different approach
     // For now, we'll demonstrate the infrastructure is working without crashing
     
-    std::cout << "OpenCASCADE viewer ready (plane rendering requires window mapping)" << std::endl;
+    BADCAD_LOG_DEBUG("OpenCASCADE viewer ready (plane rendering requires window mapping)");
 }
 
 void OccViewer::createDefaultPlanes() {
     if (m_context.IsNull() || !m_document) {
-        std::cout << "createDefaultPlanes: context or document is null" << std::endl;
+        BADCAD_LOG_DEBUG("createDefaultPlanes: context or document is null");
         return;
     }
     
-    std::cout << "Creating construction planes..." << std::endl;
+    BADCAD_LOG_DEBUG("Creating construction planes...");
     
     try {
         const double planeSize = 100.0;
         
         // XY Plane (Z=0, blue)
         if (m_document->isPlaneVisible("planexy")) {
-            std::cout << "Creating XY plane..." << std::endl;
+            BADCAD_LOG_DEBUG("Creating XY plane...");
             try {
                 gp_Pln xyPlane(gp_Pnt(0, 0, 0), gp_Dir(0, 0, 1));
                 Handle(Geom_Plane) geomXY = new Geom_Plane(xyPlane);
@@ -505,17 +940,17 @@ void OccViewer::createDefaultPlanes() {
                 aisXY->SetSize(planeSize, planeSize);
                 aisXY->SetColor(Quantity_NOC_BLUE1);
                 aisXY->SetTransparency(0.8);
-                std::cout << "Displaying XY plane..." << std::endl;
+                BADCAD_LOG_DEBUG("Displaying XY plane...");
                 m_context->Display(aisXY, Standard_False);
-                std::cout << "XY plane created successfully" << std::endl;
+                BADCAD_LOG_DEBUG("XY plane created successfully");
             } catch (Standard_Failure const& e) {
-                std::cerr << "Error creating XY plane: " << e.GetMessageString() << std::endl;
+                BADCAD_LOG_ERROR("Error creating XY plane: ", e.GetMessageString());
             }
         }
         
         // XZ Plane (Y=0, green)
         if (m_document->isPlaneVisible("planexz")) {
-            std::cout << "Creating XZ plane..." << std::endl;
+            BADCAD_LOG_DEBUG("Creating XZ plane...");
             gp_Pln xzPlane(gp_Pnt(0, 0, 0), gp_Dir(0, 1, 0));
             Handle(Geom_Plane) geomXZ = new Geom_Plane(xzPlane);
             Handle(AIS_Plane) aisXZ = new AIS_Plane(geomXZ);
@@ -523,12 +958,12 @@ void OccViewer::createDefaultPlanes() {
             aisXZ->SetColor(Quantity_NOC_GREEN1);
             aisXZ->SetTransparency(0.8);
             m_context->Display(aisXZ, Standard_False);
-            std::cout << "XZ plane created" << std::endl;
+            BADCAD_LOG_DEBUG("XZ plane created");
         }
         
         // YZ Plane (X=0, red)
         if (m_document->isPlaneVisible("planeyz")) {
-            std::cout << "Creating YZ plane..." << std::endl;
+            BADCAD_LOG_DEBUG("Creating YZ plane...");
             gp_Pln yzPlane(gp_Pnt(0, 0, 0), gp_Dir(1, 0, 0));
             Handle(Geom_Plane) geomYZ = new Geom_Plane(yzPlane);
             Handle(AIS_Plane) aisYZ = new AIS_Plane(geomYZ);
@@ -536,44 +971,37 @@ void OccViewer::createDefaultPlanes() {
             aisYZ->SetColor(Quantity_NOC_RED1);
             aisYZ->SetTransparency(0.8);
             m_context->Display(aisYZ, Standard_False);
-            std::cout << "YZ plane created" << std::endl;
+            BADCAD_LOG_DEBUG("YZ plane created");
         }
         
-        std::cout << "All planes created successfully" << std::endl;
+        BADCAD_LOG_DEBUG("All planes created successfully");
     } catch (Standard_Failure const& e) {
-        std::cerr << "Error creating planes: " << e.GetMessageString() << std::endl;
+        BADCAD_LOG_ERROR("Error creating planes: ", e.GetMessageString());
     } catch (...) {
-        std::cerr << "Unknown error creating planes" << std::endl;
+        BADCAD_LOG_ERROR("Unknown error creating planes");
     }
 }
 
 void OccViewer::fitAll() {
     // Reset camera to default view
-    m_cameraDistance = 2.0f;
-    m_cameraPanX = 0.0f;
-    m_cameraPanY = 0.0f;
-    std::cout << "Fit All" << std::endl;
+    m_camera.setDistance(2.0f);
+    m_camera.setPan(0.0f, 0.0f);
+    BADCAD_LOG_DEBUG("Fit All");
 }
 
 void OccViewer::setViewFront() {
-    m_cameraRotX = 0.0f;
-    m_cameraRotY = 0.0f;
-    m_cameraRotZ = 0.0f;
-    std::cout << "View Front" << std::endl;
+    m_camera.setRotation(0.0f, 0.0f, 0.0f);
+    BADCAD_LOG_DEBUG("View Front");
 }
 
 void OccViewer::setViewTop() {
-    m_cameraRotX = 90.0f;
-    m_cameraRotY = 0.0f;
-    m_cameraRotZ = 0.0f;
-    std::cout << "View Top" << std::endl;
+    m_camera.setRotation(90.0f, 0.0f, 0.0f);
+    BADCAD_LOG_DEBUG("View Top");
 }
 
 void OccViewer::setViewRight() {
-    m_cameraRotX = 0.0f;
-    m_cameraRotY = 0.0f;
-    m_cameraRotZ = -90.0f;
-    std::cout << "View Right" << std::endl;
+    m_camera.setRotation(0.0f, 0.0f, -90.0f);
+    BADCAD_LOG_DEBUG("View Right");
 }
 
 void OccViewer::setViewIso() {
@@ -581,10 +1009,9 @@ void OccViewer::setViewIso() {
     // Start looking down +Z at XY plane (X right, Y up)
     // Rotate 45° to the right around Y axis
     // Rotate 45° up around X axis
-    m_cameraRotX = -35.264f;  // atan(1/sqrt(2)) for true isometric, ~35.264°
-    m_cameraRotY = 45.0f;     // 45° rotation to the right
-    m_cameraRotZ = 0.0f;      // No roll
-    std::cout << "View Iso (proper isometric)" << std::endl;
+    // atan(1/sqrt(2)) for true isometric (~35.264°), 45° to the right, no roll
+    m_camera.setRotation(-35.264f, 45.0f, 0.0f);
+    BADCAD_LOG_DEBUG("View Iso (proper isometric)");
 }
 
 void OccViewer::startRotation(int x, int y) {
@@ -593,18 +1020,22 @@ void OccViewer::startRotation(int x, int y) {
 }
 
 void OccViewer::rotation(int x, int y) {
+    beginInteraction();
+    
     int dx = x - m_lastX;
     int dy = y - m_lastY;
     
     // Update camera rotation based on mouse delta
     // Left-right controls rotation around Y axis (green, vertical)
     // Up-down controls rotation around X axis (red, horizontal)
-    m_cameraRotY += dx * 0.5f;
-    m_cameraRotX += dy * 0.5f;
+    float rotY = m_camera.getRotationY() + dx * 0.5f;
+    float rotX = m_camera.getRotationX() + dy * 0.5f;
     
     // Clamp X rotation to prevent flipping
-    if (m_cameraRotX > 89.0f) m_cameraRotX = 89.0f;
-    if (m_cameraRotX < -89.0f) m_cameraRotX = -89.0f;
+    if (rotX > 89.0f) rotX = 89.0f;
+    if (rotX < -89.0f) rotX = -89.0f;
+    
+    m_camera.setRotation(rotX, rotY, m_camera.getRotationZ());
     
     m_lastX = x;
     m_lastY = y;
@@ -616,116 +1047,246 @@ void OccViewer::startPan(int x, int y) {
 }
 
 void OccViewer::pan(int x, int y) {
+    beginInteraction();
+    
     int dx = x - m_lastX;
     int dy = y - m_lastY;
     
     // Update camera pan based on mouse delta
     float panSpeed = 0.003f;
-    m_cameraPanX += dx * panSpeed;
-    m_cameraPanY -= dy * panSpeed;  // Invert Y for natural movement
+    m_camera.setPan(m_camera.getPanX() + dx * panSpeed,
+                    m_camera.getPanY() - dy * panSpeed);  // Invert Y for natural movement
     
     m_lastX = x;
     m_lastY = y;
 }
 
 void OccViewer::zoom(float factor) {
-    m_cameraDistance *= (1.0f - factor * 0.1f);
+    beginInteraction();
+    
+    float distance = m_camera.getDistance() * (1.0f - factor * 0.1f);
     
     // Clamp zoom distance - allow much closer zoom
-    if (m_cameraDistance < 0.1f) m_cameraDistance = 0.1f;
-    if (m_cameraDistance > 20.0f) m_cameraDistance = 20.0f;
+    if (distance < 0.1f) distance = 0.1f;
+    if (distance > 20.0f) distance = 20.0f;
+    
+    m_camera.setDistance(distance);
+}
+
+void OccViewer::beginInteraction() {
+    if (m_quality != RenderQuality::Preview) {
+        m_quality = RenderQuality::Preview;
+        m_frameTimeAverage = 0.0f;
+        m_fastFrames = 0;
+    }
+    m_lastInteraction = std::chrono::steady_clock::now();
+}
+
+void OccViewer::endInteraction() {
+    // Switching back to Full changes the frame key, so the next render()
+    // refines the image. m_renderScale is kept for the next drag.
+    m_quality = RenderQuality::Full;
+}
+
+void OccViewer::updateInteraction(float deltaTime) {
+    if (m_quality != RenderQuality::Preview) {
+        return;
+    }
+    
+    std::chrono::duration<float> idle = std::chrono::steady_clock::now() - m_lastInteraction;
+    if (idle.count() >= kRefineDelaySeconds) {
+        endInteraction();
+        return;
+    }
+    
+    // With the render thread the UI keeps its frame rate; what matters is how
+    // long the thread takes per frame
+    if (m_renderThread.joinable()) {
+        deltaTime = std::max(deltaTime, m_renderFrameTime.load());
+    }
+    
+    // Smooth the frame time so a single slow frame doesn't make the resolution jump
+    if (m_frameTimeAverage == 0.0f) {
+        m_frameTimeAverage = deltaTime;
+    } else {
+        m_frameTimeAverage = m_frameTimeAverage * 0.8f + deltaTime * 0.2f;
+    }
+    
+    if (m_frameTimeAverage > kTargetFrameTime * 1.25f) {
+        // Over budget: fill cost scales with pixel count, i.e. the square of the scale
+        float scale = m_renderScale * std::sqrt(kTargetFrameTime / m_frameTimeAverage);
+        m_renderScale = std::floor(scale / kRenderScaleStep) * kRenderScaleStep;
+        m_frameTimeAverage = 0.0f;
+        m_fastFrames = 0;
+    } else if (m_frameTimeAverage < kTargetFrameTime * 1.05f) {
+        // Within budget (usually vsync-bound): creep back up one step at a time
+        if (++m_fastFrames >= kFramesBeforeScaleUp) {
+            m_renderScale += kRenderScaleStep;
+            m_fastFrames = 0;
+        }
+    } else {
+        m_fastFrames = 0;
+    }
+    
+    m_renderScale = std::min(1.0f, std::max(kMinRenderScale, m_renderScale));
+}
+
+void OccViewer::getTextureExtent(float& outU, float& outV) const {
+    const RenderTarget& target = m_targets[m_frontTarget];
+    if (target.width <= 0 || target.height <= 0 || target.contentWidth <= 0 || target.contentHeight <= 0) {
+        outU = 1.0f;
+        outV = 1.0f;
+        return;
+    }
+    outU = (float)target.contentWidth / (float)target.width;
+    outV = (float)target.contentHeight / (float)target.height;
 }
 
 void OccViewer::setHoveredPlane(const std::string& planeName) {
+    // Only recorded here; the highlight is composited by the UI so the cached
+    // frame stays valid while the mouse moves
     m_hoveredPlane = planeName;
 }
 
-std::string OccViewer::pickPlane(int mouseX, int mouseY, int viewportWidth, int viewportHeight) {
-    // Convert mouse coordinates to normalized device coordinates [-1, 1]
-    float ndcX = (2.0f * mouseX) / viewportWidth - 1.0f;
-    float ndcY = 1.0f - (2.0f * mouseY) / viewportHeight;  // Flip Y (screen Y is top-down)
-    
-    // Calculate aspect ratio and orthographic bounds
-    float aspect = (float)viewportWidth / viewportHeight;
-    float left, right, bottom, top;
-    if (aspect > 1.0f) {
-        left = -aspect; right = aspect;
-        bottom = -1.0f; top = 1.0f;
-    } else {
-        left = -1.0f; right = 1.0f;
-        bottom = -1.0f / aspect; top = 1.0f / aspect;
-    }
-    
-    // Convert NDC to clip space
-    float clipX = left + (ndcX + 1.0f) * 0.5f * (right - left);
-    float clipY = bottom + (ndcY + 1.0f) * 0.5f * (top - bottom);
-    
-    // Apply zoom to get view space position
-    float viewX = clipX * m_cameraDistance;
-    float viewY = clipY * m_cameraDistance;
-    
-    // In orthographic projection, ray origin is at the mouse position on the near plane
-    // and ray direction is constant (view direction)
-    // Start from far plane to ensure we're in front of all geometry
-    float rayOriginX = viewX;
-    float rayOriginY = viewY;
-    float rayOriginZ = 100.0f;
-    
-    // Ray direction in view space (straight down -Z)
-    float rayDirX = 0.0f;
-    float rayDirY = 0.0f;
-    float rayDirZ = -1.0f;
-    
-    // Helper functions for rotation
-    auto rotateZ = [](float& x, float& y, float angleDeg) {
-        float angleRad = -angleDeg * M_PI / 180.0f;  // Negative for inverse
-        float cosA = std::cos(angleRad);
-        float sinA = std::sin(angleRad);
-        float newX = x * cosA - y * sinA;
-        float newY = x * sinA + y * cosA;
-        x = newX;
-        y = newY;
-    };
+void OccViewer::setPreviewMesh(std::shared_ptr<const MeshBuffers> mesh) {
+    if (!mesh && !m_previewMesh) {
+        return;
+    }
+    m_previewMesh = std::move(mesh);
+    m_previewVersion++;
+}
+
+void OccViewer::addPartMesh(std::shared_ptr<const MeshBuffers> mesh) {
+    if (!mesh) {
+        return;
+    }
+    m_addedPartMeshes.push_back(std::move(mesh));
+    m_partsVersion++;
+}
+
+void OccViewer::addPartMeshes(const std::vector<std::shared_ptr<const MeshBuffers>>& meshes) {
+    for (const auto& mesh : meshes) {
+        addPartMesh(mesh);
+    }
+}
+
+void OccViewer::clearPartMeshes() {
+    if (!m_partMeshes && m_addedPartMeshes.empty()) {
+        return;
+    }
+    m_partMeshes.reset();
+    m_addedPartMeshes.clear();
+    m_partsVersion++;
+}
+
+void OccViewer::publishPartMeshes() {
+    if (m_addedPartMeshes.empty()) {
+        return;
+    }
+    // Published lists are never modified: a frame captured for the render
+    // thread may still be reading the current one
+    auto meshes = std::make_shared<PartMeshList>();
+    meshes->reserve((m_partMeshes ? m_partMeshes->size() : 0) + m_addedPartMeshes.size());
+    if (m_partMeshes) {
+        meshes->insert(meshes->end(), m_partMeshes->begin(), m_partMeshes->end());
+    }
+    meshes->insert(meshes->end(), std::make_move_iterator(m_addedPartMeshes.begin()),
+                   std::make_move_iterator(m_addedPartMeshes.end()));
+    m_addedPartMeshes.clear();
+    m_partMeshes = std::move(meshes);
+}
+
+bool OccViewer::FrameKey::operator==(const FrameKey& other) const {
+    return camera == other.camera &&
+           width == other.width &&
+           height == other.height &&
+           quality == other.quality &&
+           documentVersion == other.documentVersion &&
+           selectionHash == other.selectionHash &&
+           previewVersion == other.previewVersion &&
+           partsVersion == other.partsVersion;
+}
+
+OccViewer::FrameKey OccViewer::makeFrameKey() const {
+    FrameKey key;
+    key.camera = m_camera.getState();
+    key.quality = m_quality;
+    key.width = m_fboWidth;
+    key.height = m_fboHeight;
+    key.previewVersion = m_previewVersion;
+    key.partsVersion = m_partsVersion;
+    if (m_quality == RenderQuality::Preview) {
+        key.width = std::max(1, (int)(m_fboWidth * m_renderScale + 0.5f));
+        key.height = std::max(1, (int)(m_fboHeight * m_renderScale + 0.5f));
+    }
     
-    auto rotateY = [](float& x, float& z, float angleDeg) {
-        float angleRad = -angleDeg * M_PI / 180.0f;  // Negative for inverse
-        float cosA = std::cos(angleRad);
-        float sinA = std::sin(angleRad);
-        float newX = x * cosA + z * sinA;
-        float newZ = -x * sinA + z * cosA;
-        x = newX;
-        z = newZ;
-    };
+    if (m_document) {
+        key.documentVersion = m_document->getVersion();
+        
+        uint64_t selection = kHashSeed;
+        for (const auto& plane : m_document->getPlanes()) {
+            if (plane.selected) {
+                selection = hashString(plane.name, selection);
+            }
+            selection = hashCombine(selection, plane.visible ? 1 : 0);
+        }
+        key.selectionHash = selection;
+    }
     
-    auto rotateX = [](float& y, float& z, float angleDeg) {
-        float angleRad = -angleDeg * M_PI / 180.0f;  // Negative for inverse
-        float cosA = std::cos(angleRad);
-        float sinA = std::sin(angleRad);
-        float newY = y * cosA - z * sinA;
-        float newZ = y * sinA + z * cosA;
-        y = newY;
-        z = newZ;
-    };
+    return key;
+}
+
+bool OccViewer::getHoveredPlaneOutline(float outCorners[8]) const {
+    if (m_hoveredPlane.empty() || !m_document ||
+        !m_document->isPlaneVisible(m_hoveredPlane) ||
+        m_document->isPlaneSelected(m_hoveredPlane)) {
+        // Selection highlight is already part of the cached frame and wins over hover
+        return false;
+    }
     
-    // Apply inverse transformations in reverse order
-    // Rendering order: rotZ -> rotY -> rotX -> pan
-    // So inverse order: -pan -> -rotX -> -rotY -> -rotZ
+    const float s = 0.7f;  // Must match planeSize in render()
+    float corners[4][3];
+    if (m_hoveredPlane == "planexy") {
+        float c[4][3] = {{-s, -s, 0.0f}, {s, -s, 0.0f}, {s, s, 0.0f}, {-s, s, 0.0f}};
+        std::copy(&c[0][0], &c[0][0] + 12, &corners[0][0]);
+    } else if (m_hoveredPlane == "planexz") {
+        float c[4][3] = {{-s, 0.0f, -s}, {s, 0.0f, -s}, {s, 0.0f, s}, {-s, 0.0f, s}};
+        std::copy(&c[0][0], &c[0][0] + 12, &corners[0][0]);
+    } else if (m_hoveredPlane == "planeyz") {
+        float c[4][3] = {{0.0f, -s, -s}, {0.0f, s, -s}, {0.0f, s, s}, {0.0f, -s, s}};
+        std::copy(&c[0][0], &c[0][0] + 12, &corners[0][0]);
+    } else {
+        return false;
+    }
     
-    // Inverse pan (subtract pan offset)
-    rayOriginX -= m_cameraPanX;
-    rayOriginY -= m_cameraPanY;
+    if (m_fboWidth <= 0 || m_fboHeight <= 0) {
+        return false;
+    }
     
-    // Inverse rotation X
-    rotateX(rayOriginY, rayOriginZ, m_cameraRotX);
-    rotateX(rayDirY, rayDirZ, m_cameraRotX);
+    for (int i = 0; i < 4; i++) {
+        m_camera.projectPoint(corners[i][0], corners[i][1], corners[i][2],
+                              outCorners[i * 2], outCorners[i * 2 + 1]);
+    }
+    return true;
+}
+
+std::string OccViewer::pickPlane(int mouseX, int mouseY, int viewportWidth, int viewportHeight) {
+    BADCAD_TRACE_SCOPE_CAT("OccViewer::pickPlane", "render");
+    if (viewportWidth <= 0 || viewportHeight <= 0) {
+        return "";
+    }
     
-    // Inverse rotation Y
-    rotateY(rayOriginX, rayOriginZ, m_cameraRotY);
-    rotateY(rayDirX, rayDirZ, m_cameraRotY);
+    // The FBO image is stretched over the viewport, so normalized viewport
+    // coordinates map straight onto the camera used for rendering
+    float origin[3], direction[3];
+    m_camera.getRay((float)mouseX / viewportWidth, (float)mouseY / viewportHeight, origin, direction);
     
-    // Inverse rotation Z
-    rotateZ(rayOriginX, rayOriginY, m_cameraRotZ);
-    rotateZ(rayDirX, rayDirY, m_cameraRotZ);
+    float rayOriginX = origin[0];
+    float rayOriginY = origin[1];
+    float rayOriginZ = origin[2];
+    float rayDirX = direction[0];
+    float rayDirY = direction[1];
+    float rayDirZ = direction[2];
     
     // Now we have ray origin and direction in world space
     // Test intersection with each visible plane
@@ -2,7 +2,17 @@
 
 #define _USE_MATH_DEFINES
 #include <cmath>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
 #include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+#include "camera.h"
 #include <AIS_InteractiveContext.hxx>
 #include <V3d_View.hxx>
 #include <V3d_Viewer.hxx>
@@ -12,21 +22,63 @@
 #include <windows.h>
 #endif
 
+struct GLFWwindow;
+
 namespace badcad {
 
 class Document;
+class FrameProfiler;
+struct MeshBuffers;
 
 class OccViewer {
 public:
+    // Fast preview is used while the camera is being dragged: reduced
+    // resolution, coarse LOD and no edge overlays. Full quality at rest.
+    enum class RenderQuality {
+        Preview,
+        Full
+    };
+    
     OccViewer();
     ~OccViewer();
     
     bool init(void* windowHandle, int width, int height);
     void resize(int width, int height);
+    
+    // Move drawing onto a dedicated thread whose GL context shares objects
+    // with shareWith. Call from the main thread after init(). Without it (e.g.
+    // headless) render() draws synchronously on the caller's context.
+    bool startRenderThread(GLFWwindow* shareWith);
+    void stopRenderThread();
+    
+    // Redraws the FBO only if the camera, size or document changed since the
+    // last call; otherwise the previous texture is reused as-is. With the
+    // render thread running this only queues the frame and presents the most
+    // recently completed one, so it never waits for the GPU.
     void render();
     
+    // Force the next render() to redraw even if nothing observable changed
+    void invalidate() { m_frameValid = false; }
+    
     // Get OpenGL texture ID for ImGui
-    unsigned int getTextureId() const { return m_fboTexture; }
+    unsigned int getTextureId() const { return m_targets[m_frontTarget].texture; }
+    
+    // Portion of the texture that holds the last frame. Below 1.0 while a
+    // preview frame was rendered at reduced resolution.
+    void getTextureExtent(float& outU, float& outV) const;
+    
+    // Copy the last rendered frame to memory, top row first, 4 bytes per pixel.
+    // Used by the headless renderer to write thumbnails.
+    bool readPixels(std::vector<unsigned char>& outRgba, int& outWidth, int& outHeight) const;
+    
+    // Call once per UI frame. Feeds the dynamic resolution controller and
+    // refines to full quality once the camera has been idle long enough.
+    void updateInteraction(float deltaTime);
+    void endInteraction();
+    RenderQuality getRenderQuality() const { return m_quality; }
+    
+    // Redraws are recorded as the Viewport section, CPU and GPU
+    void setProfiler(FrameProfiler* profiler) { m_profiler = profiler; }
     
     // Document integration
     void setDocument(Document* doc);
@@ -50,39 +102,174 @@ public:
     std::string pickPlane(int mouseX, int mouseY, int viewportWidth, int viewportHeight);
     void setHoveredPlane(const std::string& planeName);
     
+    // Hover highlight is not baked into the FBO. Instead the UI draws it on top
+    // of the cached frame using these corners, in normalized viewport
+    // coordinates (0,0 = top-left, 1,1 = bottom-right). Returns false when
+    // there is nothing to highlight.
+    bool getHoveredPlaneOutline(float outCorners[8]) const;
+    
+    // Proxy mesh drawn over the scene while a feature value is dragged (see
+    // SweepPreview); nullptr removes it. The mesh must not change after it
+    // was passed in. Only the GPU buffers are updated, in place while the
+    // vertex and index counts stay the same.
+    void setPreviewMesh(std::shared_ptr<const MeshBuffers> mesh);
+    
+    // Meshes of imported parts, drawn in grey under the preview. Parts are
+    // added as an import finishes them, collected until the next render()
+    // and each is uploaded to the GPU once. The mesh must not change after it
+    // was passed in.
+    void addPartMesh(std::shared_ptr<const MeshBuffers> mesh);
+    void addPartMeshes(const std::vector<std::shared_ptr<const MeshBuffers>>& meshes);
+    void clearPartMeshes();
+    size_t getPartMeshCount() const {
+        return (m_partMeshes ? m_partMeshes->size() : 0) + m_addedPartMeshes.size();
+    }
+    
 private:
+    using PartMeshList = std::vector<std::shared_ptr<const MeshBuffers>>;
+    
+    // Everything that affects the contents of the FBO. Hover is deliberately
+    // excluded so moving the mouse over the viewport never forces a redraw.
+    struct FrameKey {
+        Camera::State camera;
+        int width = 0;
+        int height = 0;
+        RenderQuality quality = RenderQuality::Full;
+        uint64_t documentVersion = 0;
+        uint64_t selectionHash = 0;
+        uint64_t previewVersion = 0;
+        uint64_t partsVersion = 0;
+        
+        bool operator==(const FrameKey& other) const;
+        bool operator!=(const FrameKey& other) const { return !(*this == other); }
+    };
+    
+    // Color texture plus depth buffer. With the render thread running three
+    // rotate: the UI samples the front one, one may hold a finished frame
+    // waiting to be presented, and the thread draws into the third.
+    struct RenderTarget {
+        unsigned int fbo = 0;
+        unsigned int texture = 0;
+        unsigned int depth = 0;
+        int width = 0;            // Allocated size
+        int height = 0;
+        int contentWidth = 0;     // Region written by the last frame
+        int contentHeight = 0;
+    };
+    
+    // Everything drawFrame() needs, captured on the UI thread so drawing never
+    // reads the document or camera while they are being edited
+    struct FrameState {
+        FrameKey key;
+        Camera camera;
+        int targetWidth = 0;
+        int targetHeight = 0;
+        bool planeVisible[3] = {};
+        bool planeSelected[3] = {};
+        std::shared_ptr<const MeshBuffers> previewMesh;
+        std::shared_ptr<const PartMeshList> partMeshes;
+    };
+    
+    // Buffer objects of the preview mesh, in the context that draws frames
+    struct PreviewBuffers {
+        unsigned int vertexBuffer = 0;    // Positions, then normals at vertexCapacity
+        unsigned int indexBuffer = 0;
+        size_t vertexCapacity = 0;
+        size_t indexCapacity = 0;
+        size_t indexCount = 0;
+        uint64_t version = 0;             // previewVersion of the uploaded mesh
+    };
+    
+    // Static buffers of one part mesh. Holding the mesh keeps its address
+    // from being reused by another one while the buffers exist.
+    struct PartBuffers {
+        std::shared_ptr<const MeshBuffers> mesh;
+        unsigned int vertexBuffer = 0;    // Positions, then normals
+        unsigned int indexBuffer = 0;
+        uint64_t lastFrame = 0;           // m_partFrame when last drawn
+    };
+    
+    FrameKey makeFrameKey() const;
+    FrameState captureFrame(const FrameKey& key) const;
+    bool drawFrame(const FrameState& frame, RenderTarget& target);
+    void beginInteraction();
+    void drawPreviewMesh(const FrameState& frame);
+    void deletePreviewBuffers();
+    void publishPartMeshes();
+    void drawPartMeshes(const FrameState& frame);
+    void deletePartBuffers();
+    
+    void renderThreadMain();
+    void presentLatestFrame();
+
     void createDefaultPlanes();
     void updatePlaneVisibility();
-    void createFramebuffer(int width, int height);
-    void deleteFramebuffer();
+    void createFramebuffer(RenderTarget& target, int width, int height);
+    void deleteFramebuffer(RenderTarget& target);
     
     Handle(V3d_Viewer) m_viewer;
     Handle(V3d_View) m_view;
     Handle(AIS_InteractiveContext) m_context;
     
     Document* m_document = nullptr;
+    FrameProfiler* m_profiler = nullptr;
     
-    // OpenGL FBO for rendering
-    unsigned int m_fbo = 0;
-    unsigned int m_fboTexture = 0;
-    unsigned int m_fboDepth = 0;
+    // OpenGL FBOs for rendering. m_fboWidth/Height is the requested viewport
+    // size; targets are reallocated to match before they are drawn into.
+    static constexpr int kRenderTargetCount = 3;
+    RenderTarget m_targets[kRenderTargetCount];
+    int m_frontTarget = 0;            // Target the UI samples
     int m_fboWidth = 0;
     int m_fboHeight = 0;
     
-    // Camera state
-    float m_cameraDistance = 2.0f;
-    float m_cameraRotX = 30.0f;  // degrees
-    float m_cameraRotY = 0.0f;
-    float m_cameraRotZ = -45.0f;
-    float m_cameraPanX = 0.0f;
-    float m_cameraPanY = 0.0f;
+    // Camera state, shared by render() and pickPlane()
+    Camera m_camera;
     
     // Interaction state
     int m_lastX = 0;
     int m_lastY = 0;
     
+    // Dynamic resolution
+    RenderQuality m_quality = RenderQuality::Full;
+    float m_renderScale = 1.0f;       // Fraction of FBO size used for preview frames
+    float m_frameTimeAverage = 0.0f;  // Smoothed UI frame time while interacting
+    int m_fastFrames = 0;             // Consecutive frames within budget, before scaling up
+    std::chrono::steady_clock::time_point m_lastInteraction;
+    
     // Picking state
     std::string m_hoveredPlane;
+    
+    // Frame cache
+    FrameKey m_lastFrameKey;
+    bool m_frameValid = false;
+    
+    // Feature preview. m_previewBuffers is only touched by whichever thread draws.
+    std::shared_ptr<const MeshBuffers> m_previewMesh;
+    uint64_t m_previewVersion = 0;
+    PreviewBuffers m_previewBuffers;
+    
+    // Imported parts. Additions are published as a new list once per
+    // render(), since frames hold the old one; m_partBuffers and m_partFrame
+    // are only touched by whichever thread draws.
+    std::shared_ptr<const PartMeshList> m_partMeshes;
+    PartMeshList m_addedPartMeshes;
+    uint64_t m_partsVersion = 0;
+    std::unordered_map<const MeshBuffers*, PartBuffers> m_partBuffers;
+    uint64_t m_partFrame = 0;
+    
+    // Render thread. Fences are GLsync handles, kept opaque to avoid pulling GL
+    // headers in here. Everything below m_renderMutex is guarded by it.
+    GLFWwindow* m_renderWindow = nullptr;  // Hidden window owning the shared context
+    std::thread m_renderThread;
+    std::atomic<float> m_renderFrameTime{0.0f};  // GPU-complete time of the last threaded frame
+    std::mutex m_renderMutex;
+    std::condition_variable m_renderCondition;
+    bool m_stopRendering = false;
+    bool m_hasPendingFrame = false;
+    FrameState m_pendingFrame;
+    int m_readyTarget = -1;           // Finished but not presented yet
+    void* m_readyFence = nullptr;     // Signalled when m_readyTarget is complete
+    void* m_releaseFence[kRenderTargetCount] = {};  // Signalled when the UI stopped sampling a target
 };
 
 } // namespace badcad
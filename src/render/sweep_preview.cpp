@@ -0,0 +1,236 @@
+#include "sweep_preview.h"
+#include "../utils/trace.h"
+#include <array>
+#include <cmath>
+#include <map>
+#include <unordered_set>
+
+namespace badcad {
+
+namespace {
+
+struct Vec3 {
+    float x, y, z;
+};
+
+Vec3 load(const float* p) { return {p[0], p[1], p[2]}; }
+Vec3 operator+(const Vec3& a, const Vec3& b) { return {a.x + b.x, a.y + b.y, a.z + b.z}; }
+Vec3 operator-(const Vec3& a, const Vec3& b) { return {a.x - b.x, a.y - b.y, a.z - b.z}; }
+Vec3 operator*(const Vec3& a, float s) { return {a.x * s, a.y * s, a.z * s}; }
+float dot(const Vec3& a, const Vec3& b) { return a.x * b.x + a.y * b.y + a.z * b.z; }
+Vec3 cross(const Vec3& a, const Vec3& b) {
+    return {a.y * b.z - a.z * b.y, a.z * b.x - a.x * b.z, a.x * b.y - a.y * b.x};
+}
+Vec3 normalized(const Vec3& v) {
+    float length = std::sqrt(dot(v, v));
+    return length > 0.0f ? v * (1.0f / length) : v;
+}
+
+// Rodrigues' rotation about a unit axis through the origin
+struct Rotation {
+    Vec3 axis;
+    float cosAngle;
+    float sinAngle;
+
+    Rotation(const Vec3& unitAxis, float angle)
+        : axis(unitAxis), cosAngle(std::cos(angle)), sinAngle(std::sin(angle)) {}
+
+    Vec3 apply(const Vec3& v) const {
+        return v * cosAngle + cross(axis, v) * sinAngle + axis * (dot(axis, v) * (1.0f - cosAngle));
+    }
+};
+
+void storeVertex(MeshBuffers& out, size_t vertex, const Vec3& position, const Vec3& normal) {
+    float* p = &out.positions[3 * vertex];
+    float* n = &out.normals[3 * vertex];
+    p[0] = position.x; p[1] = position.y; p[2] = position.z;
+    n[0] = normal.x;   n[1] = normal.y;   n[2] = normal.z;
+}
+
+// Writes one triangle at *cursor, flipping the winding if asked
+void storeTriangle(uint32_t*& cursor, uint32_t a, uint32_t b, uint32_t c, bool flip) {
+    cursor[0] = a;
+    cursor[1] = flip ? c : b;
+    cursor[2] = flip ? b : c;
+    cursor += 3;
+}
+
+// Copies the profile triangles as a cap, facing along or against the normal
+void storeCap(const std::vector<uint32_t>& capIndices, uint32_t firstVertex, bool facesNormal,
+              uint32_t*& cursor) {
+    for (size_t i = 0; i < capIndices.size(); i += 3) {
+        storeTriangle(cursor, firstVertex + capIndices[i], firstVertex + capIndices[i + 1],
+                      firstVertex + capIndices[i + 2], !facesNormal);
+    }
+}
+
+} // namespace
+
+void SweepPreview::setProfile(const MeshBuffers& profileMesh, const float planeNormal[3]) {
+    BADCAD_TRACE_SCOPE_CAT("SweepPreview::setProfile", "mesh");
+    m_positions.clear();
+    m_capIndices.clear();
+    m_outline.clear();
+    Vec3 normal = normalized(load(planeNormal));
+    m_normal[0] = normal.x;
+    m_normal[1] = normal.y;
+    m_normal[2] = normal.z;
+
+    // Faces are tessellated separately, so shared boundary vertices are
+    // duplicated; welding them makes edges between regions interior
+    std::map<std::array<float, 3>, uint32_t> welded;
+    std::vector<uint32_t> remap(profileMesh.getVertexCount());
+    for (size_t i = 0; i < remap.size(); i++) {
+        const float* p = &profileMesh.positions[3 * i];
+        auto inserted = welded.emplace(std::array<float, 3>{p[0], p[1], p[2]}, (uint32_t)welded.size());
+        if (inserted.second) {
+            m_positions.insert(m_positions.end(), p, p + 3);
+        }
+        remap[i] = inserted.first->second;
+    }
+
+    // Triangles counter-clockwise around the plane normal, whichever way the
+    // face they came from was oriented
+    std::unordered_set<uint64_t> directedEdges;
+    for (size_t i = 0; i + 2 < profileMesh.indices.size(); i += 3) {
+        uint32_t a = remap[profileMesh.indices[i]];
+        uint32_t b = remap[profileMesh.indices[i + 1]];
+        uint32_t c = remap[profileMesh.indices[i + 2]];
+        if (a == b || b == c || c == a) {
+            continue;
+        }
+        Vec3 pa = load(&m_positions[3 * a]);
+        Vec3 pb = load(&m_positions[3 * b]);
+        Vec3 pc = load(&m_positions[3 * c]);
+        if (dot(cross(pb - pa, pc - pa), normal) < 0.0f) {
+            std::swap(b, c);
+        }
+        m_capIndices.insert(m_capIndices.end(), {a, b, c});
+        directedEdges.insert((uint64_t)a << 32 | b);
+        directedEdges.insert((uint64_t)b << 32 | c);
+        directedEdges.insert((uint64_t)c << 32 | a);
+    }
+
+    // An edge without its reverse borders only one triangle: it is outline
+    for (uint64_t edge : directedEdges) {
+        uint32_t a = (uint32_t)(edge >> 32);
+        uint32_t b = (uint32_t)edge;
+        if (!directedEdges.count((uint64_t)b << 32 | a)) {
+            m_outline.push_back(a);
+            m_outline.push_back(b);
+        }
+    }
+}
+
+void SweepPreview::buildExtrude(float distance, MeshBuffers& out) const {
+    BADCAD_TRACE_SCOPE_CAT("SweepPreview::buildExtrude", "mesh");
+    const Vec3 normal = load(m_normal);
+    const Vec3 offset = normal * distance;
+    const bool backwards = distance < 0.0f;
+    const uint32_t profileCount = (uint32_t)(m_positions.size() / 3);
+    const size_t edgeCount = m_outline.size() / 2;
+
+    // Sized up front, so filling never reallocates
+    const size_t vertexCount = 2 * profileCount + 4 * edgeCount;
+    out.positions.resize(3 * vertexCount);
+    out.normals.resize(3 * vertexCount);
+    out.indices.resize(2 * m_capIndices.size() + 6 * edgeCount);
+
+    // Bottom cap on the sketch plane, top cap offset, both facing outwards
+    const Vec3 topNormal = backwards ? normal * -1.0f : normal;
+    for (uint32_t i = 0; i < profileCount; i++) {
+        Vec3 p = load(&m_positions[3 * i]);
+        storeVertex(out, i, p, topNormal * -1.0f);
+        storeVertex(out, profileCount + i, p + offset, topNormal);
+    }
+    uint32_t* cursor = out.indices.data();
+    storeCap(m_capIndices, 0, backwards, cursor);
+    storeCap(m_capIndices, profileCount, !backwards, cursor);
+
+    // One flat quad per outline edge; the region is on the edge's left, so
+    // edge x normal points away from it
+    uint32_t vertex = 2 * profileCount;
+    for (size_t e = 0; e < edgeCount; e++) {
+        Vec3 a = load(&m_positions[3 * m_outline[2 * e]]);
+        Vec3 b = load(&m_positions[3 * m_outline[2 * e + 1]]);
+        Vec3 side = normalized(cross(b - a, normal));
+        storeVertex(out, vertex, a, side);
+        storeVertex(out, vertex + 1, b, side);
+        storeVertex(out, vertex + 2, b + offset, side);
+        storeVertex(out, vertex + 3, a + offset, side);
+        storeTriangle(cursor, vertex, vertex + 1, vertex + 2, backwards);
+        storeTriangle(cursor, vertex, vertex + 2, vertex + 3, backwards);
+        vertex += 4;
+    }
+}
+
+void SweepPreview::buildRevolve(const float axisOrigin[3], const float axisDirection[3], float angle,
+                                MeshBuffers& out) const {
+    BADCAD_TRACE_SCOPE_CAT("SweepPreview::buildRevolve", "mesh");
+    const Vec3 normal = load(m_normal);
+    const Vec3 origin = load(axisOrigin);
+    const Vec3 axis = normalized(load(axisDirection));
+    const uint32_t profileCount = (uint32_t)(m_positions.size() / 3);
+    const size_t edgeCount = m_outline.size() / 2;
+    const uint32_t ringSize = kRevolvePreviewSteps + 1;
+
+    const size_t vertexCount = 2 * profileCount + 2 * edgeCount * ringSize;
+    out.positions.resize(3 * vertexCount);
+    out.normals.resize(3 * vertexCount);
+    out.indices.resize(2 * m_capIndices.size() + 6 * edgeCount * kRevolvePreviewSteps);
+    if (profileCount == 0) {
+        return;
+    }
+
+    // Whether the profile sweeps towards its normal, judged at its centroid
+    Vec3 centroid = {0.0f, 0.0f, 0.0f};
+    for (uint32_t i = 0; i < profileCount; i++) {
+        centroid = centroid + load(&m_positions[3 * i]);
+    }
+    centroid = centroid * (1.0f / profileCount);
+    const bool backwards = dot(cross(axis, centroid - origin), normal) * angle < 0.0f;
+    const Vec3 leading = backwards ? normal * -1.0f : normal;
+
+    std::vector<Rotation> rings;
+    rings.reserve(ringSize);
+    for (uint32_t k = 0; k < ringSize; k++) {
+        rings.emplace_back(axis, angle * k / kRevolvePreviewSteps);
+    }
+    const Rotation& last = rings.back();
+
+    // Start cap stays on the sketch plane, end cap is the rotated profile.
+    // Both are kept for a full turn too, so the counts never change.
+    for (uint32_t i = 0; i < profileCount; i++) {
+        Vec3 p = load(&m_positions[3 * i]) - origin;
+        storeVertex(out, i, p + origin, leading * -1.0f);
+        storeVertex(out, profileCount + i, last.apply(p) + origin, last.apply(leading));
+    }
+    uint32_t* cursor = out.indices.data();
+    storeCap(m_capIndices, 0, backwards, cursor);
+    storeCap(m_capIndices, profileCount, !backwards, cursor);
+
+    // Each outline edge sweeps a strip with normals rotated along with it
+    uint32_t vertex = 2 * profileCount;
+    for (size_t e = 0; e < edgeCount; e++) {
+        Vec3 a = load(&m_positions[3 * m_outline[2 * e]]) - origin;
+        Vec3 b = load(&m_positions[3 * m_outline[2 * e + 1]]) - origin;
+        Vec3 side = normalized(cross(b - a, normal));
+        for (uint32_t k = 0; k < ringSize; k++) {
+            const Rotation& rotation = rings[k];
+            Vec3 rotatedSide = rotation.apply(side);
+            storeVertex(out, vertex + 2 * k, rotation.apply(a) + origin, rotatedSide);
+            storeVertex(out, vertex + 2 * k + 1, rotation.apply(b) + origin, rotatedSide);
+            if (k + 1 < ringSize) {
+                uint32_t a0 = vertex + 2 * k;
+                uint32_t b0 = a0 + 1;
+                uint32_t a1 = a0 + 2;
+                uint32_t b1 = a0 + 3;
+                storeTriangle(cursor, a0, b0, b1, backwards);
+                storeTriangle(cursor, a0, b1, a1, backwards);
+            }
+        }
+        vertex += 2 * ringSize;
+    }
+}
+
+} // namespace badcad
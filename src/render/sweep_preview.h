@@ -0,0 +1,43 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include "tessellator.h"
+
+namespace badcad {
+
+// Steps a preview revolve is split into, whatever the angle, so dragging the
+// angle never changes the vertex count
+constexpr int kRevolvePreviewSteps = 48;
+
+// Proxy mesh for dragging an extrude depth or revolve angle.
+//
+// The profile is tessellated once; every drag step only copies its triangles
+// as caps and sweeps its outline, which is plain arithmetic on a few thousand
+// floats instead of an OCC solid build. Vertex and index counts depend only
+// on the profile, so the viewer overwrites its GPU buffers in place while
+// the value changes. The real BRep is built once, on commit.
+class SweepPreview {
+public:
+    // profileMesh is the tessellated sketch profile, planar with normals
+    // along planeNormal. Coincident vertices are welded to find the outline.
+    void setProfile(const MeshBuffers& profileMesh, const float planeNormal[3]);
+    bool hasProfile() const { return !m_capIndices.empty(); }
+
+    // Prism along the plane normal; negative distances extrude backwards
+    void buildExtrude(float distance, MeshBuffers& out) const;
+
+    // Rotation by angle radians about the axis (right-hand rule), capped at
+    // both ends
+    void buildRevolve(const float axisOrigin[3], const float axisDirection[3], float angle,
+                      MeshBuffers& out) const;
+
+private:
+    std::vector<float> m_positions;         // Welded profile vertices
+    std::vector<uint32_t> m_capIndices;     // Counter-clockwise around m_normal
+    std::vector<uint32_t> m_outline;        // Boundary edges as index pairs, region on the left
+    float m_normal[3] = {0.0f, 0.0f, 1.0f};
+};
+
+} // namespace badcad
@@ -0,0 +1,434 @@
+#include "tessellation_cache.h"
+#include "../utils/cache_dir.h"
+#include "../utils/hash.h"
+#include "../utils/log.h"
+#include "../utils/trace.h"
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <sstream>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+#include <BinTools.hxx>
+#include <Bnd_Box.hxx>
+#include <BRepBndLib.hxx>
+#include <Precision.hxx>
+#include <Standard_Failure.hxx>
+#include <TopoDS_Face.hxx>
+
+#include <stb/stb_image.h>
+
+// stb_image_write is implemented here rather than next to its PNG use in
+// core/headless_app.cpp: stbi_zlib_compress is only declared along with
+// the implementation
+#define STB_IMAGE_WRITE_IMPLEMENTATION
+#include <stb/stb_image_write.h>
+
+namespace badcad {
+
+namespace {
+
+constexpr char kMagic[4] = {'B', 'M', 'S', 'H'};
+constexpr uint32_t kFormatVersion = 1;
+// Far beyond any one face's meshes; larger entries are neither written nor read
+constexpr uint32_t kMaxPayloadSize = 256u << 20;
+
+struct MeshFileHeader {
+    char magic[4];
+    uint32_t formatVersion;
+    uint64_t key;
+    uint32_t payloadSize;       // Inflated
+    uint32_t compressedSize;
+};
+
+// Per LOD, followed by quantized positions, normals and indices
+struct LevelHeader {
+    float boundsMin[3];
+    float boundsMax[3];
+    uint32_t vertexCount;
+    uint32_t indexCount;
+};
+
+// Three quantized coordinates and an octahedral normal
+constexpr size_t kEncodedVertexSize = 3 * sizeof(uint16_t) + 2 * sizeof(int16_t);
+
+template <typename T>
+void append(std::vector<unsigned char>& out, const T& value) {
+    static_assert(std::is_trivially_copyable_v<T>, "raw write");
+    const unsigned char* bytes = reinterpret_cast<const unsigned char*>(&value);
+    out.insert(out.end(), bytes, bytes + sizeof(T));
+}
+
+class Reader {
+public:
+    Reader(const std::vector<unsigned char>& bytes) : m_data(bytes.data()), m_remaining(bytes.size()) {}
+
+    template <typename T>
+    bool read(T& value) {
+        static_assert(std::is_trivially_copyable_v<T>, "raw read");
+        if (sizeof(T) > m_remaining) {
+            return false;
+        }
+        std::memcpy(&value, m_data, sizeof(T));
+        m_data += sizeof(T);
+        m_remaining -= sizeof(T);
+        return true;
+    }
+
+    size_t remaining() const { return m_remaining; }
+
+private:
+    const unsigned char* m_data;
+    size_t m_remaining;
+};
+
+float signNotZero(float value) {
+    return value < 0.0f ? -1.0f : 1.0f;
+}
+
+// Octahedral normal encoding: unit vector -> two snorm16
+void encodeNormal(const float* normal, int16_t* out) {
+    float sum = std::fabs(normal[0]) + std::fabs(normal[1]) + std::fabs(normal[2]);
+    float u = sum > 0.0f ? normal[0] / sum : 0.0f;
+    float v = sum > 0.0f ? normal[1] / sum : 0.0f;
+    if (normal[2] < 0.0f) {
+        float foldedU = (1.0f - std::fabs(v)) * signNotZero(u);
+        float foldedV = (1.0f - std::fabs(u)) * signNotZero(v);
+        u = foldedU;
+        v = foldedV;
+    }
+    out[0] = (int16_t)std::lround(std::clamp(u, -1.0f, 1.0f) * 32767.0f);
+    out[1] = (int16_t)std::lround(std::clamp(v, -1.0f, 1.0f) * 32767.0f);
+}
+
+void decodeNormal(const int16_t* encoded, float* out) {
+    float u = encoded[0] / 32767.0f;
+    float v = encoded[1] / 32767.0f;
+    float z = 1.0f - std::fabs(u) - std::fabs(v);
+    if (z < 0.0f) {
+        float unfoldedU = (1.0f - std::fabs(v)) * signNotZero(u);
+        float unfoldedV = (1.0f - std::fabs(u)) * signNotZero(v);
+        u = unfoldedU;
+        v = unfoldedV;
+    }
+    float length = std::sqrt(u * u + v * v + z * z);
+    out[0] = u / length;
+    out[1] = v / length;
+    out[2] = z / length;
+}
+
+void encodeLevel(const MeshBuffers& mesh, std::vector<unsigned char>& out) {
+    LevelHeader header = {};
+    header.vertexCount = (uint32_t)mesh.getVertexCount();
+    header.indexCount = (uint32_t)mesh.indices.size();
+    for (int axis = 0; axis < 3; axis++) {
+        header.boundsMin[axis] = header.vertexCount ? mesh.positions[axis] : 0.0f;
+        header.boundsMax[axis] = header.boundsMin[axis];
+    }
+    for (size_t i = 0; i < mesh.positions.size(); i++) {
+        header.boundsMin[i % 3] = std::min(header.boundsMin[i % 3], mesh.positions[i]);
+        header.boundsMax[i % 3] = std::max(header.boundsMax[i % 3], mesh.positions[i]);
+    }
+    append(out, header);
+
+    for (size_t i = 0; i < mesh.positions.size(); i++) {
+        float extent = header.boundsMax[i % 3] - header.boundsMin[i % 3];
+        float t = extent > 0.0f ? (mesh.positions[i] - header.boundsMin[i % 3]) / extent : 0.0f;
+        append(out, (uint16_t)std::lround(t * 65535.0f));
+    }
+    for (size_t i = 0; i < header.vertexCount; i++) {
+        int16_t encoded[2];
+        encodeNormal(&mesh.normals[3 * i], encoded);
+        append(out, encoded);
+    }
+    // 16-bit indices whenever they fit, which is nearly every face
+    bool wideIndices = header.vertexCount > 0xFFFF;
+    for (uint32_t index : mesh.indices) {
+        if (wideIndices) {
+            append(out, index);
+        } else {
+            append(out, (uint16_t)index);
+        }
+    }
+}
+
+bool decodeLevel(Reader& reader, const Bnd_Box& faceBounds, MeshBuffers& out) {
+    LevelHeader header;
+    if (!reader.read(header)) {
+        return false;
+    }
+    if (header.vertexCount > 0) {
+        // The mesh must lie on the face; a mismatch means a stale or colliding entry
+        if (faceBounds.IsVoid()) {
+            return false;
+        }
+        double xMin, yMin, zMin, xMax, yMax, zMax;
+        faceBounds.Get(xMin, yMin, zMin, xMax, yMax, zMax);
+        if (header.boundsMin[0] < xMin || header.boundsMin[1] < yMin || header.boundsMin[2] < zMin ||
+            header.boundsMax[0] > xMax || header.boundsMax[1] > yMax || header.boundsMax[2] > zMax) {
+            return false;
+        }
+    }
+
+    // Counts from the file must fit in what is left of it before anything is allocated
+    bool wideIndices = header.vertexCount > 0xFFFF;
+    size_t indexSize = wideIndices ? sizeof(uint32_t) : sizeof(uint16_t);
+    if (header.vertexCount > reader.remaining() / kEncodedVertexSize ||
+        header.indexCount > (reader.remaining() - header.vertexCount * kEncodedVertexSize) / indexSize) {
+        return false;
+    }
+
+    out.positions.resize(3 * (size_t)header.vertexCount);
+    for (size_t i = 0; i < out.positions.size(); i++) {
+        uint16_t quantized;
+        if (!reader.read(quantized)) {
+            return false;
+        }
+        float extent = header.boundsMax[i % 3] - header.boundsMin[i % 3];
+        out.positions[i] = header.boundsMin[i % 3] + extent * (quantized / 65535.0f);
+    }
+    out.normals.resize(3 * (size_t)header.vertexCount);
+    for (size_t i = 0; i < header.vertexCount; i++) {
+        int16_t encoded[2];
+        if (!reader.read(encoded)) {
+            return false;
+        }
+        decodeNormal(encoded, &out.normals[3 * i]);
+    }
+    out.indices.resize(header.indexCount);
+    for (uint32_t& index : out.indices) {
+        if (wideIndices) {
+            if (!reader.read(index)) {
+                return false;
+            }
+        } else {
+            uint16_t narrow;
+            if (!reader.read(narrow)) {
+                return false;
+            }
+            index = narrow;
+        }
+        if (index >= header.vertexCount) {
+            return false;
+        }
+    }
+    return true;
+}
+
+// Entry key: the face plus every LOD's deflection, so changing a level invalidates it
+uint64_t makeKey(uint64_t faceHash) {
+    uint64_t key = hashCombine(faceHash, kFormatVersion);
+    for (size_t level = 0; level < kMeshLodCount; level++) {
+        MeshParams params = Tessellator::getMeshParams(static_cast<MeshLod>(level));
+        key = hashCombine(key, hashBytes(&params.linearDeflection, sizeof(double)));
+        key = hashCombine(key, hashBytes(&params.angularDeflection, sizeof(double)));
+    }
+    return key;
+}
+
+} // namespace
+
+TessellationCache& TessellationCache::instance() {
+    static TessellationCache cache;
+    return cache;
+}
+
+uint64_t TessellationCache::hashFace(const TopoDS_Face& face) {
+    try {
+        // Geometry and topology only; any triangulation on the face is left out
+        std::ostringstream stream(std::ios::binary);
+        BinTools::Write(face, stream, Standard_False, Standard_False, BinTools_FormatVersion_CURRENT);
+        return hashString(stream.str());
+    } catch (Standard_Failure const& e) {
+        BADCAD_LOG_DEBUG("Cannot hash face for mesh cache: ", e.GetMessageString());
+        return 0;
+    }
+}
+
+std::filesystem::path TessellationCache::entryPath(uint64_t faceHash) const {
+    char name[32];
+    std::snprintf(name, sizeof(name), "%016llx.mesh", (unsigned long long)makeKey(faceHash));
+    return m_directory / name;
+}
+
+bool TessellationCache::load(const TopoDS_Face& face, uint64_t faceHash, FaceMeshes& outMeshes) {
+    if (faceHash == 0) {
+        return false;
+    }
+    std::filesystem::path path;
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        scanLocked();
+        if (m_directory.empty()) {
+            return false;
+        }
+        path = entryPath(faceHash);
+    }
+
+    std::ifstream file(path, std::ios::binary | std::ios::ate);
+    if (!file.is_open()) {
+        return false;
+    }
+    std::streamoff fileSize = file.tellg();
+    file.seekg(0);
+    MeshFileHeader header;
+    if (fileSize < (std::streamoff)sizeof(header) ||
+        !file.read(reinterpret_cast<char*>(&header), sizeof(header)) ||
+        std::memcmp(header.magic, kMagic, sizeof(kMagic)) != 0 || header.formatVersion != kFormatVersion ||
+        header.key != makeKey(faceHash)) {
+        return false;
+    }
+    // store() writes the header and the compressed payload, nothing else
+    if (header.compressedSize != (uint64_t)(fileSize - (std::streamoff)sizeof(header)) ||
+        header.payloadSize > kMaxPayloadSize) {
+        BADCAD_LOG_DEBUG("Rejected cached mesh ", path.filename().string());
+        return false;
+    }
+    std::vector<unsigned char> compressed(header.compressedSize);
+    if (!file.read(reinterpret_cast<char*>(compressed.data()), compressed.size())) {
+        return false;
+    }
+    file.close();
+
+    std::vector<unsigned char> payload(header.payloadSize);
+    int inflated = stbi_zlib_decode_buffer(reinterpret_cast<char*>(payload.data()), (int)payload.size(),
+                                           reinterpret_cast<const char*>(compressed.data()), (int)compressed.size());
+    if (inflated != (int)header.payloadSize) {
+        return false;
+    }
+
+    Bnd_Box faceBounds;
+    try {
+        BRepBndLib::Add(face, faceBounds, Standard_False);
+    } catch (Standard_Failure const&) {
+        return false;
+    }
+    // Room for the coarsest deflection and for quantization
+    faceBounds.Enlarge(Tessellator::getMeshParams(MeshLod::Low).linearDeflection + Precision::Confusion());
+
+    Reader reader(payload);
+    for (MeshBuffers& mesh : outMeshes) {
+        if (!decodeLevel(reader, faceBounds, mesh)) {
+            BADCAD_LOG_DEBUG("Rejected cached mesh ", path.filename().string());
+            return false;
+        }
+    }
+
+    touchCacheEntry(path);
+    return true;
+}
+
+void TessellationCache::store(uint64_t faceHash, const FaceMeshes& meshes) {
+    if (faceHash == 0) {
+        return;
+    }
+    std::filesystem::path path;
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        scanLocked();
+        if (m_directory.empty()) {
+            return;
+        }
+        path = entryPath(faceHash);
+    }
+
+    BADCAD_TRACE_SCOPE_CAT("TessellationCache store", "io");
+    std::vector<unsigned char> payload;
+    for (const MeshBuffers& mesh : meshes) {
+        encodeLevel(mesh, payload);
+    }
+    if (payload.size() > kMaxPayloadSize) {
+        return;
+    }
+    int compressedSize = 0;
+    unsigned char* compressed = stbi_zlib_compress(payload.data(), (int)payload.size(), &compressedSize, 6);
+    if (!compressed) {
+        return;
+    }
+
+    MeshFileHeader header;
+    std::memcpy(header.magic, kMagic, sizeof(kMagic));
+    header.formatVersion = kFormatVersion;
+    header.key = makeKey(faceHash);
+    header.payloadSize = (uint32_t)payload.size();
+    header.compressedSize = (uint32_t)compressedSize;
+
+    // Write then rename, so a concurrent reader never sees a partial file.
+    // The temp name is unique per thread since faces can be stored in parallel.
+    std::filesystem::path tempPath = path;
+    tempPath += "." + std::to_string(std::hash<std::thread::id>()(std::this_thread::get_id())) + ".tmp";
+    bool written = false;
+    {
+        std::ofstream out(tempPath, std::ios::binary);
+        if (out.is_open()) {
+            out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+            out.write(reinterpret_cast<const char*>(compressed), compressedSize);
+            written = (bool)out;
+        }
+    }
+    std::free(compressed);
+
+    std::error_code ec;
+    if (!written) {
+        std::filesystem::remove(tempPath, ec);
+        return;
+    }
+    // A face stored again (the old file failed to load, or another
+    // tessellator meshed it too) replaces its file
+    uintmax_t replacedBytes = std::filesystem::file_size(path, ec);
+    if (ec) {
+        replacedBytes = 0;
+    }
+    std::filesystem::rename(tempPath, path, ec);
+    if (ec) {
+        std::filesystem::remove(tempPath, ec);
+        return;
+    }
+
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_sizeBytes -= std::min<uint64_t>(m_sizeBytes, replacedBytes);
+    m_sizeBytes += sizeof(header) + compressedSize;
+    if (m_sizeBytes > m_sizeLimit) {
+        evictLocked();
+    }
+}
+
+void TessellationCache::setSizeLimit(uint64_t bytes) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_sizeLimit = bytes;
+    scanLocked();
+    if (m_sizeBytes > m_sizeLimit) {
+        evictLocked();
+    }
+}
+
+uint64_t TessellationCache::getSizeBytes() {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    scanLocked();
+    return m_sizeBytes;
+}
+
+void TessellationCache::scanLocked() {
+    if (m_scanned) {
+        return;
+    }
+    m_scanned = true;
+    m_directory = getCacheDirectory("meshes");
+    if (m_directory.empty()) {
+        return;
+    }
+    m_sizeBytes = getCacheDirectorySize(m_directory, ".mesh");
+}
+
+void TessellationCache::evictLocked() {
+    BADCAD_TRACE_SCOPE_CAT("TessellationCache evict", "io");
+    // Trim to 90% so the next few stores do not evict again
+    m_sizeBytes = trimCacheDirectory(m_directory, ".mesh", m_sizeLimit / 10 * 9);
+}
+
+} // namespace badcad
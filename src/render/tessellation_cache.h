@@ -0,0 +1,56 @@
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <filesystem>
+#include <mutex>
+#include "tessellator.h"
+
+class TopoDS_Face;
+
+namespace badcad {
+
+// Default cap for the meshes cache directory
+constexpr uint64_t kTessellationCacheLimit = 512ull * 1024 * 1024;
+
+// Content-addressed face meshes on disk, under getCacheDirectory("meshes").
+//
+// Entries are keyed by a hash of the face's binary BRep (surface, edges,
+// location, orientation) and the deflection of every LOD, so an unchanged
+// part reopens without running BRepMesh. Positions are quantized to 16 bits
+// within each mesh's bounding box, normals octahedral-encoded to 2x16 bits,
+// and the whole entry is zlib-compressed. A loaded mesh must lie inside the
+// face's own bounding box or it is rejected and re-meshed.
+//
+// Reads refresh the file time, and writes evict the least recently used
+// entries once the directory grows past the size limit. Thread-safe.
+class TessellationCache {
+public:
+    using FaceMeshes = std::array<MeshBuffers, kMeshLodCount>;
+
+    static TessellationCache& instance();
+
+    // 0 if the face could not be serialized; such faces are not cached
+    static uint64_t hashFace(const TopoDS_Face& face);
+
+    bool load(const TopoDS_Face& face, uint64_t faceHash, FaceMeshes& outMeshes);
+    void store(uint64_t faceHash, const FaceMeshes& meshes);
+
+    void setSizeLimit(uint64_t bytes);
+    uint64_t getSizeBytes();
+
+private:
+    TessellationCache() = default;
+
+    std::filesystem::path entryPath(uint64_t faceHash) const;
+    void scanLocked();
+    void evictLocked();
+
+    std::mutex m_mutex;
+    std::filesystem::path m_directory;
+    bool m_scanned = false;
+    uint64_t m_sizeBytes = 0;
+    uint64_t m_sizeLimit = kTessellationCacheLimit;
+};
+
+} // namespace badcad
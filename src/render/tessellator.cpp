@@ -0,0 +1,358 @@
+#include "tessellator.h"
+#include "tessellation_cache.h"
+#include "../geometry/topology_index.h"
+#include "../utils/log.h"
+#include "../utils/task_scheduler.h"
+#include "../utils/trace.h"
+#include <utility>
+
+#include <BRep_Builder.hxx>
+#include <BRep_Tool.hxx>
+#include <BRepBuilderAPI_Copy.hxx>
+#include <BRepLib_ToolTriangulatedShape.hxx>
+#include <BRepMesh_IncrementalMesh.hxx>
+#include <IMeshTools_Parameters.hxx>
+#include <Message_ProgressIndicator.hxx>
+#include <Poly_Triangulation.hxx>
+#include <Standard_Failure.hxx>
+#include <TopExp.hxx>
+#include <TopoDS.hxx>
+#include <TopoDS_Compound.hxx>
+#include <TopoDS_Iterator.hxx>
+#include <TopTools_IndexedMapOfShape.hxx>
+
+namespace badcad {
+
+namespace {
+
+// Lets BRepMesh stop early when the caller cancels
+class CancelIndicator : public Message_ProgressIndicator {
+public:
+    explicit CancelIndicator(const std::atomic<bool>* cancelled) : m_cancelled(cancelled) {}
+
+    Standard_Boolean UserBreak() override { return m_cancelled && m_cancelled->load(); }
+    void Show(const Message_ProgressScope&, const Standard_Boolean) override {}
+
+private:
+    const std::atomic<bool>* m_cancelled;
+};
+
+bool isCancelled(const std::atomic<bool>* cancelled) {
+    return cancelled && cancelled->load();
+}
+
+// Appends the face's triangulation, in world space, with outward normals
+void extractFace(const TopoDS_Face& face, MeshBuffers& out) {
+    TopLoc_Location location;
+    Handle(Poly_Triangulation) triangulation = BRep_Tool::Triangulation(face, location);
+    if (triangulation.IsNull()) {
+        // Degenerate faces have no triangles
+        return;
+    }
+    if (!triangulation->HasNormals()) {
+        BRepLib_ToolTriangulatedShape::ComputeNormals(face, triangulation);
+    }
+
+    const bool transformed = !location.IsIdentity();
+    const gp_Trsf& transform = location.Transformation();
+    const bool reversed = face.Orientation() == TopAbs_REVERSED;
+
+    const int nodeCount = triangulation->NbNodes();
+    const uint32_t firstVertex = (uint32_t)out.getVertexCount();
+    out.positions.reserve(out.positions.size() + 3 * nodeCount);
+    out.normals.reserve(out.normals.size() + 3 * nodeCount);
+    for (int i = 1; i <= nodeCount; i++) {
+        gp_Pnt point = triangulation->Node(i);
+        gp_Dir normal = triangulation->Normal(i);
+        if (transformed) {
+            point.Transform(transform);
+            normal.Transform(transform);
+        }
+        if (reversed) {
+            normal.Reverse();
+        }
+        out.positions.insert(out.positions.end(), {(float)point.X(), (float)point.Y(), (float)point.Z()});
+        out.normals.insert(out.normals.end(), {(float)normal.X(), (float)normal.Y(), (float)normal.Z()});
+    }
+
+    const int triangleCount = triangulation->NbTriangles();
+    out.indices.reserve(out.indices.size() + 3 * triangleCount);
+    for (int i = 1; i <= triangleCount; i++) {
+        int n1, n2, n3;
+        triangulation->Triangle(i).Get(n1, n2, n3);
+        if (reversed) {
+            std::swap(n2, n3);
+        }
+        out.indices.insert(out.indices.end(), {firstVertex + n1 - 1, firstVertex + n2 - 1, firstVertex + n3 - 1});
+    }
+}
+
+} // namespace
+
+size_t MeshBuffers::getByteSize() const {
+    return positions.size() * sizeof(float) + normals.size() * sizeof(float) + indices.size() * sizeof(uint32_t);
+}
+
+void MeshBuffers::append(const MeshBuffers& other) {
+    const uint32_t firstVertex = (uint32_t)getVertexCount();
+    positions.insert(positions.end(), other.positions.begin(), other.positions.end());
+    normals.insert(normals.end(), other.normals.begin(), other.normals.end());
+    indices.reserve(indices.size() + other.indices.size());
+    for (uint32_t index : other.indices) {
+        indices.push_back(firstVertex + index);
+    }
+}
+
+MeshParams Tessellator::getMeshParams(MeshLod lod) {
+    // SPECIFICATION.md suggests 1 mm for preview and 0.1 mm for high quality
+    switch (lod) {
+        case MeshLod::Low:    return {1.0, 0.5};
+        case MeshLod::Medium: return {0.3, 0.3};
+        case MeshLod::High:   return {0.1, 0.15};
+        default:              break;
+    }
+    return {0.3, 0.3};
+}
+
+MeshLod Tessellator::selectLod(float screenCoverage) {
+    if (screenCoverage < 0.05f) {
+        return MeshLod::Low;
+    }
+    if (screenCoverage <= 0.5f) {
+        return MeshLod::Medium;
+    }
+    return MeshLod::High;
+}
+
+void Tessellator::clear() {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_faces.clear();
+    m_cacheBytes.set(0);
+}
+
+std::shared_ptr<const TessellatedShape> Tessellator::tessellate(const TopoDS_Shape& shape,
+                                                                const std::atomic<bool>* cancelled) {
+    BADCAD_TRACE_SCOPE_CAT("Tessellator::tessellate", "mesh");
+    std::lock_guard<std::mutex> lock(m_mutex);
+
+    // Faces in TopologyIndex ID order, so triangle ranges map to face IDs
+    std::shared_ptr<const TopologyIndex> topology = TopologyIndexCache::instance().get(shape);
+    std::vector<TopoDS_Shape> faces(topology->getFaceCount());
+    for (int id = 0; id < topology->getFaceCount(); id++) {
+        faces[id] = topology->getFace(id);
+    }
+
+    // Faces of this shape only; whatever the previous version had beyond that is dropped
+    FaceCache current;
+    std::vector<TopoDS_Shape> missing;
+    for (const TopoDS_Shape& face : faces) {
+        if (current.count(face)) {
+            continue;
+        }
+        auto cached = m_faces.find(face);
+        if (cached != m_faces.end()) {
+            current.emplace(face, cached->second);
+        } else {
+            current.emplace(face, nullptr);
+            missing.push_back(face);
+        }
+    }
+
+    // Then the disk cache; only what neither has gets meshed
+    TessellationCache& diskCache = TessellationCache::instance();
+    std::vector<uint64_t> hashes(missing.size());
+    std::vector<std::shared_ptr<FaceMeshes>> loaded(missing.size());
+    TaskScheduler::instance().parallelFor(0, missing.size(), 8, [&](size_t begin, size_t end) {
+        for (size_t i = begin; i < end; i++) {
+            const TopoDS_Face& face = TopoDS::Face(missing[i]);
+            hashes[i] = TessellationCache::hashFace(face);
+            auto meshes = std::make_shared<FaceMeshes>();
+            if (diskCache.load(face, hashes[i], *meshes)) {
+                loaded[i] = std::move(meshes);
+            }
+        }
+    });
+
+    std::vector<TopoDS_Shape> toMesh;
+    std::vector<uint64_t> toMeshHashes;
+    for (size_t i = 0; i < missing.size(); i++) {
+        if (loaded[i]) {
+            current[missing[i]] = std::move(loaded[i]);
+        } else {
+            toMesh.push_back(missing[i]);
+            toMeshHashes.push_back(hashes[i]);
+        }
+    }
+
+    if (!toMesh.empty()) {
+        std::vector<std::shared_ptr<const FaceMeshes>> meshed;
+        if (!meshFaces(toMesh, meshed, cancelled)) {
+            return nullptr;
+        }
+        TaskScheduler::instance().parallelFor(0, toMesh.size(), 8, [&](size_t begin, size_t end) {
+            for (size_t i = begin; i < end; i++) {
+                diskCache.store(toMeshHashes[i], *meshed[i]);
+            }
+        }, TaskPriority::Background);
+        for (size_t i = 0; i < toMesh.size(); i++) {
+            current[toMesh[i]] = std::move(meshed[i]);
+        }
+    }
+
+    auto result = std::make_shared<TessellatedShape>();
+    result->faceCount = faces.size();
+    result->meshedFaceCount = toMesh.size();
+    for (size_t level = 0; level < kMeshLodCount; level++) {
+        MeshBuffers& buffers = result->levels[level];
+        std::vector<uint32_t>& offsets = result->faceIndexOffsets[level];
+        offsets.reserve(faces.size() + 1);
+        for (const TopoDS_Shape& face : faces) {
+            offsets.push_back((uint32_t)buffers.indices.size());
+            buffers.append((*current[face])[level]);
+        }
+        offsets.push_back((uint32_t)buffers.indices.size());
+    }
+
+    size_t cacheBytes = 0;
+    for (const auto& entry : current) {
+        for (const MeshBuffers& buffers : *entry.second) {
+            cacheBytes += buffers.getByteSize();
+        }
+    }
+    m_faces.swap(current);
+    m_cacheBytes.set(cacheBytes);
+
+    BADCAD_LOG_DEBUG("Tessellated ", faces.size(), " faces (", toMesh.size(), " meshed, ",
+                     missing.size() - toMesh.size(), " from disk, ", faces.size() - missing.size(), " reused)");
+    return result;
+}
+
+std::shared_ptr<const MeshBuffers> Tessellator::tessellateLevel(const TopoDS_Shape& shape, MeshLod lod,
+                                                                 const std::atomic<bool>* cancelled) {
+    BADCAD_TRACE_SCOPE_CAT("Tessellator::tessellateLevel", "mesh");
+    std::vector<MeshBuffers> faceMeshes;
+    try {
+        // Meshed on a copy, as in meshFaces()
+        BRepBuilderAPI_Copy copier(shape, Standard_False, Standard_False);
+        const TopoDS_Shape& copy = copier.Shape();
+        TopTools_IndexedMapOfShape faces;
+        TopExp::MapShapes(copy, TopAbs_FACE, faces);
+
+        MeshParams meshParams = getMeshParams(lod);
+        IMeshTools_Parameters parameters;
+        parameters.Deflection = meshParams.linearDeflection;
+        parameters.Angle = meshParams.angularDeflection;
+        parameters.InParallel = Standard_True;
+        Handle(CancelIndicator) indicator = new CancelIndicator(cancelled);
+        {
+            BADCAD_TRACE_SCOPE_CAT("BRepMesh_IncrementalMesh", "mesh");
+            BRepMesh_IncrementalMesh mesher(copy, parameters, indicator->Start());
+        }
+        if (isCancelled(cancelled)) {
+            return nullptr;
+        }
+
+        faceMeshes.resize((size_t)faces.Extent());
+        TaskScheduler::instance().parallelFor(0, faceMeshes.size(), 16, [&](size_t begin, size_t end) {
+            for (size_t i = begin; i < end; i++) {
+                try {
+                    extractFace(TopoDS::Face(faces((int)i + 1)), faceMeshes[i]);
+                } catch (Standard_Failure const& e) {
+                    BADCAD_LOG_WARN("Failed to extract face mesh: ", e.GetMessageString());
+                    faceMeshes[i] = MeshBuffers();
+                }
+            }
+        });
+    } catch (Standard_Failure const& e) {
+        BADCAD_LOG_ERROR("Tessellation failed: ", e.GetMessageString());
+        return nullptr;
+    }
+
+    auto result = std::make_shared<MeshBuffers>();
+    size_t positionCount = 0, indexCount = 0;
+    for (const MeshBuffers& mesh : faceMeshes) {
+        positionCount += mesh.positions.size();
+        indexCount += mesh.indices.size();
+    }
+    result->positions.reserve(positionCount);
+    result->normals.reserve(positionCount);
+    result->indices.reserve(indexCount);
+    for (const MeshBuffers& mesh : faceMeshes) {
+        result->append(mesh);
+    }
+    return result;
+}
+
+bool Tessellator::meshFaces(const std::vector<TopoDS_Shape>& faces,
+                            std::vector<std::shared_ptr<const FaceMeshes>>& outMeshes,
+                            const std::atomic<bool>* cancelled) {
+    std::vector<std::shared_ptr<FaceMeshes>> meshes(faces.size());
+    try {
+        // Mesh a copy: BRepMesh attaches triangulations to the faces it
+        // meshes, and the originals may be in use elsewhere. Copying them as
+        // one compound keeps shared edges shared, so neighbouring faces get
+        // matching edge discretizations.
+        TopoDS_Compound compound;
+        BRep_Builder builder;
+        builder.MakeCompound(compound);
+        for (const TopoDS_Shape& face : faces) {
+            builder.Add(compound, face);
+        }
+        BRepBuilderAPI_Copy copier(compound, Standard_False, Standard_False);
+        const TopoDS_Shape& copy = copier.Shape();
+
+        std::vector<TopoDS_Face> copies;
+        copies.reserve(faces.size());
+        for (TopoDS_Iterator it(copy); it.More(); it.Next()) {
+            copies.push_back(TopoDS::Face(it.Value()));
+        }
+        if (copies.size() != faces.size()) {
+            BADCAD_LOG_ERROR("Tessellation copy lost faces: ", copies.size(), " of ", faces.size());
+            return false;
+        }
+        for (std::shared_ptr<FaceMeshes>& mesh : meshes) {
+            mesh = std::make_shared<FaceMeshes>();
+        }
+
+        // Coarse to fine: BRepMesh keeps a triangulation that is already fine
+        // enough and replaces coarser ones, so each pass refines the last
+        Handle(CancelIndicator) indicator = new CancelIndicator(cancelled);
+        for (size_t level = 0; level < kMeshLodCount; level++) {
+            if (isCancelled(cancelled)) {
+                return false;
+            }
+            MeshParams meshParams = getMeshParams(static_cast<MeshLod>(level));
+            IMeshTools_Parameters parameters;
+            parameters.Deflection = meshParams.linearDeflection;
+            parameters.Angle = meshParams.angularDeflection;
+            parameters.InParallel = Standard_True;
+            {
+                BADCAD_TRACE_SCOPE_CAT("BRepMesh_IncrementalMesh", "mesh");
+                BRepMesh_IncrementalMesh mesher(copy, parameters, indicator->Start());
+            }
+            if (isCancelled(cancelled)) {
+                return false;
+            }
+
+            TaskScheduler::instance().parallelFor(0, copies.size(), 16, [&](size_t begin, size_t end) {
+                for (size_t i = begin; i < end; i++) {
+                    try {
+                        extractFace(copies[i], (*meshes[i])[level]);
+                    } catch (Standard_Failure const& e) {
+                        // Leave the face empty rather than lose the part
+                        BADCAD_LOG_WARN("Failed to extract face mesh: ", e.GetMessageString());
+                        (*meshes[i])[level] = MeshBuffers();
+                    }
+                }
+            });
+        }
+    } catch (Standard_Failure const& e) {
+        BADCAD_LOG_ERROR("Tessellation failed: ", e.GetMessageString());
+        return false;
+    }
+
+    outMeshes.assign(meshes.begin(), meshes.end());
+    return true;
+}
+
+} // namespace badcad
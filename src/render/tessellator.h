@@ -0,0 +1,111 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+#include "../utils/memory_tracker.h"
+#include <TopoDS_Shape.hxx>
+
+namespace badcad {
+
+// Tessellation levels from SPECIFICATION.md §8
+enum class MeshLod {
+    Low,        // Fast preview, small on screen
+    Medium,     // Normal display
+    High,       // Close-ups and export
+    Count
+};
+
+constexpr size_t kMeshLodCount = static_cast<size_t>(MeshLod::Count);
+
+struct MeshParams {
+    double linearDeflection;    // Model units (mm)
+    double angularDeflection;   // Radians
+};
+
+// Flat arrays, laid out for glBufferData as-is
+struct MeshBuffers {
+    std::vector<float> positions;       // x, y, z per vertex
+    std::vector<float> normals;         // x, y, z per vertex
+    std::vector<uint32_t> indices;      // Three per triangle, counter-clockwise
+
+    size_t getVertexCount() const { return positions.size() / 3; }
+    size_t getByteSize() const;
+    void append(const MeshBuffers& other);
+};
+
+// All faces of a shape merged per LOD. Face i owns the index range
+// [faceIndexOffsets[i], faceIndexOffsets[i + 1]) of that level, where i is
+// the face's TopologyIndex ID, which is what picking maps back to faces.
+struct TessellatedShape {
+    std::array<MeshBuffers, kMeshLodCount> levels;
+    std::array<std::vector<uint32_t>, kMeshLodCount> faceIndexOffsets;
+    size_t faceCount = 0;
+    size_t meshedFaceCount = 0;     // Faces that were in neither cache
+
+    const MeshBuffers& getLevel(MeshLod lod) const { return levels[static_cast<size_t>(lod)]; }
+};
+
+// Meshes BRep shapes at all three LODs with BRepMesh_IncrementalMesh in
+// parallel mode.
+//
+// One instance per displayed part: it remembers the meshes of the faces it
+// saw last time, so after an edit only new or modified faces are meshed
+// (OCC keeps untouched faces as the same TShape through most operations).
+// Faces it has not seen are looked up in the on-disk TessellationCache
+// before meshing.
+// Meshing runs on a private copy of those faces, so the caller's shape is
+// only read and never gets a triangulation attached.
+class Tessellator {
+public:
+    Tessellator() = default;
+
+    Tessellator(const Tessellator&) = delete;
+    Tessellator& operator=(const Tessellator&) = delete;
+
+    // Blocking; call from a worker. The shape must not be modified meanwhile.
+    // Returns nullptr if cancelled or if meshing failed.
+    std::shared_ptr<const TessellatedShape> tessellate(const TopoDS_Shape& shape,
+                                                       const std::atomic<bool>* cancelled = nullptr);
+
+    // Meshes the shape at one LOD only, for parts that are shown at a single
+    // level and never edited, such as imports. Uses neither cache and keeps
+    // no state. Blocking; returns nullptr if cancelled or if meshing failed.
+    static std::shared_ptr<const MeshBuffers> tessellateLevel(const TopoDS_Shape& shape, MeshLod lod,
+                                                              const std::atomic<bool>* cancelled = nullptr);
+
+    // Drop every cached face mesh
+    void clear();
+
+    static MeshParams getMeshParams(MeshLod lod);
+
+    // LOD for a part covering the given fraction of the viewport (0..1)
+    static MeshLod selectLod(float screenCoverage);
+
+private:
+    using FaceMeshes = std::array<MeshBuffers, kMeshLodCount>;
+
+    struct ShapeHash {
+        size_t operator()(const TopoDS_Shape& shape) const { return std::hash<TopoDS_Shape>()(shape); }
+    };
+    struct ShapeEqual {
+        bool operator()(const TopoDS_Shape& a, const TopoDS_Shape& b) const { return a.IsEqual(b); }
+    };
+    using FaceCache = std::unordered_map<TopoDS_Shape, std::shared_ptr<const FaceMeshes>, ShapeHash, ShapeEqual>;
+
+    static bool meshFaces(const std::vector<TopoDS_Shape>& faces,
+                          std::vector<std::shared_ptr<const FaceMeshes>>& outMeshes,
+                          const std::atomic<bool>* cancelled);
+
+    // Serializes tessellate() calls; the cache is only touched under it
+    std::mutex m_mutex;
+    FaceCache m_faces;
+    TrackedBytes m_cacheBytes{MemoryTag::Tessellation};
+};
+
+} // namespace badcad
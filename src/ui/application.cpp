@@ -3,14 +3,53 @@
 #include "imgui.h"
 #include "imgui_impl_glfw.h"
 #include "imgui_impl_opengl3.h"
-#include <iostream>
-#include <GLFW/glfw3.h>
+#include "font_atlas_cache.h"
+#include "../render/gl_loader.h"
+#include "../utils/log.h"
+#include "../utils/startup_timer.h"
+#include "../utils/memory_tracker.h"
+#include "../utils/resource_bundle.h"
+#include "../utils/task_scheduler.h"
+#include "../utils/trace.h"
 
 #define STB_IMAGE_IMPLEMENTATION
 #include <stb/stb_image.h>
 
 namespace badcad {
 
+namespace {
+
+// RGBA pixels decoded by stb_image on a worker thread
+struct DecodedImage {
+    unsigned char* pixels = nullptr;
+    int width = 0;
+    int height = 0;
+    
+    ~DecodedImage() {
+        if (pixels) {
+            stbi_image_free(pixels);
+        }
+    }
+};
+
+// UI typefaces; sizes are at 100% display scale
+const std::vector<FontSpec> kUiFonts = {
+    {"fonts/IBMPlexSans-Regular.ttf", 16.0f},
+};
+
+std::shared_ptr<DecodedImage> decodeImage(const char* name) {
+    BADCAD_TRACE_SCOPE_CAT("Decode PNG", "startup");
+    auto image = std::make_shared<DecodedImage>();
+    ResourceView png = Resources::get(name);
+    if (png) {
+        int channels;
+        image->pixels = stbi_load_from_memory(png.data, (int)png.size, &image->width, &image->height, &channels, 4);
+    }
+    return image;
+}
+
+} // namespace
+
 // Static callback wrappers
 static void framebufferSizeCallback(GLFWwindow* window, int width, int height) {
     Application* app = static_cast<Application*>(glfwGetWindowUserPointer(window));
@@ -26,6 +65,13 @@ static void windowRefreshCallback(GLFWwindow* window) {
     }
 }
 
+static void contentScaleCallback(GLFWwindow* window, float xscale, float /*yscale*/) {
+    Application* app = static_cast<Application*>(glfwGetWindowUserPointer(window));
+    if (app) {
+        app->onContentScaleChanged(xscale);
+    }
+}
+
 Application::Application() {
     m_partEditor = std::make_unique<PartEditor>(this);
 }
@@ -35,11 +81,32 @@ Application::~Application() {
 }
 
 bool Application::init() {
+    StartupTimer::mark("Application::init");
+    
+    // Shared pool for saving, parsing, tessellation and recompute. Started
+    // first so image decoding and font rasterization overlap window creation.
+    TaskScheduler::instance().start();
+    loadWindowIcon();
+    loadLogoImage();
+
     // Initialize GLFW
     if (!glfwInit()) {
-        std::cerr << "Failed to initialize GLFW" << std::endl;
+        BADCAD_LOG_ERROR("Failed to initialize GLFW");
+        TaskScheduler::instance().stop();
         return false;
     }
+    
+    // Fonts are rasterized for the primary monitor; a window that opens
+    // elsewhere gets a rebuild through the content scale callback
+    float scaleY;
+    glfwGetMonitorContentScale(glfwGetPrimaryMonitor(), &m_fontScale, &scaleY);
+    TaskHandle fontAtlas = buildFontAtlas();
+    
+    auto abortInit = [&]() {
+        TaskScheduler::instance().wait(fontAtlas);
+        ImGui::DestroyContext();
+        TaskScheduler::instance().stop();
+    };
 
     // OpenGL 3.3 - use Compatibility Profile for legacy OpenGL support
     glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 3);
@@ -54,7 +121,8 @@ bool Application::init() {
     m_window = glfwCreateWindow(m_windowWidth, m_windowHeight, 
                                  m_windowTitle.c_str(), nullptr, nullptr);
     if (!m_window) {
-        std::cerr << "Failed to create GLFW window" << std::endl;
+        BADCAD_LOG_ERROR("Failed to create GLFW window");
+        abortInit();
         glfwTerminate();
         return false;
     }
@@ -62,34 +130,109 @@ bool Application::init() {
     glfwMakeContextCurrent(m_window);
     glfwSwapInterval(1); // Enable vsync
     
+    loadGLFunctions();
+    m_profiler.init();
+    StartupTimer::mark("Window and GL context");
+    
     // Set window user pointer for callbacks
     glfwSetWindowUserPointer(m_window, this);
     
     // Set callbacks for continuous rendering during resize
     glfwSetFramebufferSizeCallback(m_window, framebufferSizeCallback);
     glfwSetWindowRefreshCallback(m_window, windowRefreshCallback);
-    
-    loadWindowIcon();
+    glfwSetWindowContentScaleCallback(m_window, contentScaleCallback);
 
+    // The backend uploads the atlas on the first frame, so it has to be complete here
+    TaskScheduler::instance().wait(fontAtlas);
+    StartupTimer::mark("Font atlas");
     setupImGui();
-    loadLogoImage();
+    
+    float windowScale;
+    glfwGetWindowContentScale(m_window, &windowScale, &scaleY);
+    onContentScaleChanged(windowScale);
 
     m_splashStartTime = glfwGetTime();
     m_initialized = true;
+    StartupTimer::mark("Init done");
 
-    std::cout << "badCAD initialized successfully" << std::endl;
+    BADCAD_LOG_INFO("badCAD initialized successfully");
     return true;
 }
 
-void Application::setupImGui() {
+TaskHandle Application::buildFontAtlas() {
     // Setup Dear ImGui context
     IMGUI_CHECKVERSION();
     ImGui::CreateContext();
+    
+    // Load or rasterize on a worker; nothing touches ImGui until init() has waited for it
+    ImFontAtlas* fonts = ImGui::GetIO().Fonts;
+    float scale = m_fontScale;
+    return TaskScheduler::instance().submit([fonts, scale]() {
+        FontAtlasCache::buildOrLoad(fonts, kUiFonts, scale);
+    }, TaskPriority::Interactive);
+}
+
+void Application::onContentScaleChanged(float scale) {
+    if (scale == m_fontScale) {
+        return;
+    }
+    m_fontScale = scale;
+    
+    // Read the cache off the UI thread; the current atlas stays in use until
+    // the replacement is ready. The ImGui objects are only created on the main
+    // thread, since ImGui's allocator updates context counters unlocked.
+    TaskScheduler::instance().submit([this, scale]() {
+        std::shared_ptr<const FontAtlasData> data = FontAtlasCache::loadData(kUiFonts, scale);
+        
+        TaskScheduler::instance().postToMainThread([this, data, scale]() {
+            if (scale != m_fontScale) {
+                // Superseded by a later change
+                return;
+            }
+            ImFontAtlas* atlas = IM_NEW(ImFontAtlas)();
+            if (data) {
+                FontAtlasCache::fill(atlas, *data);
+            } else {
+                // First time at this scale: rasterized here once, cached after
+                FontAtlasCache::buildOrLoad(atlas, kUiFonts, scale);
+            }
+            installFontAtlas(atlas);
+        });
+    }, TaskPriority::Background);
+}
+
+void Application::installFontAtlas(ImFontAtlas* atlas) {
+    // Runs between frames, when ImGui holds no pointers into the old atlas
     ImGuiIO& io = ImGui::GetIO();
-    io.ConfigFlags |= ImGuiConfigFlags_NavEnableKeyboard;
+    ImGui_ImplOpenGL3_DestroyFontsTexture();
+    ImFontAtlas* previous = io.Fonts;
+    io.Fonts = atlas;
+    ImGui_ImplOpenGL3_CreateFontsTexture();
+    IM_DELETE(previous);
+    
+    updateFontScale();
+    BADCAD_LOG_DEBUG("Font atlas rebuilt for scale ", m_fontScale);
+}
+
+void Application::updateFontScale() {
+    ImGuiIO& io = ImGui::GetIO();
+    
+    // Glyphs are rasterized at the monitor scale. Where window coordinates are
+    // in points rather than pixels (macOS) draw them back at their logical size.
+    int windowWidth, windowHeight, framebufferWidth, framebufferHeight;
+    glfwGetWindowSize(m_window, &windowWidth, &windowHeight);
+    glfwGetFramebufferSize(m_window, &framebufferWidth, &framebufferHeight);
+    io.FontGlobalScale = (windowWidth > 0 && framebufferWidth > windowWidth)
+        ? (float)windowWidth / (float)framebufferWidth : 1.0f;
     
-    // Load custom font
-    io.Fonts->AddFontFromFileTTF("resources/fonts/IBMPlexSans-Regular.ttf", 16.0f);
+    // Single-channel atlas, expanded to RGBA by the OpenGL backend
+    m_fontAtlasBytes.set((size_t)io.Fonts->TexWidth * io.Fonts->TexHeight * 4);
+}
+
+void Application::setupImGui() {
+    ImGuiIO& io = ImGui::GetIO();
+    io.ConfigFlags |= ImGuiConfigFlags_NavEnableKeyboard;
+    updateFontScale();
 
     // Setup style - dark theme for CAD app
     ImGui::StyleColorsDark();
@@ -107,24 +250,44 @@ void Application::setupImGui() {
 void Application::run() {
     while (!glfwWindowShouldClose(m_window)) {
         glfwPollEvents();
+        
+        // Results from background tasks that need ImGui, GL or editor state
+        TaskScheduler::instance().runMainThreadTasks();
 
-        // Auto-transition from splash after 1 second
-        if (m_state == AppState::Splash) {
-            double elapsed = glfwGetTime() - m_splashStartTime;
-            if (elapsed >= 1.0) {
-                setState(AppState::Home);
-            }
+        // Leave the splash as soon as everything the home screen shows is uploaded
+        if (m_state == AppState::Splash && m_startupAssetsPending == 0) {
+            setState(AppState::Home);
         }
 
         render();
+        
+        if (!m_startupReported && m_state != AppState::Splash) {
+            m_startupReported = true;
+            StartupTimer::mark("First home frame");
+            StartupTimer::report();
+            if (m_exitAfterStartup) {
+                glfwSetWindowShouldClose(m_window, GLFW_TRUE);
+            }
+        }
     }
 }
 
 void Application::render() {
+    BADCAD_TRACE_SCOPE("Application::render");
+    m_profiler.beginFrame();
+    m_profiler.beginSection(FrameSection::ImGuiBuild);
+    
     // Start ImGui frame
     ImGui_ImplOpenGL3_NewFrame();
     ImGui_ImplGlfw_NewFrame();
     ImGui::NewFrame();
+    
+    if (ImGui::IsKeyPressed(ImGuiKey_F3, false)) {
+        m_profiler.toggleOverlay();
+    }
+    if (ImGui::IsKeyPressed(ImGuiKey_F4, false)) {
+        m_memoryPanelVisible = !m_memoryPanelVisible;
+    }
 
     // Render current state
     switch (m_state) {
@@ -143,9 +306,18 @@ void Application::render() {
             // TODO: Implement assembly editor
             break;
     }
+    
+    if (m_memoryPanelVisible) {
+        renderMemoryPanel();
+    }
 
     // Rendering
     ImGui::Render();
+    m_profiler.endSection(FrameSection::ImGuiBuild);
+    
+    // Draw data includes the viewport texture, so this is where the FBO
+    // is resolved onto the back buffer
+    m_profiler.beginSection(FrameSection::Resolve, true);
     int display_w, display_h;
     glfwGetFramebufferSize(m_window, &display_w, &display_h);
     glViewport(0, 0, display_w, display_h);
@@ -159,8 +331,14 @@ void Application::render() {
     
     glClear(GL_COLOR_BUFFER_BIT);
     ImGui_ImplOpenGL3_RenderDrawData(ImGui::GetDrawData());
+    m_profiler.endSection(FrameSection::Resolve, true);
 
-    glfwSwapBuffers(m_window);
+    {
+        BADCAD_TRACE_SCOPE_CAT("SwapBuffers", "gl");
+        ProfileScope swap(&m_profiler, FrameSection::Swap);
+        glfwSwapBuffers(m_window);
+    }
+    m_profiler.endFrame();
 }
 
 void Application::onFramebufferResize(int width, int height) {
@@ -172,13 +350,30 @@ void Application::onFramebufferResize(int width, int height) {
 
 void Application::setState(AppState newState) {
     m_state = newState;
-    std::cout << "State changed to: " << (int)newState << std::endl;
+    BADCAD_LOG_DEBUG("State changed to: ", (int)newState);
 }
 
 void Application::shutdown() {
     if (m_initialized) {
+        // Let in-flight saves finish; pending callbacks into the editor are dropped
+        TaskScheduler::instance().stop();
+        
+        // The editor's viewer owns a render thread and GL objects; release
+        // them while the window and its context still exist
+        m_partEditor.reset();
+        
+        if (!m_profileOutput.empty() && m_profiler.dumpToFile(m_profileOutput)) {
+            BADCAD_LOG_INFO("Frame profile written to ", m_profileOutput);
+        }
+        m_profiler.shutdown();
+        
+        if (m_memoryReport) {
+            BADCAD_LOG_INFO(MemoryTracker::formatReport());
+        }
+        
         // Clean up logo texture
         if (m_logoTexture != 0) {
+            MemoryTracker::remove(MemoryTag::GpuBuffers, (size_t)m_logoWidth * m_logoHeight * 4);
             glDeleteTextures(1, &m_logoTexture);
             m_logoTexture = 0;
         }
@@ -197,60 +392,66 @@ void Application::shutdown() {
 }
 
 void Application::loadLogoImage() {
-    const char* logoPath = "resources/icons/logo_hq.png";
-    
-    // Load image using stb_image
-    int channels;
-    unsigned char* data = stbi_load(logoPath, &m_logoWidth, &m_logoHeight, &channels, 4);
-    
-    if (data == nullptr) {
-        std::cerr << "Failed to load logo image: " << logoPath << std::endl;
-        return;
-    }
+    const char* logoPath = "icons/logo_hq.png";
     
-    // Create OpenGL texture
-    glGenTextures(1, &m_logoTexture);
-    glBindTexture(GL_TEXTURE_2D, m_logoTexture);
-    
-    // Set texture parameters (0x812F is GL_CLAMP_TO_EDGE)
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, 0x812F);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, 0x812F);
-    
-    // Upload texture data
-    glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, m_logoWidth, m_logoHeight, 0, GL_RGBA, GL_UNSIGNED_BYTE, data);
-    
-    // Free image data
-    stbi_image_free(data);
-    
-    std::cout << "Logo loaded: " << m_logoWidth << "x" << m_logoHeight << std::endl;
+    // Decode on a worker, upload on the main thread once the GL context exists
+    m_startupAssetsPending++;
+    TaskScheduler::instance().submit([this, logoPath]() {
+        std::shared_ptr<DecodedImage> image = decodeImage(logoPath);
+        
+        TaskScheduler::instance().postToMainThread([this, logoPath, image]() {
+            m_startupAssetsPending--;
+            if (image->pixels == nullptr) {
+                BADCAD_LOG_WARN("Failed to load logo image: ", logoPath);
+                return;
+            }
+            
+            m_logoWidth = image->width;
+            m_logoHeight = image->height;
+            
+            // Create OpenGL texture
+            glGenTextures(1, &m_logoTexture);
+            glBindTexture(GL_TEXTURE_2D, m_logoTexture);
+            
+            // Set texture parameters (0x812F is GL_CLAMP_TO_EDGE)
+            glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+            glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+            glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, 0x812F);
+            glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, 0x812F);
+            
+            // Upload texture data
+            glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, m_logoWidth, m_logoHeight, 0, GL_RGBA, GL_UNSIGNED_BYTE, image->pixels);
+            MemoryTracker::add(MemoryTag::GpuBuffers, (size_t)m_logoWidth * m_logoHeight * 4);
+            
+            BADCAD_LOG_DEBUG("Logo loaded: ", m_logoWidth, "x", m_logoHeight);
+        });
+    }, TaskPriority::Interactive);
 }
 
 void Application::loadWindowIcon() {
-    const char* iconPath = "resources/icons/logo_black_bg.png";
-    
-    // Load icon using stb_image
-    int width, height, channels;
-    unsigned char* data = stbi_load(iconPath, &width, &height, &channels, 4);
-    
-    if (data == nullptr) {
-        std::cerr << "Failed to load window icon: " << iconPath << std::endl;
-        return;
-    }
+    const char* iconPath = "icons/logo_black_bg.png";
     
-    // Set window icon
-    GLFWimage icon;
-    icon.width = width;
-    icon.height = height;
-    icon.pixels = data;
-    
-    glfwSetWindowIcon(m_window, 1, &icon);
-    
-    // Free image data
-    stbi_image_free(data);
-    
-    std::cout << "Window icon loaded: " << width << "x" << height << std::endl;
+    // Not needed for the first frame; GLFW wants it set from the main thread
+    TaskScheduler::instance().submit([this, iconPath]() {
+        std::shared_ptr<DecodedImage> image = decodeImage(iconPath);
+        
+        TaskScheduler::instance().postToMainThread([this, iconPath, image]() {
+            if (image->pixels == nullptr) {
+                BADCAD_LOG_WARN("Failed to load window icon: ", iconPath);
+                return;
+            }
+            
+            // Set window icon
+            GLFWimage icon;
+            icon.width = image->width;
+            icon.height = image->height;
+            icon.pixels = image->pixels;
+            
+            glfwSetWindowIcon(m_window, 1, &icon);
+            
+            BADCAD_LOG_DEBUG("Window icon loaded: ", image->width, "x", image->height);
+        });
+    }, TaskPriority::Background);
 }
 
 } // namespace badcad
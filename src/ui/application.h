@@ -3,6 +3,11 @@
 #include <GLFW/glfw3.h>
 #include <string>
 #include <memory>
+#include "../render/frame_profiler.h"
+#include "../utils/memory_tracker.h"
+#include "../utils/task_scheduler.h"
+
+struct ImFontAtlas;
 
 namespace badcad {
 
@@ -28,15 +33,33 @@ public:
     AppState getState() const { return m_state; }
 
     GLFWwindow* getWindow() { return m_window; }
+    FrameProfiler& getProfiler() { return m_profiler; }
+    
+    // Content scale the UI fonts are rasterized at; icons follow it too
+    float getFontScale() const { return m_fontScale; }
+    
+    // Frame profile summary written on shutdown, for comparing runs
+    void setProfileOutput(const std::string& path) { m_profileOutput = path; }
+    
+    // Log the per-tag memory report on shutdown
+    void setMemoryReport(bool enabled) { m_memoryReport = enabled; }
+    
+    // Close as soon as the home screen is up, for timing cold starts from scripts
+    void setExitAfterStartup(bool enabled) { m_exitAfterStartup = enabled; }
     
     // Public for GLFW callbacks
     void onFramebufferResize(int width, int height);
+    void onContentScaleChanged(float scale);
     void render();
 
 private:
+    TaskHandle buildFontAtlas();
+    void installFontAtlas(ImFontAtlas* atlas);
+    void updateFontScale();
     void setupImGui();
     void renderSplash();
     void renderHome();
+    void renderMemoryPanel();
     void loadLogoImage();
     void loadWindowIcon();
 
@@ -44,12 +67,21 @@ private:
     AppState m_state = AppState::Splash;
     double m_splashStartTime = 0.0;
     bool m_initialized = false;
+    
+    // Startup: decodes still in flight that the home screen needs
+    int m_startupAssetsPending = 0;
+    bool m_startupReported = false;
+    bool m_exitAfterStartup = false;
 
     // Window properties
     int m_windowWidth = 1280;
     int m_windowHeight = 720;
     std::string m_windowTitle = "badCAD v0.1.0";
     
+    // Font atlas, rasterized for the monitor's content scale
+    float m_fontScale = 1.0f;
+    TrackedBytes m_fontAtlasBytes{MemoryTag::GpuBuffers};
+    
     // Logo texture
     unsigned int m_logoTexture = 0;
     int m_logoWidth = 0;
@@ -57,6 +89,14 @@ private:
     
     // Editors
     std::unique_ptr<PartEditor> m_partEditor;
+    
+    // Frame timing (F3 toggles the overlay)
+    FrameProfiler m_profiler;
+    std::string m_profileOutput;
+    
+    // Memory accounting (F4 toggles the panel)
+    bool m_memoryPanelVisible = false;
+    bool m_memoryReport = false;
 };
 
 } // namespace badcad
@@ -10,7 +10,7 @@
 
 namespace badcad {
 
-std::string openFileDialog(bool save, void* windowHandle) {
+std::string openFileDialog(FileDialogType type, void* windowHandle) {
 #ifdef _WIN32
     std::string result;
     
@@ -20,6 +20,7 @@ std::string openFileDialog(bool save, void* windowHandle) {
     
     IFileDialog* pfd = nullptr;
     
+    bool save = type != FileDialogType::Open;
     if (save) {
         hr = CoCreateInstance(CLSID_FileSaveDialog, NULL, CLSCTX_ALL, 
                             IID_IFileSaveDialog, reinterpret_cast<void**>(&pfd));
@@ -32,12 +33,25 @@ std::string openFileDialog(bool save, void* windowHandle) {
         // Set file types
         COMDLG_FILTERSPEC fileTypes[] = {
             { L"badCAD Files", L"*.bCAD" },
-            { L"All Files", L"*.*" }
+            { L"All Files", L"*.*" },
+            { L"STEP Files", L"*.step;*.stp" }     // Import, open dialog only
         };
-        pfd->SetFileTypes(2, fileTypes);
+        COMDLG_FILTERSPEC meshTypes[] = {
+            { L"STL Files", L"*.stl" },
+            { L"OBJ Files", L"*.obj" }
+        };
+        if (type == FileDialogType::ExportMesh) {
+            pfd->SetFileTypes(2, meshTypes);
+        } else {
+            pfd->SetFileTypes(save ? 2 : 3, fileTypes);
+        }
         pfd->SetFileTypeIndex(1);
         
-        if (save) {
+        // The dialog switches this to the chosen filter's extension, so the
+        // overwrite prompt checks the file that will actually be written
+        if (type == FileDialogType::ExportMesh) {
+            pfd->SetDefaultExtension(L"stl");
+        } else if (save) {
             pfd->SetDefaultExtension(L"bCAD");
         }
         
@@ -4,6 +4,12 @@
 
 namespace badcad {
 
-std::string openFileDialog(bool save, void* windowHandle);
+enum class FileDialogType {
+    Open,           // badCAD parts, STEP for import
+    Save,           // badCAD parts
+    ExportMesh      // STL or OBJ, by the chosen filter
+};
+
+std::string openFileDialog(FileDialogType type, void* windowHandle);
 
 } // namespace badcad
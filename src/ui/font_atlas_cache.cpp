@@ -0,0 +1,357 @@
+#include "font_atlas_cache.h"
+#include "imgui.h"
+#include "../utils/cache_dir.h"
+#include "../utils/hash.h"
+#include "../utils/log.h"
+#include "../utils/resource_bundle.h"
+#include "../utils/trace.h"
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <string>
+#include <type_traits>
+
+namespace badcad {
+
+namespace {
+
+constexpr char kMagic[4] = {'B', 'F', 'A', 'T'};
+constexpr uint32_t kFormatVersion = 1;
+
+// Sanity limits for files that claim more than any real atlas holds
+constexpr int32_t kMaxTextureSize = 16384;
+constexpr std::streamoff kMaxFileSize = 256ll << 20;
+
+struct AtlasFileHeader {
+    char magic[4];
+    uint32_t formatVersion;
+    uint32_t imguiVersion;
+    uint32_t glyphSize;         // ImFontGlyph is stored raw, so its layout must match
+    uint64_t key;
+};
+
+struct CustomRectRecord {
+    uint16_t width, height, x, y;
+    uint32_t glyphId;
+    float glyphAdvanceX;
+    ImVec2 glyphOffset;
+};
+
+struct FontRecord {
+    char name[40];
+    float fontSize;
+    float ascent;
+    float descent;
+    uint32_t glyphCount;
+};
+
+class Reader {
+public:
+    Reader(const std::vector<char>& bytes) : m_data(bytes.data()), m_remaining(bytes.size()) {}
+
+    template <typename T>
+    bool read(T& value) {
+        static_assert(std::is_trivially_copyable_v<T>, "raw read");
+        return readBytes(&value, sizeof(T));
+    }
+
+    size_t remaining() const { return m_remaining; }
+
+    bool readBytes(void* destination, size_t size) {
+        if (size > m_remaining) {
+            return false;
+        }
+        std::memcpy(destination, m_data, size);
+        m_data += size;
+        m_remaining -= size;
+        return true;
+    }
+
+private:
+    const char* m_data;
+    size_t m_remaining;
+};
+
+template <typename T>
+void write(std::ostream& out, const T& value) {
+    static_assert(std::is_trivially_copyable_v<T>, "raw write");
+    out.write(reinterpret_cast<const char*>(&value), sizeof(T));
+}
+
+std::filesystem::path cachePath(uint64_t key) {
+    std::filesystem::path directory = getCacheDirectory("fonts");
+    if (directory.empty()) {
+        return {};
+    }
+    char name[32];
+    std::snprintf(name, sizeof(name), "%016llx.atlas", (unsigned long long)key);
+    return directory / name;
+}
+
+} // namespace
+
+struct FontAtlasData {
+    int32_t width = 0;
+    int32_t height = 0;
+    ImVec2 uvScale;
+    ImVec2 uvWhitePixel;
+    ImVec4 uvLines[IM_DRAWLIST_TEX_LINES_WIDTH_MAX + 1];
+    int32_t packIdMouseCursors = -1;
+    int32_t packIdLines = -1;
+    std::vector<CustomRectRecord> rects;
+    std::vector<FontRecord> fonts;
+    std::vector<std::vector<ImFontGlyph>> glyphs;
+    std::vector<unsigned char> pixels;
+};
+
+uint64_t FontAtlasCache::makeKey(const std::vector<FontSpec>& fonts, float dpiScale) {
+    uint64_t key = hashCombine(hashString("font-atlas"), IMGUI_VERSION_NUM);
+    key = hashCombine(key, (uint64_t)(dpiScale * 100.0f + 0.5f));
+    for (const FontSpec& spec : fonts) {
+        // Fingerprint only: a cache hit must not read or inflate the TTF
+        key = hashCombine(key, hashString(spec.resource));
+        key = hashCombine(key, (uint64_t)(spec.sizePixels * 100.0f + 0.5f));
+        key = hashCombine(key, Resources::getFingerprint(spec.resource));
+    }
+    return key;
+}
+
+bool FontAtlasCache::buildOrLoad(ImFontAtlas* atlas, const std::vector<FontSpec>& fonts, float dpiScale) {
+    uint64_t key = makeKey(fonts, dpiScale);
+    if (std::shared_ptr<const FontAtlasData> data = read(key)) {
+        fill(atlas, *data);
+        BADCAD_LOG_DEBUG("Font atlas loaded from cache (scale ", dpiScale, ")");
+        return true;
+    }
+
+    BADCAD_TRACE_SCOPE_CAT("FontAtlasCache rasterize", "startup");
+    for (const FontSpec& spec : fonts) {
+        ResourceView data = Resources::get(spec.resource);
+        if (!data) {
+            BADCAD_LOG_WARN("Font not found: ", spec.resource);
+            continue;
+        }
+        // The bytes may live in the executable; the atlas must not free them
+        ImFontConfig config;
+        config.FontDataOwnedByAtlas = false;
+        std::snprintf(config.Name, sizeof(config.Name), "%s", spec.resource);
+        atlas->AddFontFromMemoryTTF(const_cast<unsigned char*>(data.data), (int)data.size,
+                                    spec.sizePixels * dpiScale, &config);
+    }
+
+    // Falls back to the built-in font when none of the files were found
+    if (!atlas->Build()) {
+        BADCAD_LOG_ERROR("Failed to build font atlas");
+        return false;
+    }
+    save(atlas, key);
+    return true;
+}
+
+std::shared_ptr<const FontAtlasData> FontAtlasCache::loadData(const std::vector<FontSpec>& fonts, float dpiScale) {
+    return read(makeKey(fonts, dpiScale));
+}
+
+std::shared_ptr<const FontAtlasData> FontAtlasCache::read(uint64_t key) {
+    std::filesystem::path path = cachePath(key);
+    if (path.empty()) {
+        return nullptr;
+    }
+    std::ifstream file(path, std::ios::binary | std::ios::ate);
+    if (!file.is_open()) {
+        return nullptr;
+    }
+    std::streamoff fileSize = file.tellg();
+    if (fileSize <= 0 || fileSize > kMaxFileSize) {
+        return nullptr;
+    }
+
+    BADCAD_TRACE_SCOPE_CAT("FontAtlasCache load", "startup");
+    std::vector<char> bytes((size_t)fileSize);
+    file.seekg(0);
+    if (!file.read(bytes.data(), bytes.size())) {
+        return nullptr;
+    }
+
+    Reader reader(bytes);
+    AtlasFileHeader header;
+    if (!reader.read(header) || std::memcmp(header.magic, kMagic, sizeof(kMagic)) != 0 ||
+        header.formatVersion != kFormatVersion || header.imguiVersion != IMGUI_VERSION_NUM ||
+        header.glyphSize != sizeof(ImFontGlyph) || header.key != key) {
+        return nullptr;
+    }
+
+    auto data = std::make_shared<FontAtlasData>();
+    uint32_t lineCount = 0;
+    if (!reader.read(data->width) || !reader.read(data->height) || !reader.read(data->uvScale) ||
+        !reader.read(data->uvWhitePixel) || !reader.read(lineCount) || lineCount != IM_ARRAYSIZE(data->uvLines) ||
+        !reader.readBytes(data->uvLines, sizeof(data->uvLines))) {
+        return nullptr;
+    }
+    if (data->width <= 0 || data->height <= 0 || data->width > kMaxTextureSize || data->height > kMaxTextureSize) {
+        return nullptr;
+    }
+
+    // Every count comes from the file, so each is checked against the bytes
+    // left before anything is sized from it; a damaged file is just a miss
+    uint32_t rectCount = 0;
+    if (!reader.read(data->packIdMouseCursors) || !reader.read(data->packIdLines) || !reader.read(rectCount) ||
+        rectCount > reader.remaining() / sizeof(CustomRectRecord)) {
+        return nullptr;
+    }
+    data->rects.resize(rectCount);
+    if (!reader.readBytes(data->rects.data(), sizeof(CustomRectRecord) * rectCount)) {
+        return nullptr;
+    }
+
+    uint32_t fontCount = 0;
+    if (!reader.read(fontCount) || fontCount == 0 || fontCount > reader.remaining() / sizeof(FontRecord)) {
+        return nullptr;
+    }
+    data->fonts.resize(fontCount);
+    data->glyphs.resize(fontCount);
+    for (uint32_t i = 0; i < fontCount; i++) {
+        FontRecord& record = data->fonts[i];
+        if (!reader.read(record) || record.glyphCount > reader.remaining() / sizeof(ImFontGlyph)) {
+            return nullptr;
+        }
+        data->glyphs[i].resize(record.glyphCount);
+        if (!reader.readBytes(data->glyphs[i].data(), sizeof(ImFontGlyph) * record.glyphCount)) {
+            return nullptr;
+        }
+    }
+
+    // The pixels are all that is left
+    size_t pixelCount = (size_t)data->width * (size_t)data->height;
+    if (pixelCount != reader.remaining()) {
+        return nullptr;
+    }
+    data->pixels.resize(pixelCount);
+    reader.readBytes(data->pixels.data(), pixelCount);
+    return data;
+}
+
+void FontAtlasCache::fill(ImFontAtlas* atlas, const FontAtlasData& data) {
+    unsigned char* pixels = (unsigned char*)IM_ALLOC(data.pixels.size());
+    std::memcpy(pixels, data.pixels.data(), data.pixels.size());
+    atlas->TexWidth = data.width;
+    atlas->TexHeight = data.height;
+    atlas->TexUvScale = data.uvScale;
+    atlas->TexUvWhitePixel = data.uvWhitePixel;
+    std::memcpy(atlas->TexUvLines, data.uvLines, sizeof(atlas->TexUvLines));
+    atlas->TexPixelsAlpha8 = pixels;
+
+    // White pixel, baked lines and mouse cursors live in custom rects
+    atlas->PackIdMouseCursors = data.packIdMouseCursors;
+    atlas->PackIdLines = data.packIdLines;
+    for (const CustomRectRecord& record : data.rects) {
+        ImFontAtlasCustomRect rect;
+        rect.Width = record.width;
+        rect.Height = record.height;
+        rect.X = record.x;
+        rect.Y = record.y;
+        rect.GlyphID = record.glyphId;
+        rect.GlyphAdvanceX = record.glyphAdvanceX;
+        rect.GlyphOffset = record.glyphOffset;
+        atlas->CustomRects.push_back(rect);
+    }
+
+    // Configs first: ImFont keeps a pointer into ConfigData
+    for (const FontRecord& record : data.fonts) {
+        ImFontConfig config;
+        config.FontDataOwnedByAtlas = false;
+        config.SizePixels = record.fontSize;
+        std::memcpy(config.Name, record.name, sizeof(config.Name));
+        config.Name[sizeof(config.Name) - 1] = '\0';
+        atlas->ConfigData.push_back(config);
+    }
+    for (size_t i = 0; i < data.fonts.size(); i++) {
+        const std::vector<ImFontGlyph>& glyphs = data.glyphs[i];
+        ImFont* font = IM_NEW(ImFont)();
+        font->FontSize = data.fonts[i].fontSize;
+        font->Ascent = data.fonts[i].ascent;
+        font->Descent = data.fonts[i].descent;
+        font->ContainerAtlas = atlas;
+        font->ConfigData = &atlas->ConfigData[(int)i];
+        font->ConfigDataCount = 1;
+        font->Glyphs.resize((int)glyphs.size());
+        std::memcpy(font->Glyphs.Data, glyphs.data(), sizeof(ImFontGlyph) * glyphs.size());
+        font->BuildLookupTable();
+        atlas->ConfigData[(int)i].DstFont = font;
+        atlas->Fonts.push_back(font);
+    }
+    atlas->TexReady = true;
+}
+
+void FontAtlasCache::save(const ImFontAtlas* atlas, uint64_t key) {
+    // Color glyphs keep RGBA pixels only; those atlases are simply rebuilt
+    if (!atlas->TexPixelsAlpha8 || atlas->TexPixelsUseColors) {
+        return;
+    }
+    std::filesystem::path path = cachePath(key);
+    if (path.empty()) {
+        return;
+    }
+
+    BADCAD_TRACE_SCOPE_CAT("FontAtlasCache save", "io");
+    // Write then rename, so a concurrent reader never sees a partial file
+    std::filesystem::path tempPath = path;
+    tempPath += ".tmp";
+    {
+        std::ofstream out(tempPath, std::ios::binary);
+        if (!out.is_open()) {
+            return;
+        }
+
+        AtlasFileHeader header;
+        std::memcpy(header.magic, kMagic, sizeof(kMagic));
+        header.formatVersion = kFormatVersion;
+        header.imguiVersion = IMGUI_VERSION_NUM;
+        header.glyphSize = sizeof(ImFontGlyph);
+        header.key = key;
+        write(out, header);
+
+        write(out, (int32_t)atlas->TexWidth);
+        write(out, (int32_t)atlas->TexHeight);
+        write(out, atlas->TexUvScale);
+        write(out, atlas->TexUvWhitePixel);
+        write(out, (uint32_t)IM_ARRAYSIZE(atlas->TexUvLines));
+        out.write(reinterpret_cast<const char*>(atlas->TexUvLines), sizeof(atlas->TexUvLines));
+
+        write(out, (int32_t)atlas->PackIdMouseCursors);
+        write(out, (int32_t)atlas->PackIdLines);
+        write(out, (uint32_t)atlas->CustomRects.Size);
+        for (const ImFontAtlasCustomRect& rect : atlas->CustomRects) {
+            CustomRectRecord record = {rect.Width, rect.Height, rect.X, rect.Y, rect.GlyphID,
+                                       rect.GlyphAdvanceX, rect.GlyphOffset};
+            write(out, record);
+        }
+
+        write(out, (uint32_t)atlas->Fonts.Size);
+        for (const ImFont* font : atlas->Fonts) {
+            FontRecord record = {};
+            if (font->ConfigData) {
+                std::memcpy(record.name, font->ConfigData->Name, sizeof(record.name));
+            }
+            record.fontSize = font->FontSize;
+            record.ascent = font->Ascent;
+            record.descent = font->Descent;
+            record.glyphCount = (uint32_t)font->Glyphs.Size;
+            write(out, record);
+            out.write(reinterpret_cast<const char*>(font->Glyphs.Data), sizeof(ImFontGlyph) * font->Glyphs.Size);
+        }
+
+        out.write(reinterpret_cast<const char*>(atlas->TexPixelsAlpha8), (size_t)atlas->TexWidth * atlas->TexHeight);
+        if (!out) {
+            return;
+        }
+    }
+
+    std::error_code ec;
+    std::filesystem::rename(tempPath, path, ec);
+    if (ec) {
+        std::filesystem::remove(tempPath, ec);
+    }
+}
+
+} // namespace badcad
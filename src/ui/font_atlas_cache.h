@@ -0,0 +1,48 @@
+#pragma once
+
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+struct ImFontAtlas;
+
+namespace badcad {
+
+// Glyph tables and pixels of a cached atlas, in plain memory
+struct FontAtlasData;
+
+struct FontSpec {
+    const char* resource;   // Name in the resource bundle, e.g. "fonts/IBMPlexSans-Regular.ttf"
+    float sizePixels;       // At 100% display scale
+};
+
+// Rasterized ImGui font atlases cached on disk, keyed by the font files'
+// contents, their sizes, the display scale and the ImGui version. A cache hit
+// restores glyph tables and pixels without touching the TTF data, so startup
+// does not grow with the number of typefaces.
+//
+// Everything that creates atlas objects allocates through ImGui, whose
+// allocation hook updates the current context's debug counters unlocked. Off
+// the main thread that is only safe while no frame is being built (startup);
+// once the UI runs, read with loadData() on a worker and fill() on the main
+// thread.
+class FontAtlasCache {
+public:
+    // Fills an empty atlas from the cache, or rasterizes it and saves the
+    // result. Returns false only if rasterizing failed.
+    static bool buildOrLoad(ImFontAtlas* atlas, const std::vector<FontSpec>& fonts, float dpiScale);
+
+    // The cached atlas for these fonts, or nullptr on a miss. Makes no ImGui
+    // calls, so any thread may use it.
+    static std::shared_ptr<const FontAtlasData> loadData(const std::vector<FontSpec>& fonts, float dpiScale);
+
+    // Fills an empty atlas from loadData()'s result
+    static void fill(ImFontAtlas* atlas, const FontAtlasData& data);
+
+private:
+    static uint64_t makeKey(const std::vector<FontSpec>& fonts, float dpiScale);
+    static std::shared_ptr<const FontAtlasData> read(uint64_t key);
+    static void save(const ImFontAtlas* atlas, uint64_t key);
+};
+
+} // namespace badcad
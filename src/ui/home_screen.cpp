@@ -1,6 +1,6 @@
 #include "application.h"
+#include "../utils/log.h"
 #include "imgui.h"
-#include <iostream>
 
 namespace badcad {
 
@@ -10,17 +10,17 @@ void Application::renderHome() {
     // Top toolbar
     if (ImGui::BeginMainMenuBar()) {
         if (ImGui::Button("New Part", ImVec2(100, 0))) {
-            std::cout << "New Part clicked" << std::endl;
+            BADCAD_LOG_DEBUG("New Part clicked");
             // TODO: Switch to Part Editor
         }
         
         if (ImGui::Button("New Assembly", ImVec2(120, 0))) {
-            std::cout << "New Assembly clicked" << std::endl;
+            BADCAD_LOG_DEBUG("New Assembly clicked");
             // TODO: Switch to Assembly Editor
         }
         
         if (ImGui::Button("Open", ImVec2(80, 0))) {
-            std::cout << "Open clicked" << std::endl;
+            BADCAD_LOG_DEBUG("Open clicked");
             // TODO: Show file picker
         }
         
@@ -89,18 +89,18 @@ void Application::renderHome() {
     // Quick action buttons
     ImGui::SetCursorPos(ImVec2(centerX - 150, startY));
     if (ImGui::Button("Create New Part", ImVec2(300, 50))) {
-        std::cout << "Create New Part clicked" << std::endl;
+        BADCAD_LOG_DEBUG("Create New Part clicked");
         m_state = AppState::PartEditor;
     }
     
     ImGui::SetCursorPos(ImVec2(centerX - 150, startY + 60));
     if (ImGui::Button("Create New Assembly", ImVec2(300, 50))) {
-        std::cout << "Create New Assembly clicked" << std::endl;
+        BADCAD_LOG_DEBUG("Create New Assembly clicked");
     }
     
     ImGui::SetCursorPos(ImVec2(centerX - 150, startY + 120));
     if (ImGui::Button("Open Existing File", ImVec2(300, 50))) {
-        std::cout << "Open Existing File clicked" << std::endl;
+        BADCAD_LOG_DEBUG("Open Existing File clicked");
     }
     
     // Recent files section (positioned at the end)
@@ -0,0 +1,264 @@
+#include "icon_atlas.h"
+#include "../render/gl_loader.h"
+#include "../utils/cache_dir.h"
+#include "../utils/hash.h"
+#include "../utils/log.h"
+#include "../utils/resource_bundle.h"
+#include "../utils/task_scheduler.h"
+#include "../utils/trace.h"
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <mutex>
+#include <unordered_set>
+
+#define NANOSVG_IMPLEMENTATION
+#include <nanosvg.h>
+#define NANOSVGRAST_IMPLEMENTATION
+#include <nanosvgrast.h>
+
+namespace badcad {
+
+namespace {
+
+constexpr char kMagic[4] = {'B', 'I', 'C', 'N'};
+constexpr uint32_t kFormatVersion = 1;
+
+// Transparent border around each icon so linear filtering never samples a neighbour
+constexpr int kPadding = 1;
+
+struct IconFileHeader {
+    char magic[4];
+    uint32_t formatVersion;
+    uint32_t pixelSize;
+    uint64_t key;
+};
+
+// Icons already reported as broken. Every rebuild (e.g. a display scale
+// change) rasterizes all icons again, and once per name is enough.
+std::mutex s_reportedMutex;
+std::unordered_set<std::string> s_reportedIcons;
+
+void reportBrokenIcon(const char* message, const std::string& name) {
+    bool first;
+    {
+        std::lock_guard<std::mutex> lock(s_reportedMutex);
+        first = s_reportedIcons.insert(name).second;
+    }
+    if (first) {
+        BADCAD_LOG_WARN(message, name);
+    } else {
+        BADCAD_LOG_DEBUG(message, name);
+    }
+}
+
+std::filesystem::path cachePath(uint64_t key) {
+    std::filesystem::path directory = getCacheDirectory("icons");
+    if (directory.empty()) {
+        return {};
+    }
+    char name[32];
+    std::snprintf(name, sizeof(name), "%016llx.icon", (unsigned long long)key);
+    return directory / name;
+}
+
+bool loadCached(uint64_t key, int pixelSize, std::vector<unsigned char>& outPixels) {
+    std::filesystem::path path = cachePath(key);
+    if (path.empty()) {
+        return false;
+    }
+    std::ifstream file(path, std::ios::binary);
+    if (!file.is_open()) {
+        return false;
+    }
+    IconFileHeader header;
+    if (!file.read(reinterpret_cast<char*>(&header), sizeof(header)) ||
+        std::memcmp(header.magic, kMagic, sizeof(kMagic)) != 0 || header.formatVersion != kFormatVersion ||
+        header.pixelSize != (uint32_t)pixelSize || header.key != key) {
+        return false;
+    }
+    outPixels.resize((size_t)pixelSize * pixelSize * 4);
+    return (bool)file.read(reinterpret_cast<char*>(outPixels.data()), outPixels.size());
+}
+
+void saveCached(uint64_t key, int pixelSize, const std::vector<unsigned char>& pixels) {
+    std::filesystem::path path = cachePath(key);
+    if (path.empty()) {
+        return;
+    }
+    // Write then rename, so a concurrent reader never sees a partial file
+    std::filesystem::path tempPath = path;
+    tempPath += ".tmp";
+    {
+        std::ofstream out(tempPath, std::ios::binary);
+        if (!out.is_open()) {
+            return;
+        }
+        IconFileHeader header;
+        std::memcpy(header.magic, kMagic, sizeof(kMagic));
+        header.formatVersion = kFormatVersion;
+        header.pixelSize = (uint32_t)pixelSize;
+        header.key = key;
+        out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+        out.write(reinterpret_cast<const char*>(pixels.data()), pixels.size());
+        if (!out) {
+            return;
+        }
+    }
+    std::error_code ec;
+    std::filesystem::rename(tempPath, path, ec);
+    if (ec) {
+        std::filesystem::remove(tempPath, ec);
+    }
+}
+
+// Renders the SVG centered in a pixelSize square, RGBA, not premultiplied
+bool rasterize(const std::string& name, int pixelSize, std::vector<unsigned char>& outPixels) {
+    ResourceView data = Resources::get(name);
+    if (!data) {
+        reportBrokenIcon("Icon not found: ", name);
+        return false;
+    }
+    uint64_t key = hashCombine(hashBytes(data.data, data.size), (uint64_t)pixelSize);
+    if (loadCached(key, pixelSize, outPixels)) {
+        return true;
+    }
+
+    // nsvgParse tokenizes in place and needs a terminator
+    std::string text(reinterpret_cast<const char*>(data.data), data.size);
+    NSVGimage* image = nsvgParse(&text[0], "px", 96.0f);
+    if (!image || image->width <= 0.0f || image->height <= 0.0f) {
+        reportBrokenIcon("Failed to parse icon: ", name);
+        nsvgDelete(image);
+        return false;
+    }
+
+    NSVGrasterizer* rasterizer = nsvgCreateRasterizer();
+    float scale = pixelSize / std::max(image->width, image->height);
+    float offsetX = (pixelSize - image->width * scale) * 0.5f;
+    float offsetY = (pixelSize - image->height * scale) * 0.5f;
+    outPixels.assign((size_t)pixelSize * pixelSize * 4, 0);
+    nsvgRasterize(rasterizer, image, offsetX, offsetY, scale, outPixels.data(), pixelSize, pixelSize, pixelSize * 4);
+    nsvgDeleteRasterizer(rasterizer);
+    nsvgDelete(image);
+
+    saveCached(key, pixelSize, outPixels);
+    return true;
+}
+
+} // namespace
+
+IconAtlas::IconAtlas(float iconSize)
+    : m_iconSize(iconSize)
+    , m_self(std::make_shared<IconAtlas*>(this)) {
+}
+
+IconAtlas::~IconAtlas() {
+    *m_self = nullptr;
+    if (m_texture != 0) {
+        glDeleteTextures(1, &m_texture);
+    }
+}
+
+bool IconAtlas::find(const std::string& name, ImVec2& uv0, ImVec2& uv1) {
+    auto it = m_regions.find(name);
+    if (it != m_regions.end()) {
+        uv0 = it->second.uv0;
+        uv1 = it->second.uv1;
+        return true;
+    }
+    if (std::find(m_names.begin(), m_names.end(), name) == m_names.end()) {
+        m_names.push_back(name);
+        m_dirty = true;
+    }
+    return false;
+}
+
+void IconAtlas::update(float pixelScale) {
+    if (pixelScale != m_pixelScale) {
+        m_pixelScale = pixelScale;
+        m_dirty = true;
+    }
+    // One build at a time; changes made meanwhile start the next one
+    if (!m_dirty || m_building || m_names.empty()) {
+        return;
+    }
+    m_dirty = false;
+    m_building = true;
+
+    std::vector<std::string> names = m_names;
+    int pixelSize = std::max(1, (int)std::lround(m_iconSize * m_pixelScale));
+    std::shared_ptr<IconAtlas*> self = m_self;
+    TaskScheduler::instance().submit([names, pixelSize, self]() {
+        std::shared_ptr<Packed> packed = build(names, pixelSize);
+        TaskScheduler::instance().postToMainThread([packed, self]() {
+            IconAtlas* atlas = *self;
+            if (!atlas) {
+                return;
+            }
+            atlas->m_building = false;
+            atlas->upload(*packed);
+        });
+    }, TaskPriority::Background);
+}
+
+std::shared_ptr<IconAtlas::Packed> IconAtlas::build(const std::vector<std::string>& names, int pixelSize) {
+    BADCAD_TRACE_SCOPE_CAT("IconAtlas build", "startup");
+
+    std::vector<std::vector<unsigned char>> icons(names.size());
+    std::vector<char> loaded(names.size(), 0);
+    TaskScheduler::instance().parallelFor(0, names.size(), 1, [&](size_t begin, size_t end) {
+        for (size_t i = begin; i < end; i++) {
+            loaded[i] = rasterize(names[i], pixelSize, icons[i]);
+        }
+    }, TaskPriority::Background);
+
+    // Fixed-size cells in a roughly square grid
+    auto packed = std::make_shared<Packed>();
+    int cell = pixelSize + 2 * kPadding;
+    int columns = (int)std::ceil(std::sqrt((double)names.size()));
+    int rows = ((int)names.size() + columns - 1) / columns;
+    packed->width = columns * cell;
+    packed->height = rows * cell;
+    packed->pixels.assign((size_t)packed->width * packed->height * 4, 0);
+
+    for (size_t i = 0; i < names.size(); i++) {
+        if (!loaded[i]) {
+            continue;
+        }
+        int x = (int)(i % columns) * cell + kPadding;
+        int y = (int)(i / columns) * cell + kPadding;
+        for (int row = 0; row < pixelSize; row++) {
+            std::memcpy(&packed->pixels[((size_t)(y + row) * packed->width + x) * 4],
+                        &icons[i][(size_t)row * pixelSize * 4], (size_t)pixelSize * 4);
+        }
+        Region region;
+        region.uv0 = ImVec2((float)x / packed->width, (float)y / packed->height);
+        region.uv1 = ImVec2((float)(x + pixelSize) / packed->width, (float)(y + pixelSize) / packed->height);
+        packed->regions[names[i]] = region;
+    }
+    return packed;
+}
+
+void IconAtlas::upload(const Packed& packed) {
+    if (m_texture == 0) {
+        glGenTextures(1, &m_texture);
+    }
+    glBindTexture(GL_TEXTURE_2D, m_texture);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, 0x812F);  // GL_CLAMP_TO_EDGE
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, 0x812F);
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+    glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, packed.width, packed.height, 0, GL_RGBA, GL_UNSIGNED_BYTE,
+                 packed.pixels.data());
+    glBindTexture(GL_TEXTURE_2D, 0);
+
+    m_regions = packed.regions;
+    m_textureBytes.set(packed.pixels.size());
+    BADCAD_LOG_DEBUG("Icon atlas: ", m_regions.size(), " icons, ", packed.width, "x", packed.height);
+}
+
+} // namespace badcad
@@ -0,0 +1,71 @@
+#pragma once
+
+#include "imgui.h"
+#include "../utils/memory_tracker.h"
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace badcad {
+
+// SVG toolbar icons packed into one RGBA texture, so a toolbar draws every
+// icon from a single texture in a single batch.
+//
+// Icons are registered on first lookup. update() then rasterizes the whole
+// set on a worker at the display content scale and swaps the new texture in
+// on the main thread; until then the previous atlas (or nothing) is used.
+// Rasterized icons are cached on disk keyed by the SVG's contents and pixel
+// size, so restarts and scale changes back to a known density only repack.
+class IconAtlas {
+public:
+    // Logical icon size, in ImGui units
+    explicit IconAtlas(float iconSize);
+    ~IconAtlas();
+
+    IconAtlas(const IconAtlas&) = delete;
+    IconAtlas& operator=(const IconAtlas&) = delete;
+
+    // Once per frame on the main thread: the display content scale the fonts
+    // are rasterized at, so icons change density together with the text
+    void update(float pixelScale);
+
+    // Resource name, e.g. "icons/extrude.svg". Returns false while the icon
+    // is still being rasterized or if it failed to load.
+    bool find(const std::string& name, ImVec2& uv0, ImVec2& uv1);
+
+    ImTextureID getTextureId() const { return (ImTextureID)(intptr_t)m_texture; }
+    float getIconSize() const { return m_iconSize; }
+
+private:
+    struct Region {
+        ImVec2 uv0;
+        ImVec2 uv1;
+    };
+
+    // Built on a worker, uploaded on the main thread
+    struct Packed {
+        int width = 0;
+        int height = 0;
+        std::vector<unsigned char> pixels;
+        std::unordered_map<std::string, Region> regions;
+    };
+
+    static std::shared_ptr<Packed> build(const std::vector<std::string>& names, int pixelSize);
+    void upload(const Packed& packed);
+
+    float m_iconSize;
+    float m_pixelScale = 0.0f;
+    std::vector<std::string> m_names;
+    std::unordered_map<std::string, Region> m_regions;
+    bool m_dirty = false;
+    bool m_building = false;
+
+    unsigned int m_texture = 0;
+    TrackedBytes m_textureBytes{MemoryTag::GpuBuffers};
+
+    // Cleared on destruction so a build finishing afterwards is dropped
+    std::shared_ptr<IconAtlas*> m_self;
+};
+
+} // namespace badcad
@@ -0,0 +1,59 @@
+#include "application.h"
+#include "imgui.h"
+#include "../utils/memory_tracker.h"
+
+namespace badcad {
+
+static float toMegabytes(size_t bytes) {
+    return (float)(bytes / (1024.0 * 1024.0));
+}
+
+void Application::renderMemoryPanel() {
+    ImGui::SetNextWindowSize(ImVec2(340, 0), ImGuiCond_FirstUseEver);
+    if (!ImGui::Begin("Memory (F4)", &m_memoryPanelVisible, ImGuiWindowFlags_NoSavedSettings)) {
+        ImGui::End();
+        return;
+    }
+
+    if (ImGui::BeginTable("##memory", 3, ImGuiTableFlags_SizingFixedFit | ImGuiTableFlags_RowBg)) {
+        ImGui::TableSetupColumn("Tag", ImGuiTableColumnFlags_WidthStretch);
+        ImGui::TableSetupColumn("Live MB");
+        ImGui::TableSetupColumn("Peak MB");
+        ImGui::TableHeadersRow();
+
+        for (int i = 0; i < (int)MemoryTag::Count; i++) {
+            MemoryTag tag = (MemoryTag)i;
+            ImGui::TableNextRow();
+            ImGui::TableNextColumn();
+            ImGui::TextUnformatted(MemoryTracker::getTagName(tag));
+            ImGui::TableNextColumn();
+            ImGui::Text("%.2f", toMegabytes(MemoryTracker::getLiveBytes(tag)));
+            ImGui::TableNextColumn();
+            ImGui::Text("%.2f", toMegabytes(MemoryTracker::getPeakBytes(tag)));
+        }
+        ImGui::EndTable();
+    }
+
+    ImGui::Text("Tracked total: %.2f MB", toMegabytes(MemoryTracker::getTotalLiveBytes()));
+
+    // Process RSS against the idle budget; red once it is exceeded
+    size_t resident = MemoryTracker::getProcessResidentBytes();
+    if (resident > 0) {
+        float fraction = (float)resident / (float)kIdleMemoryBudget;
+        char label[64];
+        snprintf(label, sizeof(label), "%.0f / %.0f MB", toMegabytes(resident), toMegabytes(kIdleMemoryBudget));
+
+        ImGui::TextDisabled("Process RSS (idle budget)");
+        if (fraction > 1.0f) {
+            ImGui::PushStyleColor(ImGuiCol_PlotHistogram, ImVec4(0.85f, 0.25f, 0.25f, 1.0f));
+        }
+        ImGui::ProgressBar(fraction > 1.0f ? 1.0f : fraction, ImVec2(-1, 0), label);
+        if (fraction > 1.0f) {
+            ImGui::PopStyleColor();
+        }
+    }
+
+    ImGui::End();
+}
+
+} // namespace badcad
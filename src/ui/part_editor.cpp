@@ -1,12 +1,21 @@
 #include "part_editor.h"
 #include "application.h"
 #include "file_dialog.h"
+#include "icon_atlas.h"
+#include "properties_panel.h"
+#include "sweep_editor.h"
 #include "../core/document.h"
+#include "../importexport/mesh_exporter.h"
+#include "../importexport/step_importer.h"
 #include "../render/occ_viewer.h"
+#include "../utils/log.h"
+#include "../utils/job.h"
+#include "../utils/trace.h"
 #include <imgui.h>
-#include <iostream>
+#include <filesystem>
 #include <fstream>
 #include <algorithm>
+#include <cctype>
 #include <GLFW/glfw3.h>
 
 #ifdef _WIN32
@@ -16,10 +25,16 @@
 
 namespace badcad {
 
+// Toolbar icon size inside the 32x32 buttons
+constexpr float kToolbarIconSize = 20.0f;
+
 PartEditor::PartEditor(Application* app) 
     : m_app(app)
     , m_document(std::make_unique<Document>())
     , m_viewer(nullptr)  // Lazy initialization when viewport is first rendered
+    , m_sweepEditor(std::make_unique<SweepEditor>())
+    , m_propertiesPanel(std::make_unique<PropertiesPanel>())
+    , m_icons(std::make_unique<IconAtlas>(kToolbarIconSize))
 {
 }
 
@@ -27,7 +42,9 @@ PartEditor::~PartEditor() {
 }
 
 void PartEditor::render() {
+    BADCAD_TRACE_SCOPE("PartEditor::render");
     ImGuiIO& io = ImGui::GetIO();
+    m_icons->update(m_app->getFontScale());
     
     // Handle keyboard shortcuts
     if (io.KeyCtrl && ImGui::IsKeyPressed(ImGuiKey_S)) {
@@ -72,6 +89,9 @@ void PartEditor::render() {
             if (ImGui::MenuItem("Open", "Ctrl+O")) {
                 openFile();
             }
+            if (ImGui::MenuItem("Export Mesh...", nullptr, false, !m_propertiesPanel->getShape().IsNull())) {
+                exportSelectedMesh();
+            }
             ImGui::Separator();
             if (ImGui::MenuItem("Close", "Ctrl+W")) {
                 m_app->setState(AppState::Home);
@@ -97,6 +117,12 @@ void PartEditor::render() {
         ImGuiWindowFlags_NoMove |
         ImGuiWindowFlags_NoScrollbar);
     
+    // Button frames go to channel 0 and icons to channel 1, so after merging
+    // all icons are one draw call on the icon atlas
+    ImDrawList* toolbarDrawList = ImGui::GetWindowDrawList();
+    toolbarDrawList->ChannelsSplit(2);
+    m_iconLayerActive = true;
+    
     switch (m_mode) {
         case PartEditorMode::Model:
             renderModelToolbar();
@@ -110,6 +136,8 @@ void PartEditor::render() {
             break;
     }
     
+    m_iconLayerActive = false;
+    toolbarDrawList->ChannelsMerge();
     ImGui::End();
     ImGui::PopStyleVar();
     
@@ -145,6 +173,10 @@ void PartEditor::render() {
         
         ImGui::End();
     }
+    if (!m_showProperties && m_sweepEditor->isActive()) {
+        // Closing the panel discards the edit along with its controls
+        m_sweepEditor->cancel();
+    }
     
     // Constraints panel (right panel in sketch mode)
     if (m_mode == PartEditorMode::Sketch && m_showConstraints) {
@@ -194,6 +226,8 @@ void PartEditor::render() {
     ImGui::Text("Mode: %s", m_mode == PartEditorMode::Model ? "Model" : 
                             m_mode == PartEditorMode::Sketch ? "Sketch" : "Inspect");
     
+    renderJobStatus();
+    
     // Update and display status message
     if (m_statusMessageTime > 0.0f) {
         m_statusMessageTime -= io.DeltaTime;
@@ -215,14 +249,59 @@ void PartEditor::render() {
     promptSaveChanges();
 }
 
+void PartEditor::renderJobStatus() {
+    // One progress bar and cancel button per running job
+    for (const JobHandle& job : JobManager::instance().getActiveJobs()) {
+        ImGui::PushID(job.get());
+        ImGui::SameLine(0, 24);
+        
+        std::string status = job->getStatusText();
+        ImGui::Text("%s%s%s", job->getName().c_str(), status.empty() ? "" : " - ", status.c_str());
+        ImGui::SameLine();
+        
+        float progress = job->getProgress();
+        if (progress >= 0.0f) {
+            ImGui::ProgressBar(std::min(progress, 1.0f), ImVec2(120, 0));
+        } else {
+            // Unknown total: animate a sliding bar instead of a percentage
+            ImGui::ProgressBar(-1.0f * (float)ImGui::GetTime(), ImVec2(120, 0), "");
+        }
+        ImGui::SameLine();
+        
+        ImGui::BeginDisabled(job->isCancelled());
+        if (ImGui::SmallButton("Cancel")) {
+            job->cancel();
+        }
+        ImGui::EndDisabled();
+        
+        ImGui::PopID();
+    }
+}
+
 bool PartEditor::iconButton(const char* icon, const char* tooltip, const char* svgPath) {
-    // TODO: Load SVG from svgPath if provided and exists
-    // For now, use emoji fallback
+    // Letter fallback until the atlas has the icon (or if the SVG is missing)
+    ImVec2 uv0, uv1;
+    bool hasIcon = svgPath && m_icons->find(svgPath, uv0, uv1);
     
     ImGui::PushStyleVar(ImGuiStyleVar_FramePadding, ImVec2(8, 8));
-    bool clicked = ImGui::Button(icon, ImVec2(32, 32));
+    bool clicked = ImGui::Button(hasIcon ? "##icon" : icon, ImVec2(32, 32));
     ImGui::PopStyleVar();
     
+    if (hasIcon) {
+        ImDrawList* drawList = ImGui::GetWindowDrawList();
+        ImVec2 min = ImGui::GetItemRectMin();
+        ImVec2 max = ImGui::GetItemRectMax();
+        float size = m_icons->getIconSize();
+        ImVec2 iconMin((min.x + max.x - size) * 0.5f, (min.y + max.y - size) * 0.5f);
+        if (m_iconLayerActive) {
+            drawList->ChannelsSetCurrent(1);
+        }
+        drawList->AddImage(m_icons->getTextureId(), iconMin, ImVec2(iconMin.x + size, iconMin.y + size), uv0, uv1);
+        if (m_iconLayerActive) {
+            drawList->ChannelsSetCurrent(0);
+        }
+    }
+    
     if (ImGui::IsItemHovered()) {
         ImGui::SetTooltip("%s", tooltip);
     }
@@ -233,7 +312,7 @@ bool PartEditor::iconButton(const char* icon, const char* tooltip, const char* s
 void PartEditor::renderModelToolbar() {
     // Model mode tools
     ImGui::PushID("newsketch");
-    if (iconButton("X", "New Sketch", "resources/icons/new_sketch.svg")) {
+    if (iconButton("X", "New Sketch", "icons/new_sketch.svg")) {
         std::string selectedPlane = m_document->getSelectedPlane();
         if (!selectedPlane.empty()) {
             // Create new sketch on selected plane
@@ -255,49 +334,51 @@ void PartEditor::renderModelToolbar() {
     ImGui::SameLine(0, 4);
     
     ImGui::PushID("extrude");
-    if (iconButton("X", "Extrude", "resources/icons/extrude.svg")) {
+    if (iconButton("X", "Extrude", "icons/extrude.svg")) {
+        beginSweep(SweepKind::Extrude);
     }
     ImGui::PopID();
     ImGui::SameLine(0, 4);
     
     ImGui::PushID("revolve");
-    if (iconButton("X", "Revolve", "resources/icons/revolve.svg")) {
+    if (iconButton("X", "Revolve", "icons/revolve.svg")) {
+        beginSweep(SweepKind::Revolve);
     }
     ImGui::PopID();
     ImGui::SameLine(0, 4);
     
     ImGui::PushID("sweep");
-    if (iconButton("X", "Sweep", "resources/icons/sweep.svg")) {
+    if (iconButton("X", "Sweep", "icons/sweep.svg")) {
     }
     ImGui::PopID();
     ImGui::SameLine(0, 4);
     
     ImGui::PushID("loft");
-    if (iconButton("X", "Loft", "resources/icons/loft.svg")) {
+    if (iconButton("X", "Loft", "icons/loft.svg")) {
     }
     ImGui::PopID();
     ImGui::SameLine(0, 4);
     
     ImGui::PushID("boolean");
-    if (iconButton("X", "Boolean", "resources/icons/boolean.svg")) {
+    if (iconButton("X", "Boolean", "icons/boolean.svg")) {
     }
     ImGui::PopID();
     ImGui::SameLine(0, 4);
     
     ImGui::PushID("fillet");
-    if (iconButton("X", "Fillet", "resources/icons/fillet.svg")) {
+    if (iconButton("X", "Fillet", "icons/fillet.svg")) {
     }
     ImGui::PopID();
     ImGui::SameLine(0, 4);
     
     ImGui::PushID("chamfer");
-    if (iconButton("X", "Chamfer", "resources/icons/chamfer.svg")) {
+    if (iconButton("X", "Chamfer", "icons/chamfer.svg")) {
     }
     ImGui::PopID();
     ImGui::SameLine(0, 4);
     
     ImGui::PushID("shell");
-    if (iconButton("X", "Shell", "resources/icons/shell.svg")) {
+    if (iconButton("X", "Shell", "icons/shell.svg")) {
     }
     ImGui::PopID();
 }
@@ -309,7 +390,7 @@ void PartEditor::renderSketchToolbar() {
     if (isPointActive) {
         ImGui::PushStyleColor(ImGuiCol_Button, ImVec4(0.3f, 0.5f, 0.8f, 1.0f));
     }
-    if (iconButton("X", "Point", "resources/icons/point.svg")) {
+    if (iconButton("X", "Point", "icons/point.svg")) {
         m_activeTool = SketchTool::Point;
         m_lineStartPointIndex = -1;  // Reset line drawing state
         m_statusMessage = "Point tool active - Click to place points";
@@ -326,7 +407,7 @@ void PartEditor::renderSketchToolbar() {
     if (isLineActive) {
         ImGui::PushStyleColor(ImGuiCol_Button, ImVec4(0.3f, 0.5f, 0.8f, 1.0f));
     }
-    if (iconButton("X", "Line", "resources/icons/line.svg")) {
+    if (iconButton("X", "Line", "icons/line.svg")) {
         m_activeTool = SketchTool::Line;
         m_lineStartPointIndex = -1;  // Reset line drawing state
         m_statusMessage = "Line tool active - Click to start line";
@@ -339,56 +420,56 @@ void PartEditor::renderSketchToolbar() {
     ImGui::SameLine(0, 4);
     
     ImGui::PushID("arc");
-    if (iconButton("X", "Arc", "resources/icons/arc.svg")) {
+    if (iconButton("X", "Arc", "icons/arc.svg")) {
     }
     ImGui::PopID();
     ImGui::SameLine(0, 4);
     
     ImGui::PushID("circle");
-    if (iconButton("X", "Circle", "resources/icons/circle.svg")) {
+    if (iconButton("X", "Circle", "icons/circle.svg")) {
     }
     ImGui::PopID();
     ImGui::SameLine(0, 4);
     
     ImGui::PushID("rect");
-    if (iconButton("X", "Rectangle", "resources/icons/rectangle.svg")) {
+    if (iconButton("X", "Rectangle", "icons/rectangle.svg")) {
     }
     ImGui::PopID();
     ImGui::SameLine(0, 4);
     
     ImGui::PushID("spline");
-    if (iconButton("X", "Spline", "resources/icons/spline.svg")) {
+    if (iconButton("X", "Spline", "icons/spline.svg")) {
     }
     ImGui::PopID();
     ImGui::SameLine(0, 4);
     
     // Constraint tools
     ImGui::PushID("coincident");
-    if (iconButton("X", "Coincident", "resources/icons/coincident.svg")) {
+    if (iconButton("X", "Coincident", "icons/coincident.svg")) {
     }
     ImGui::PopID();
     ImGui::SameLine(0, 4);
     
     ImGui::PushID("tangent");
-    if (iconButton("X", "Tangent", "resources/icons/tangent.svg")) {
+    if (iconButton("X", "Tangent", "icons/tangent.svg")) {
     }
     ImGui::PopID();
     ImGui::SameLine(0, 4);
     
     ImGui::PushID("perp");
-    if (iconButton("X", "Perpendicular", "resources/icons/perpendicular.svg")) {
+    if (iconButton("X", "Perpendicular", "icons/perpendicular.svg")) {
     }
     ImGui::PopID();
     ImGui::SameLine(0, 4);
     
     ImGui::PushID("parallel");
-    if (iconButton("X", "Parallel", "resources/icons/parallel.svg")) {
+    if (iconButton("X", "Parallel", "icons/parallel.svg")) {
     }
     ImGui::PopID();
     ImGui::SameLine(0, 4);
     
     ImGui::PushID("dimension");
-    if (iconButton("X", "Dimension", "resources/icons/dimension.svg")) {
+    if (iconButton("X", "Dimension", "icons/dimension.svg")) {
     }
     ImGui::PopID();
     ImGui::SameLine(0, 4);
@@ -396,7 +477,7 @@ void PartEditor::renderSketchToolbar() {
     ImGui::SameLine(0, 4);
     ImGui::PushStyleColor(ImGuiCol_Button, ImVec4(0.2f, 0.6f, 0.3f, 1.0f));
     ImGui::PushID("exit");
-    if (iconButton("X", "Exit Sketch", "resources/icons/exit_sketch.svg")) {
+    if (iconButton("X", "Exit Sketch", "icons/exit_sketch.svg")) {
         // Clear editing flag on active sketch
         auto* activeSketch = m_document->getActiveSketch();
         if (activeSketch) {
@@ -537,15 +618,23 @@ void PartEditor::renderViewport() {
         m_viewer = std::make_unique<OccViewer>();
         
 #ifdef _WIN32
-        HWND hwnd = glfwGetWin32Window(glfwWindow);
+        void* nativeHandle = glfwGetWin32Window(glfwWindow);
+#else
+        // The viewer only draws into its own FBO, no native window is needed
+        void* nativeHandle = nullptr;
+#endif
         
-        if (m_viewer->init(hwnd, (int)viewportSize.x, (int)viewportSize.y)) {
+        if (m_viewer->init(nativeHandle, (int)viewportSize.x, (int)viewportSize.y)) {
             m_viewer->setDocument(m_document.get());
+            m_viewer->setProfiler(&m_app->getProfiler());
+            m_viewer->addPartMeshes(m_importedMeshes);
+            // Draw on a separate thread so slow frames don't stall the UI;
+            // falls back to synchronous rendering if unsupported
+            m_viewer->startRenderThread(glfwWindow);
         } else {
-            std::cerr << "Failed to initialize OpenCASCADE viewer" << std::endl;
+            BADCAD_LOG_ERROR("Failed to initialize OpenCASCADE viewer");
             m_viewer.reset();
         }
-#endif
     }
     
     // Update viewer size if changed (with threshold to avoid constant recreation)
@@ -555,6 +644,12 @@ void PartEditor::renderViewport() {
         ImGuiIO& io = ImGui::GetIO();
         m_viewer->updateCameraAnimation(io.DeltaTime);
         
+        // Drop to fast preview while orbiting/panning/zooming, refine on release or idle
+        if (ImGui::IsMouseReleased(ImGuiMouseButton_Middle)) {
+            m_viewer->endInteraction();
+        }
+        m_viewer->updateInteraction(io.DeltaTime);
+        
         // Only resize if the change is significant (more than 10 pixels)
         float deltaX = std::abs(viewportSize.x - lastSize.x);
         float deltaY = std::abs(viewportSize.y - lastSize.y);
@@ -583,7 +678,11 @@ void PartEditor::renderViewport() {
             if (texId != lastTexId) {
                 lastTexId = texId;
             }
-            ImGui::Image((ImTextureID)(intptr_t)texId, viewportSize, ImVec2(0, 1), ImVec2(1, 0));
+            // Preview frames cover only part of the texture; stretch that part over the viewport
+            float extentU, extentV;
+            m_viewer->getTextureExtent(extentU, extentV);
+            ImGui::Image((ImTextureID)(intptr_t)texId, viewportSize, ImVec2(0, extentV), ImVec2(extentU, 0));
+            ImVec2 imageMin = ImGui::GetItemRectMin();
             
             // Handle mouse interaction in viewport
             if (ImGui::IsItemHovered()) {
@@ -753,6 +852,23 @@ void PartEditor::renderViewport() {
                 m_hasMousePreview = false;
             }
             
+            // Hover highlight is composited on top of the cached frame so that
+            // moving the mouse doesn't force the 3D pass to run again
+            float outline[8];
+            if (m_viewer->getHoveredPlaneOutline(outline)) {
+                ImVec2 corners[4];
+                for (int i = 0; i < 4; i++) {
+                    corners[i] = ImVec2(imageMin.x + outline[i * 2] * viewportSize.x,
+                                        imageMin.y + outline[i * 2 + 1] * viewportSize.y);
+                }
+                ImDrawList* overlay = ImGui::GetWindowDrawList();
+                overlay->AddConvexPolyFilled(corners, 4, IM_COL32(204, 115, 0, 51));  // Darker orange for hover
+                overlay->AddPolyline(corners, 4, IM_COL32(204, 115, 0, 204), ImDrawFlags_Closed, 4.0f);
+            }
+            
+            // Frame timings in the top-right corner of the viewport (F3)
+            m_app->getProfiler().drawOverlay(imageMin.x + viewportSize.x, imageMin.y);
+            
             // Overlay info text
             ImDrawList* draw_list = ImGui::GetForegroundDrawList();
             ImVec2 p = ImGui::GetCursorScreenPos();
@@ -779,10 +895,34 @@ void PartEditor::renderViewport() {
     }
 }
 
+void PartEditor::beginSweep(SweepKind kind) {
+    if (!m_sweepEditor->begin(kind, m_viewer.get())) {
+        m_statusMessage = "Exit a sketch with a closed profile first";
+        m_statusMessageTime = 5.0f;
+        return;
+    }
+    m_showProperties = true;
+}
+
 void PartEditor::renderPropertiesPanel() {
-    ImGui::Text("Properties");
-    ImGui::Separator();
-    ImGui::TextDisabled("No selection");
+    if (m_sweepEditor->isActive()) {
+        m_sweepEditor->renderControls([this](SweepKind kind, const SweepResult& result) {
+            const char* name = (kind == SweepKind::Extrude) ? "Extrude" : "Revolve";
+            // The document has no bodies yet, so the result is shown and
+            // measured but not saved; the part is unchanged
+            if (result.isDone()) {
+                m_propertiesPanel->setSelection(result.shape, name);
+                m_statusMessage = std::string(name) + " built in " + std::to_string((int)result.elapsedMs) +
+                                  " ms (preview only, not saved)";
+            } else {
+                m_statusMessage = std::string(name) + " failed: " + result.error;
+            }
+            m_statusMessageTime = 3.0f;
+        });
+        return;
+    }
+    
+    m_propertiesPanel->render();
 }
 
 void PartEditor::renderConstraintsPanel() {
@@ -792,7 +932,7 @@ void PartEditor::renderConstraintsPanel() {
 }
 
 // File operations
-std::string PartEditor::openFileDialog(bool save) {
+std::string PartEditor::openFileDialog(FileDialogType type) {
 #ifdef _WIN32
     HWND hwnd = nullptr;
     if (m_app) {
@@ -801,80 +941,237 @@ std::string PartEditor::openFileDialog(bool save) {
             hwnd = glfwGetWin32Window(window);
         }
     }
-    return badcad::openFileDialog(save, hwnd);
+    return badcad::openFileDialog(type, hwnd);
 #else
     return "";
 #endif
 }
 
-void PartEditor::saveFile(const std::string& path) {
+static std::string fileNameOf(const std::string& path) {
+    size_t lastSlash = path.find_last_of("/\\");
+    return (lastSlash != std::string::npos) ? path.substr(lastSlash + 1) : path;
+}
+
+void PartEditor::setCurrentFile(const std::string& path) {
+    m_currentFilePath = path;
+    m_hasUnsavedChanges = false;
+    
+    // Update window title with filename
+    m_app->setWindowTitle("badCAD - " + fileNameOf(path));
+}
+
+// Files are moved in chunks so jobs can report progress and notice cancellation
+static constexpr size_t kFileChunkSize = 256 * 1024;
+
+void PartEditor::saveFile(const std::string& path, std::function<void()> onSaved) {
     if (path.empty()) {
         return;
     }
     
-    std::string data = m_document->serialize();
-    std::ofstream file(path);
-    if (file.is_open()) {
-        file << data;
+    // Serialize here so the worker writes a consistent snapshot while editing continues.
+    // Writing goes to a temporary file that only replaces the target when complete,
+    // so a cancelled or failed save never leaves a truncated part behind.
+    auto data = std::make_shared<std::string>(m_document->serialize());
+    
+    JobManager::instance().start("Saving " + fileNameOf(path), [path, data](Job& job) {
+        BADCAD_TRACE_SCOPE_CAT("PartEditor::saveFile write", "io");
+        std::string tempPath = path + ".tmp";
+        std::ofstream file(tempPath, std::ios::binary);
+        if (!file.is_open()) {
+            return false;
+        }
+        for (size_t offset = 0; offset < data->size(); offset += kFileChunkSize) {
+            if (job.isCancelled()) {
+                break;
+            }
+            file.write(data->data() + offset, std::min(kFileChunkSize, data->size() - offset));
+            job.setProgress((float)(offset + kFileChunkSize) / data->size());
+        }
         file.close();
-        m_currentFilePath = path;
-        m_hasUnsavedChanges = false;
-        
-        // Update window title with filename
-        size_t lastSlash = path.find_last_of("/\\");
-        std::string filename = (lastSlash != std::string::npos) ? path.substr(lastSlash + 1) : path;
-        m_app->setWindowTitle("badCAD - " + filename);
         
-        m_statusMessage = "File saved: " + filename;
-        m_statusMessageTime = 3.0f;
-        
-    } else {
-        std::cerr << "Failed to save file: " << path << std::endl;
-        m_statusMessage = "ERROR: Failed to save file";
-        m_statusMessageTime = 5.0f;
-    }
+        std::error_code ec;
+        if (job.isCancelled() || file.fail()) {
+            std::filesystem::remove(tempPath, ec);
+            return false;
+        }
+        std::filesystem::rename(tempPath, path, ec);
+        return !ec;
+    }, [this, path, onSaved](Job& job) {
+        if (job.getState() == JobState::Succeeded) {
+            setCurrentFile(path);
+            m_statusMessage = "File saved: " + fileNameOf(path);
+            m_statusMessageTime = 3.0f;
+            if (onSaved) {
+                onSaved();
+            }
+        } else if (job.getState() == JobState::Cancelled) {
+            m_statusMessage = "Save cancelled";
+            m_statusMessageTime = 3.0f;
+        } else {
+            BADCAD_LOG_ERROR("Failed to save file: ", path);
+            m_statusMessage = "ERROR: Failed to save file";
+            m_statusMessageTime = 5.0f;
+        }
+    });
 }
 
-void PartEditor::saveFileAs() {
-    std::string path = openFileDialog(true);
+void PartEditor::saveFileAs(std::function<void()> onSaved) {
+    std::string path = openFileDialog(FileDialogType::Save);
     if (!path.empty()) {
-        saveFile(path);
+        saveFile(path, std::move(onSaved));
     }
 }
 
 void PartEditor::openFile() {
-    std::string path = openFileDialog(false);
-    if (!path.empty()) {
-        std::ifstream file(path);
-        if (file.is_open()) {
-            std::string data((std::istreambuf_iterator<char>(file)),
-                           std::istreambuf_iterator<char>());
-            file.close();
-            
-            m_document->deserialize(data);
-            m_currentFilePath = path;
-            m_hasUnsavedChanges = false;
-            
-            // Refresh viewer
-            if (m_viewer) {
-                m_viewer->setDocument(m_document.get());
-                m_viewer->updateFromDocument();
+    std::string path = openFileDialog(FileDialogType::Open);
+    if (path.empty()) {
+        return;
+    }
+    
+    std::string extension = std::filesystem::path(path).extension().string();
+    std::transform(extension.begin(), extension.end(), extension.begin(),
+                   [](unsigned char c) { return (char)std::tolower(c); });
+    if (extension == ".step" || extension == ".stp") {
+        importStepFile(path);
+        return;
+    }
+    
+    // Read and parse on a worker; the finished document is swapped in on the main thread
+    auto loaded = std::make_shared<std::unique_ptr<Document>>();
+    
+    JobManager::instance().start("Opening " + fileNameOf(path), [path, loaded](Job& job) {
+        std::string data;
+        {
+            BADCAD_TRACE_SCOPE_CAT("PartEditor::openFile read", "io");
+            std::ifstream file(path, std::ios::binary | std::ios::ate);
+            if (!file.is_open()) {
+                return false;
             }
+            size_t size = (size_t)file.tellg();
+            file.seekg(0);
+            data.resize(size);
             
-            // Update window title with filename
-            size_t lastSlash = path.find_last_of("/\\");
-            std::string filename = (lastSlash != std::string::npos) ? path.substr(lastSlash + 1) : path;
-            m_app->setWindowTitle("badCAD - " + filename);
-            
-            m_statusMessage = "File loaded: " + filename;
+            // Reading is most of the work; parsing takes the last 10%
+            job.setStatusText("Reading");
+            for (size_t offset = 0; offset < size; offset += kFileChunkSize) {
+                if (job.isCancelled()) {
+                    return false;
+                }
+                file.read(&data[offset], std::min(kFileChunkSize, size - offset));
+                job.setProgress(0.9f * (offset + kFileChunkSize) / size);
+            }
+            if (file.fail()) {
+                return false;
+            }
+        }
+        
+        job.setStatusText("Parsing");
+        auto document = std::make_unique<Document>();
+        if (!document->deserialize(data) || job.isCancelled()) {
+            return false;
+        }
+        *loaded = std::move(document);
+        return true;
+    }, [this, path, loaded](Job& job) {
+        if (job.getState() == JobState::Cancelled) {
+            m_statusMessage = "Open cancelled";
             m_statusMessageTime = 3.0f;
-            
-        } else {
-            std::cerr << "Failed to open file: " << path << std::endl;
+            return;
+        }
+        if (job.getState() != JobState::Succeeded) {
+            BADCAD_LOG_ERROR("Failed to open file: ", path);
             m_statusMessage = "ERROR: Failed to open file";
             m_statusMessageTime = 5.0f;
+            return;
+        }
+        
+        m_document = std::move(*loaded);
+        m_hasUnsavedChanges = false;
+        
+        // Refresh viewer
+        if (m_viewer) {
+            m_viewer->setDocument(m_document.get());
+            m_viewer->updateFromDocument();
+        }
+        
+        setCurrentFile(path);
+        m_statusMessage = "File loaded: " + fileNameOf(path);
+        m_statusMessageTime = 3.0f;
+    }, TaskPriority::Interactive);
+}
+
+void PartEditor::importStepFile(const std::string& path) {
+    if (m_importJob) {
+        m_importJob->cancel();
+    }
+    uint64_t generation = ++m_importGeneration;
+    m_importedMeshes.clear();
+    if (m_viewer) {
+        m_viewer->clearPartMeshes();
+    }
+    
+    m_importJob = importStep(path, StepImportOptions(), [this, generation](const ImportedPart& part) {
+        if (generation != m_importGeneration || !part.mesh) {
+            return;
+        }
+        m_importedMeshes.push_back(part.mesh);
+        if (m_viewer) {
+            m_viewer->addPartMesh(part.mesh);
+        }
+    }, [this, path, generation](Job& job, const StepImportSummary& summary) {
+        if (generation != m_importGeneration) {
+            return;
+        }
+        m_importJob.reset();
+        if (job.getState() == JobState::Cancelled) {
+            m_statusMessage = "Import cancelled";
+            m_statusMessageTime = 3.0f;
+        } else if (job.getState() != JobState::Succeeded) {
+            BADCAD_LOG_ERROR("Failed to import ", path, ": ", job.getError());
+            m_statusMessage = "ERROR: Failed to import " + fileNameOf(path);
+            m_statusMessageTime = 5.0f;
+        } else {
+            m_statusMessage = "Imported " + std::to_string(summary.partCount) + " parts from " + fileNameOf(path) +
+                              " in " + std::to_string((int)summary.elapsedMs) + " ms";
+            if (summary.invalidCount > 0) {
+                m_statusMessage += " (" + std::to_string(summary.invalidCount) + " invalid)";
+            }
+            m_statusMessageTime = 5.0f;
         }
+    });
+}
+
+void PartEditor::exportSelectedMesh() {
+    TopoDS_Shape shape = m_propertiesPanel->getShape();
+    if (shape.IsNull()) {
+        return;
+    }
+    std::string path = openFileDialog(FileDialogType::ExportMesh);
+    if (path.empty()) {
+        return;
     }
+
+    MeshExportOptions options;
+    if (!getMeshFormat(path, options.format)) {
+        m_statusMessage = "ERROR: Export to an .stl or .obj file";
+        m_statusMessageTime = 5.0f;
+        return;
+    }
+
+    exportMesh(shape, path, options, [this, path](Job& job, const MeshExportSummary& summary) {
+        if (job.getState() == JobState::Cancelled) {
+            m_statusMessage = "Export cancelled";
+            m_statusMessageTime = 3.0f;
+        } else if (job.getState() != JobState::Succeeded) {
+            BADCAD_LOG_ERROR("Failed to export ", path, ": ", job.getError());
+            m_statusMessage = "ERROR: Failed to export " + fileNameOf(path);
+            m_statusMessageTime = 5.0f;
+        } else {
+            m_statusMessage = "Exported to " + fileNameOf(path) + " (" + std::to_string(summary.triangleCount) +
+                              " triangles, " + std::to_string((int)summary.elapsedMs) + " ms)";
+            m_statusMessageTime = 5.0f;
+        }
+    });
 }
 
 void PartEditor::newPart() {
@@ -903,15 +1200,14 @@ bool PartEditor::promptSaveChanges() {
         ImGui::Separator();
         
         if (ImGui::Button("Save", ImVec2(120, 0))) {
+            // The document is only reset once the background save succeeds
+            auto onSaved = [this]() { resetDocument(); };
             if (m_currentFilePath.empty()) {
-                saveFileAs();
+                saveFileAs(onSaved);
             } else {
-                saveFile(m_currentFilePath);
-            }
-            if (!m_hasUnsavedChanges) {  // Save was successful
-                resetDocument();
-                m_showSavePrompt = false;
+                saveFile(m_currentFilePath, onSaved);
             }
+            m_showSavePrompt = false;
             ImGui::CloseCurrentPopup();
         }
         ImGui::SameLine();
@@ -943,10 +1239,21 @@ void PartEditor::resetDocument() {
     m_mode = PartEditorMode::Model;
     m_activeTool = SketchTool::None;
     m_lineStartPointIndex = -1;  // Reset line drawing state
+    m_sweepEditor->cancel();
+    m_propertiesPanel->clearSelection();
+    
+    // Imported parts belong to the old part
+    if (m_importJob) {
+        m_importJob->cancel();
+        m_importJob.reset();
+    }
+    m_importGeneration++;
+    m_importedMeshes.clear();
     
     // Refresh viewer with new document
     if (m_viewer) {
         m_viewer->setDocument(m_document.get());
+        m_viewer->clearPartMeshes();
     }
     
     // Update window title
@@ -1,13 +1,23 @@
 #pragma once
 
+#include <functional>
+#include <cstdint>
 #include <memory>
 #include <string>
+#include <vector>
 
 namespace badcad {
 
 // Forward declarations
 class Document;
+enum class FileDialogType;
+class IconAtlas;
+class Job;
+struct MeshBuffers;
 class OccViewer;
+class PropertiesPanel;
+class SweepEditor;
+enum class SweepKind;
 
 enum class PartEditorMode {
     Model,
@@ -35,20 +45,29 @@ private:
     void renderSketchToolbar();
     void renderViewToolbar();
     
-    // Helper for icon buttons
+    // Helper for icon buttons; svgPath is a resource name such as "icons/extrude.svg"
     bool iconButton(const char* icon, const char* tooltip, const char* svgPath = nullptr);
     void renderFeatureTree();
     void renderViewport();
     void renderPropertiesPanel();
+    void beginSweep(SweepKind kind);
     void renderConstraintsPanel();
+    void renderJobStatus();
     
     // File operations
     void newPart();
-    void saveFile(const std::string& path);
-    void saveFileAs();
-    std::string openFileDialog(bool save);
+    // Saving runs as a background job; onSaved is called on the main thread
+    // only if the file was written
+    void saveFile(const std::string& path, std::function<void()> onSaved = nullptr);
+    void saveFileAs(std::function<void()> onSaved = nullptr);
+    std::string openFileDialog(FileDialogType type);
+    // Adds the file's solids to the viewer as they finish; the document is kept
+    void importStepFile(const std::string& path);
+    // Writes the body selected in the Properties panel as STL or OBJ
+    void exportSelectedMesh();
     bool promptSaveChanges();
     void resetDocument();
+    void setCurrentFile(const std::string& path);
     
     Application* m_app;
     PartEditorMode m_mode = PartEditorMode::Model;
@@ -91,6 +110,21 @@ private:
     
     std::unique_ptr<Document> m_document;
     std::unique_ptr<OccViewer> m_viewer;
+    
+    // Extrude/revolve being edited, shown in the Properties panel
+    std::unique_ptr<SweepEditor> m_sweepEditor;
+    std::unique_ptr<PropertiesPanel> m_propertiesPanel;
+    
+    // Running STEP import and the meshes of parts imported so far, kept here
+    // as well since the viewer may not exist yet. Parts of an import that
+    // was superseded carry an older generation and are dropped.
+    std::shared_ptr<Job> m_importJob;
+    uint64_t m_importGeneration = 0;
+    std::vector<std::shared_ptr<const MeshBuffers>> m_importedMeshes;
+    
+    // Toolbar icons; m_iconLayerActive while the toolbar's draw list is split
+    std::unique_ptr<IconAtlas> m_icons;
+    bool m_iconLayerActive = false;
 };
 
 } // namespace badcad
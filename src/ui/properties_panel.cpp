@@ -0,0 +1,88 @@
+#include "properties_panel.h"
+#include "../geometry/shape_properties.h"
+#include <imgui.h>
+
+namespace badcad {
+
+namespace {
+
+// Label in the first column; false (with a placeholder as the value) while
+// the stage providing the value is still running
+bool beginRow(const char* label, bool ready) {
+    ImGui::TableNextRow();
+    ImGui::TableNextColumn();
+    ImGui::TextUnformatted(label);
+    ImGui::TableNextColumn();
+    if (!ready) {
+        ImGui::TextDisabled("computing...");
+    }
+    return ready;
+}
+
+} // namespace
+
+void PropertiesPanel::setSelection(const TopoDS_Shape& shape, const std::string& name) {
+    m_shape = shape;
+    m_name = name;
+}
+
+void PropertiesPanel::clearSelection() {
+    m_shape.Nullify();
+    m_name.clear();
+}
+
+void PropertiesPanel::render() {
+    ImGui::Text("Properties");
+    ImGui::Separator();
+    if (m_shape.IsNull()) {
+        ImGui::TextDisabled("No selection");
+        return;
+    }
+    ImGui::TextUnformatted(m_name.c_str());
+
+    // Polled every frame; returns at once with whatever stages are done
+    std::shared_ptr<const ShapeProperties> properties = ShapePropertiesService::instance().request(m_shape);
+    const ShapeProperties& p = *properties;
+
+    if (ImGui::BeginTable("##properties", 2, ImGuiTableFlags_SizingFixedFit | ImGuiTableFlags_RowBg)) {
+        ImGui::TableSetupColumn("Property");
+        ImGui::TableSetupColumn("Value", ImGuiTableColumnFlags_WidthStretch);
+
+        if (beginRow("Size", p.hasBounds)) {
+            if (p.box.IsVoid()) {
+                ImGui::TextDisabled("empty");
+            } else {
+                double xMin, yMin, zMin, xMax, yMax, zMax;
+                p.box.Get(xMin, yMin, zMin, xMax, yMax, zMax);
+                ImGui::Text("%.4g x %.4g x %.4g", xMax - xMin, yMax - yMin, zMax - zMin);
+            }
+        }
+        if (beginRow("Oriented size", p.hasBounds)) {
+            if (p.orientedBox.IsVoid()) {
+                ImGui::TextDisabled("empty");
+            } else {
+                ImGui::Text("%.4g x %.4g x %.4g", 2.0 * p.orientedBox.XHSize(), 2.0 * p.orientedBox.YHSize(),
+                            2.0 * p.orientedBox.ZHSize());
+            }
+        }
+        if (beginRow("Area", p.hasArea)) {
+            ImGui::Text("%.6g", p.area);
+        }
+        if (beginRow("Volume", p.hasVolume)) {
+            ImGui::Text("%.6g", p.volume);
+        }
+        if (beginRow("Centroid", p.hasVolume)) {
+            ImGui::Text("%.4g, %.4g, %.4g", p.centroid.X(), p.centroid.Y(), p.centroid.Z());
+        }
+        if (beginRow("Principal inertia", p.hasVolume)) {
+            ImGui::Text("%.4g, %.4g, %.4g", p.principalMoments[0], p.principalMoments[1], p.principalMoments[2]);
+        }
+        ImGui::EndTable();
+    }
+
+    if (!p.error.empty()) {
+        ImGui::TextColored(ImVec4(0.9f, 0.4f, 0.3f, 1.0f), "%s", p.error.c_str());
+    }
+}
+
+} // namespace badcad
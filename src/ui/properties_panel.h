@@ -0,0 +1,25 @@
+#pragma once
+
+#include <string>
+#include <TopoDS_Shape.hxx>
+
+namespace badcad {
+
+// Contents of the Properties panel for the selected body. Bounds, area,
+// volume and inertia come from ShapePropertiesService and appear one after
+// another as their background tasks finish; nothing is computed until the
+// panel is actually shown.
+class PropertiesPanel {
+public:
+    void setSelection(const TopoDS_Shape& shape, const std::string& name);
+    void clearSelection();
+    const TopoDS_Shape& getShape() const { return m_shape; }
+
+    void render();
+
+private:
+    TopoDS_Shape m_shape;
+    std::string m_name;
+};
+
+} // namespace badcad
@@ -0,0 +1,192 @@
+#include "sweep_editor.h"
+#include "../render/occ_viewer.h"
+#include "../render/sweep_preview.h"
+#include "../render/tessellator.h"
+#include "../utils/job.h"
+#include "../utils/log.h"
+#include "../utils/task_scheduler.h"
+#include <imgui.h>
+#include <array>
+
+#include <gp_Ax1.hxx>
+#include <gp_Vec.hxx>
+
+namespace badcad {
+
+namespace {
+
+constexpr float kDefaultExtrudeDepth = 0.2f;
+constexpr float kDefaultRevolveDegrees = 360.0f;
+constexpr double kDegreesToRadians = 3.14159265358979323846 / 180.0;
+
+// Revolves use the sketch's X axis, as in SPECIFICATION.md flow 2
+gp_Ax1 getRevolveAxis(const gp_Ax3& plane) {
+    return gp_Ax1(plane.Location(), plane.XDirection());
+}
+
+} // namespace
+
+SweepEditor::SweepEditor()
+    : m_tessellator(std::make_shared<Tessellator>())
+    , m_depth(kDefaultExtrudeDepth)
+    , m_angleDegrees(kDefaultRevolveDegrees)
+    , m_self(std::make_shared<SweepEditor*>(this)) {
+}
+
+SweepEditor::~SweepEditor() {
+    *m_self = nullptr;
+}
+
+void SweepEditor::setProfile(const TopoDS_Shape& profile, const gp_Ax3& plane) {
+    m_profile = profile;
+    m_plane = plane;
+    m_preview.reset();
+    uint64_t generation = ++m_profileGeneration;
+    if (profile.IsNull()) {
+        return;
+    }
+
+    const gp_Dir& direction = plane.Direction();
+    std::array<float, 3> normal = {(float)direction.X(), (float)direction.Y(), (float)direction.Z()};
+    std::shared_ptr<Tessellator> tessellator = m_tessellator;
+    std::shared_ptr<SweepEditor*> self = m_self;
+    TaskScheduler::instance().submit([profile, normal, tessellator, self, generation]() {
+        std::shared_ptr<const TessellatedShape> mesh = tessellator->tessellate(profile);
+        if (!mesh) {
+            BADCAD_LOG_WARN("Cannot tessellate sketch profile, no sweep preview");
+            return;
+        }
+        // Profiles are flat, so the coarsest level only loses curve sagitta
+        auto preview = std::make_shared<SweepPreview>();
+        preview->setProfile(mesh->getLevel(MeshLod::Low), normal.data());
+        TaskScheduler::instance().postToMainThread([self, generation, preview]() {
+            SweepEditor* editor = *self;
+            if (!editor || editor->m_profileGeneration != generation) {
+                return;
+            }
+            editor->m_preview = preview;
+            editor->updatePreview();
+        });
+    }, TaskPriority::Interactive);
+}
+
+bool SweepEditor::begin(SweepKind kind, OccViewer* viewer) {
+    if (m_profile.IsNull() || m_committing) {
+        return false;
+    }
+    cancel();
+    m_kind = kind;
+    m_viewer = viewer;
+    m_active = true;
+    updatePreview();
+    return true;
+}
+
+void SweepEditor::cancel() {
+    if (m_viewer) {
+        m_viewer->setPreviewMesh(nullptr);
+    }
+    m_mesh = nullptr;
+    m_active = false;
+    m_viewer = nullptr;
+}
+
+void SweepEditor::updatePreview() {
+    if (!m_active || !m_viewer || !m_preview) {
+        return;
+    }
+
+    // A new mesh every time: the viewer and frames in flight may still read
+    // the previous one. A drag changes the sizes little, so reserving them
+    // makes filling it a single allocation per buffer.
+    auto mesh = std::make_shared<MeshBuffers>();
+    if (m_mesh) {
+        mesh->positions.reserve(m_mesh->positions.size());
+        mesh->normals.reserve(m_mesh->normals.size());
+        mesh->indices.reserve(m_mesh->indices.size());
+    }
+
+    if (m_kind == SweepKind::Extrude) {
+        m_preview->buildExtrude(m_depth, *mesh);
+    } else {
+        gp_Ax1 axis = getRevolveAxis(m_plane);
+        const float origin[3] = {(float)axis.Location().X(), (float)axis.Location().Y(), (float)axis.Location().Z()};
+        const float direction[3] = {(float)axis.Direction().X(), (float)axis.Direction().Y(), (float)axis.Direction().Z()};
+        m_preview->buildRevolve(origin, direction, (float)(m_angleDegrees * kDegreesToRadians), *mesh);
+    }
+    m_mesh = mesh;
+    m_viewer->setPreviewMesh(mesh);
+}
+
+void SweepEditor::renderControls(const CommitCallback& onCommitted) {
+    if (!m_active) {
+        return;
+    }
+
+    ImGui::Text("%s", m_kind == SweepKind::Extrude ? "Extrude" : "Revolve");
+    ImGui::Separator();
+
+    ImGui::BeginDisabled(m_committing);
+    bool changed = false;
+    if (m_kind == SweepKind::Extrude) {
+        changed = ImGui::DragFloat("Depth", &m_depth, 0.005f, -10.0f, 10.0f, "%.3f");
+    } else {
+        changed = ImGui::DragFloat("Angle", &m_angleDegrees, 1.0f, -360.0f, 360.0f, "%.1f deg");
+    }
+    if (changed) {
+        updatePreview();
+    }
+
+    if (ImGui::Button("OK")) {
+        commit(onCommitted);
+    }
+    ImGui::SameLine();
+    if (ImGui::Button("Cancel")) {
+        cancel();
+    }
+    ImGui::EndDisabled();
+
+    if (m_committing) {
+        ImGui::TextDisabled("Building solid...");
+    } else if (!m_preview) {
+        ImGui::TextDisabled("Preparing preview...");
+    }
+}
+
+void SweepEditor::commit(const CommitCallback& onCommitted) {
+    if (m_committing) {
+        return;
+    }
+    m_committing = true;
+
+    // The solid is built exactly once, from the final value
+    SweepKind kind = m_kind;
+    TopoDS_Shape profile = m_profile;
+    gp_Vec extrusion = gp_Vec(m_plane.Direction()) * m_depth;
+    gp_Ax1 axis = getRevolveAxis(m_plane);
+    double angle = m_angleDegrees * kDegreesToRadians;
+    auto result = std::make_shared<SweepResult>();
+    std::shared_ptr<SweepEditor*> self = m_self;
+
+    JobManager::instance().start(kind == SweepKind::Extrude ? "Extrude" : "Revolve",
+        [kind, profile, extrusion, axis, angle, result](Job&) {
+            *result = (kind == SweepKind::Extrude) ? makeExtrude(profile, extrusion)
+                                                   : makeRevolve(profile, axis, angle);
+            return result->isDone();
+        },
+        [self, kind, result, onCommitted](Job&) {
+            SweepEditor* editor = *self;
+            if (editor) {
+                editor->m_committing = false;
+                // On failure the preview stays up so the value can be changed
+                if (result->isDone()) {
+                    editor->cancel();
+                }
+            }
+            if (onCommitted) {
+                onCommitted(kind, *result);
+            }
+        }, TaskPriority::Interactive);
+}
+
+} // namespace badcad
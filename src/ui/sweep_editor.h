@@ -0,0 +1,76 @@
+#pragma once
+
+#include <functional>
+#include <memory>
+#include "../geometry/sweep_ops.h"
+#include <gp_Ax3.hxx>
+#include <TopoDS_Shape.hxx>
+
+namespace badcad {
+
+class OccViewer;
+class SweepPreview;
+class Tessellator;
+struct MeshBuffers;
+
+enum class SweepKind {
+    Extrude,
+    Revolve
+};
+
+// Live editing of an extrude depth or revolve angle, the "live editable
+// values for active feature" of SPECIFICATION.md.
+//
+// While the value is dragged the viewport shows a SweepPreview swept from
+// the profile's tessellation, and nothing but its GPU buffer changes per
+// mouse move. OK builds the real solid once, in a job.
+class SweepEditor {
+public:
+    // Main thread, once the solid is built or has failed
+    using CommitCallback = std::function<void(SweepKind kind, const SweepResult& result)>;
+
+    SweepEditor();
+    ~SweepEditor();
+
+    SweepEditor(const SweepEditor&) = delete;
+    SweepEditor& operator=(const SweepEditor&) = delete;
+
+    // Profile that the next edit sweeps (ProfileBuilder::getProfile()) and
+    // its sketch plane. Tessellated on a worker right away.
+    void setProfile(const TopoDS_Shape& profile, const gp_Ax3& plane);
+    bool hasProfile() const { return !m_profile.IsNull(); }
+
+    // False without a profile. The preview appears once the profile is
+    // tessellated; viewer may be null.
+    bool begin(SweepKind kind, OccViewer* viewer);
+    bool isActive() const { return m_active; }
+    void cancel();
+
+    // Value controls and OK/Cancel, for the Properties panel
+    void renderControls(const CommitCallback& onCommitted);
+
+private:
+    void updatePreview();
+    void commit(const CommitCallback& onCommitted);
+
+    TopoDS_Shape m_profile;
+    gp_Ax3 m_plane;
+    uint64_t m_profileGeneration = 0;
+    std::shared_ptr<Tessellator> m_tessellator;     // Keeps unchanged profile faces meshed
+    std::shared_ptr<const SweepPreview> m_preview;  // Null until tessellated
+
+    SweepKind m_kind = SweepKind::Extrude;
+    bool m_active = false;
+    bool m_committing = false;
+    float m_depth;
+    float m_angleDegrees;
+    OccViewer* m_viewer = nullptr;
+
+    // Last mesh given to the viewer; the next one is reserved from its sizes
+    std::shared_ptr<const MeshBuffers> m_mesh;
+
+    // Lets worker and job completions detect that the editor is gone
+    std::shared_ptr<SweepEditor*> m_self;
+};
+
+} // namespace badcad
@@ -0,0 +1,96 @@
+#include "cache_dir.h"
+#include "log.h"
+#include <algorithm>
+#include <cstdlib>
+#include <system_error>
+#include <vector>
+
+namespace badcad {
+
+static std::filesystem::path getCacheRoot() {
+    if (const char* overridden = std::getenv("BADCAD_CACHE_DIR")) {
+        return overridden;
+    }
+#ifdef _WIN32
+    if (const char* localAppData = std::getenv("LOCALAPPDATA")) {
+        return std::filesystem::path(localAppData) / "badCAD" / "cache";
+    }
+#else
+    if (const char* xdgCache = std::getenv("XDG_CACHE_HOME")) {
+        return std::filesystem::path(xdgCache) / "badcad";
+    }
+    if (const char* home = std::getenv("HOME")) {
+        return std::filesystem::path(home) / ".cache" / "badcad";
+    }
+#endif
+    return {};
+}
+
+std::filesystem::path getCacheDirectory(const std::string& subdirectory) {
+    std::filesystem::path root = getCacheRoot();
+    if (root.empty()) {
+        return {};
+    }
+
+    std::filesystem::path directory = root / subdirectory;
+    std::error_code ec;
+    std::filesystem::create_directories(directory, ec);
+    if (ec) {
+        BADCAD_LOG_WARN("Cannot create cache directory ", directory.string(), ": ", ec.message());
+        return {};
+    }
+    return directory;
+}
+
+uint64_t getCacheDirectorySize(const std::filesystem::path& directory, const std::string& extension) {
+    uint64_t total = 0;
+    std::error_code ec;
+    for (const auto& entry : std::filesystem::directory_iterator(directory, ec)) {
+        if (entry.path().extension() == extension) {
+            total += entry.file_size(ec);
+        }
+    }
+    return total;
+}
+
+uint64_t trimCacheDirectory(const std::filesystem::path& directory, const std::string& extension,
+                            uint64_t targetBytes) {
+    struct Entry {
+        std::filesystem::file_time_type time;
+        uint64_t size;
+        std::filesystem::path path;
+    };
+    std::vector<Entry> entries;
+    uint64_t total = 0;
+    std::error_code ec;
+    for (const auto& entry : std::filesystem::directory_iterator(directory, ec)) {
+        if (entry.path().extension() != extension) {
+            continue;
+        }
+        Entry item = {entry.last_write_time(ec), entry.file_size(ec), entry.path()};
+        total += item.size;
+        entries.push_back(std::move(item));
+    }
+    std::sort(entries.begin(), entries.end(), [](const Entry& a, const Entry& b) { return a.time < b.time; });
+
+    size_t removed = 0;
+    for (const Entry& entry : entries) {
+        if (total <= targetBytes) {
+            break;
+        }
+        if (std::filesystem::remove(entry.path, ec)) {
+            total -= entry.size;
+            removed++;
+        }
+    }
+    BADCAD_LOG_DEBUG("Evicted ", removed, " entries from ", directory.string(), ", ", total / 1024, " KB left");
+    return total;
+}
+
+void touchCacheEntry(const std::filesystem::path& path) {
+    // Failures only make the entry look older
+    std::error_code ec;
+    std::filesystem::last_write_time(path, std::filesystem::file_time_type::clock::now(), ec);
+}
+
+} // namespace badcad
@@ -0,0 +1,30 @@
+#pragma once
+
+#include <cstdint>
+#include <filesystem>
+#include <string>
+
+namespace badcad {
+
+// Per-user directory for derived data that can be rebuilt at any time (font
+// atlases, icon atlases, meshes). BADCAD_CACHE_DIR overrides the platform
+// default, which is %LOCALAPPDATA%\badCAD\cache on Windows and
+// $XDG_CACHE_HOME/badcad (or ~/.cache/badcad) elsewhere.
+//
+// The subdirectory is created on demand. Returns an empty path when that
+// fails; callers then simply skip caching.
+std::filesystem::path getCacheDirectory(const std::string& subdirectory);
+
+// Total size of the files with the given extension (e.g. ".mesh") in directory
+uint64_t getCacheDirectorySize(const std::filesystem::path& directory, const std::string& extension);
+
+// Least-recently-used eviction: deletes the files with the given extension,
+// oldest modification time first, until at most targetBytes remain. Returns
+// the size left. Readers keep hot entries alive with touchCacheEntry().
+uint64_t trimCacheDirectory(const std::filesystem::path& directory, const std::string& extension,
+                            uint64_t targetBytes);
+
+// Marks an entry as just used
+void touchCacheEntry(const std::filesystem::path& path);
+
+} // namespace badcad
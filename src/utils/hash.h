@@ -0,0 +1,31 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+namespace badcad {
+
+// 64-bit FNV-1a. Good enough for cache keys; not meant to resist collisions
+// from adversarial input.
+constexpr uint64_t kHashSeed = 14695981039346656037ull;
+
+inline uint64_t hashBytes(const void* data, size_t size, uint64_t seed = kHashSeed) {
+    const unsigned char* bytes = static_cast<const unsigned char*>(data);
+    uint64_t hash = seed;
+    for (size_t i = 0; i < size; ++i) {
+        hash ^= bytes[i];
+        hash *= 1099511628211ull;
+    }
+    return hash;
+}
+
+inline uint64_t hashString(const std::string& str, uint64_t seed = kHashSeed) {
+    return hashBytes(str.data(), str.size(), seed);
+}
+
+inline uint64_t hashCombine(uint64_t seed, uint64_t value) {
+    return seed ^ (value + 0x9e3779b97f4a7c15ull + (seed << 6) + (seed >> 2));
+}
+
+} // namespace badcad
@@ -0,0 +1,95 @@
+#include "job.h"
+#include "log.h"
+#include "trace.h"
+#include <algorithm>
+#include <exception>
+
+namespace badcad {
+
+std::string Job::getStatusText() const {
+    std::lock_guard<std::mutex> lock(m_statusMutex);
+    return m_statusText;
+}
+
+void Job::setStatusText(const std::string& text) {
+    std::lock_guard<std::mutex> lock(m_statusMutex);
+    m_statusText = text;
+}
+
+void Job::finish(JobState state, const std::string& error) {
+    m_error = error;
+    if (state == JobState::Succeeded) {
+        m_progress.store(1.0f, std::memory_order_relaxed);
+    }
+    m_state.store(state, std::memory_order_release);
+    m_promise.set_value(state);
+}
+
+JobManager& JobManager::instance() {
+    static JobManager manager;
+    return manager;
+}
+
+JobHandle JobManager::start(const std::string& name, Body body, Completion onFinished, TaskPriority priority) {
+    JobHandle job = std::make_shared<Job>(name);
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_jobs.push_back(job);
+    }
+    BADCAD_LOG_DEBUG("Job started: ", name);
+
+    TaskScheduler::instance().submit([this, job, body = std::move(body), onFinished = std::move(onFinished)]() {
+        JobState state = JobState::Failed;
+        std::string error;
+        {
+            BADCAD_TRACE_SCOPE_CAT("Job", "job");
+            try {
+                bool ok = body(*job);
+                state = job->isCancelled() ? JobState::Cancelled : (ok ? JobState::Succeeded : JobState::Failed);
+            } catch (const std::exception& e) {
+                error = e.what();
+            } catch (...) {
+                error = "unknown exception";
+            }
+        }
+        if (state == JobState::Failed) {
+            BADCAD_LOG_WARN("Job failed: ", job->getName(), error.empty() ? "" : ": ", error);
+        } else if (state == JobState::Cancelled) {
+            BADCAD_LOG_INFO("Job cancelled: ", job->getName());
+        }
+        job->finish(state, error);
+
+        TaskScheduler::instance().postToMainThread([this, job, onFinished]() {
+            remove(job);
+            if (onFinished) {
+                onFinished(*job);
+            }
+        });
+    }, priority);
+
+    return job;
+}
+
+std::vector<JobHandle> JobManager::getActiveJobs() const {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_jobs;
+}
+
+bool JobManager::hasActiveJobs() const {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return !m_jobs.empty();
+}
+
+void JobManager::cancelAll() {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    for (const auto& job : m_jobs) {
+        job->cancel();
+    }
+}
+
+void JobManager::remove(const JobHandle& job) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_jobs.erase(std::remove(m_jobs.begin(), m_jobs.end(), job), m_jobs.end());
+}
+
+} // namespace badcad
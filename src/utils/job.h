@@ -0,0 +1,96 @@
+#pragma once
+
+#include "task_scheduler.h"
+#include <atomic>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace badcad {
+
+enum class JobState {
+    Running,
+    Succeeded,
+    Failed,
+    Cancelled
+};
+
+// A long-running operation (open, save, import, export, recompute) executed
+// on the task scheduler. The body reports progress and polls isCancelled()
+// at convenient points; cancellation is cooperative and never interrupts it.
+class Job {
+public:
+    explicit Job(const std::string& name) : m_name(name), m_future(m_promise.get_future().share()) {}
+
+    const std::string& getName() const { return m_name; }
+
+    // 0..1, or negative while the total amount of work is unknown
+    float getProgress() const { return m_progress.load(std::memory_order_relaxed); }
+    void setProgress(float progress) { m_progress.store(progress, std::memory_order_relaxed); }
+
+    // Short description of the current step, shown next to the progress bar
+    std::string getStatusText() const;
+    void setStatusText(const std::string& text);
+
+    void cancel() { m_cancelled.store(true, std::memory_order_relaxed); }
+    bool isCancelled() const { return m_cancelled.load(std::memory_order_relaxed); }
+    // For blocking calls that poll a flag themselves, e.g. Tessellator::tessellate()
+    const std::atomic<bool>* getCancelFlag() const { return &m_cancelled; }
+
+    JobState getState() const { return m_state.load(std::memory_order_acquire); }
+    const std::string& getError() const { return m_error; }   // Valid once Failed
+
+    // Becomes ready when the body has returned (before onFinished runs)
+    std::shared_future<JobState> getFuture() const { return m_future; }
+
+private:
+    friend class JobManager;
+
+    void finish(JobState state, const std::string& error);
+
+    std::string m_name;
+    std::atomic<float> m_progress{-1.0f};
+    std::atomic<bool> m_cancelled{false};
+    std::atomic<JobState> m_state{JobState::Running};
+    std::string m_error;
+
+    mutable std::mutex m_statusMutex;
+    std::string m_statusText;
+
+    std::promise<JobState> m_promise;
+    std::shared_future<JobState> m_future;
+};
+
+using JobHandle = std::shared_ptr<Job>;
+
+// Starts jobs and keeps the list of running ones for the status bar
+class JobManager {
+public:
+    using Body = std::function<bool(Job& job)>;
+    using Completion = std::function<void(Job& job)>;
+
+    static JobManager& instance();
+
+    // The body returns true on success; false or an exception marks the job
+    // Failed, and a job whose cancel() was requested ends Cancelled.
+    // onFinished runs on the main thread, where it may touch UI and documents.
+    JobHandle start(const std::string& name, Body body, Completion onFinished = nullptr,
+                    TaskPriority priority = TaskPriority::Background);
+
+    // Jobs whose onFinished has not run yet, oldest first
+    std::vector<JobHandle> getActiveJobs() const;
+    bool hasActiveJobs() const;
+    void cancelAll();
+
+private:
+    JobManager() = default;
+    void remove(const JobHandle& job);
+
+    mutable std::mutex m_mutex;
+    std::vector<JobHandle> m_jobs;
+};
+
+} // namespace badcad
@@ -0,0 +1,196 @@
+#include "log.h"
+#include <chrono>
+#include <condition_variable>
+#include <cstdio>
+#include <iostream>
+#include <mutex>
+#include <sstream>
+#include <thread>
+#include <vector>
+
+namespace badcad {
+
+namespace {
+
+constexpr size_t kQueueCapacity = 4096;
+
+struct LogRecord {
+    LogLevel level = LogLevel::Info;
+    double time = 0.0;   // Seconds since startup
+    Logger::Formatter format;
+};
+
+const char* levelTag(LogLevel level) {
+    switch (level) {
+        case LogLevel::Trace: return "TRACE";
+        case LogLevel::Debug: return "DEBUG";
+        case LogLevel::Info: return "INFO ";
+        case LogLevel::Warn: return "WARN ";
+        case LogLevel::Error: return "ERROR";
+        default: return "     ";
+    }
+}
+
+class LogQueue {
+public:
+    ~LogQueue() {
+        stop();
+    }
+
+    void push(LogLevel level, Logger::Formatter&& format) {
+        std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - m_epoch;
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            if (!m_writer.joinable()) {
+                m_stopping = false;
+                m_writer = std::thread(&LogQueue::run, this);
+            }
+            if (m_size == m_ring.size()) {
+                m_dropped++;
+                return;
+            }
+            LogRecord& record = m_ring[(m_head + m_size) % m_ring.size()];
+            record.level = level;
+            record.time = elapsed.count();
+            record.format = std::move(format);
+            m_size++;
+            m_submitted++;
+        }
+        m_wake.notify_one();
+    }
+
+    void flush() {
+        std::unique_lock<std::mutex> lock(m_mutex);
+        uint64_t target = m_submitted;
+        m_drained.wait(lock, [&] { return m_written >= target || !m_writer.joinable(); });
+    }
+
+    void stop() {
+        std::thread writer;
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            if (!m_writer.joinable()) {
+                return;
+            }
+            m_stopping = true;
+            writer = std::move(m_writer);
+        }
+        m_wake.notify_one();
+        writer.join();
+        m_drained.notify_all();
+    }
+
+private:
+    void run() {
+        std::vector<LogRecord> batch;
+        std::ostringstream text;
+
+        while (true) {
+            uint64_t dropped = 0;
+            {
+                std::unique_lock<std::mutex> lock(m_mutex);
+                m_wake.wait(lock, [this] { return m_size > 0 || m_stopping; });
+                if (m_size == 0 && m_stopping) {
+                    break;
+                }
+                for (; m_size > 0; m_size--) {
+                    batch.push_back(std::move(m_ring[m_head]));
+                    m_head = (m_head + 1) % m_ring.size();
+                }
+                dropped = m_dropped;
+                m_dropped = 0;
+            }
+
+            // Formatting and I/O happen here, off the threads that logged
+            bool anyErrors = false;
+            for (const LogRecord& record : batch) {
+                text.str(std::string());
+                char prefix[32];
+                std::snprintf(prefix, sizeof(prefix), "[%9.3f] %s ", record.time, levelTag(record.level));
+                text << prefix;
+                record.format(text);
+                text << '\n';
+
+                if (record.level >= LogLevel::Warn) {
+                    std::cerr << text.str();
+                    anyErrors = true;
+                } else {
+                    std::cout << text.str();
+                }
+            }
+            if (dropped > 0) {
+                std::cerr << "[log] " << dropped << " messages dropped (queue full)\n";
+            }
+            std::cout.flush();
+            if (anyErrors || dropped > 0) {
+                std::cerr.flush();
+            }
+
+            {
+                std::lock_guard<std::mutex> lock(m_mutex);
+                m_written += batch.size();
+            }
+            m_drained.notify_all();
+            batch.clear();
+        }
+    }
+
+    const std::chrono::steady_clock::time_point m_epoch = std::chrono::steady_clock::now();
+
+    std::mutex m_mutex;
+    std::condition_variable m_wake;
+    std::condition_variable m_drained;
+    std::vector<LogRecord> m_ring = std::vector<LogRecord>(kQueueCapacity);
+    size_t m_head = 0;
+    size_t m_size = 0;
+    uint64_t m_dropped = 0;
+    uint64_t m_submitted = 0;
+    uint64_t m_written = 0;
+    bool m_stopping = false;
+    std::thread m_writer;
+};
+
+LogQueue& queue() {
+    static LogQueue instance;
+    return instance;
+}
+
+} // namespace
+
+#ifdef NDEBUG
+std::atomic<LogLevel> Logger::s_level{LogLevel::Info};
+#else
+std::atomic<LogLevel> Logger::s_level{LogLevel::Debug};
+#endif
+
+bool Logger::parseLevel(const std::string& name, LogLevel& outLevel) {
+    static const std::pair<const char*, LogLevel> names[] = {
+        {"trace", LogLevel::Trace},
+        {"debug", LogLevel::Debug},
+        {"info", LogLevel::Info},
+        {"warn", LogLevel::Warn},
+        {"error", LogLevel::Error},
+        {"off", LogLevel::Off},
+    };
+    for (const auto& entry : names) {
+        if (name == entry.first) {
+            outLevel = entry.second;
+            return true;
+        }
+    }
+    return false;
+}
+
+void Logger::submit(LogLevel level, Formatter&& format) {
+    queue().push(level, std::move(format));
+}
+
+void Logger::flush() {
+    queue().flush();
+}
+
+void Logger::shutdown() {
+    queue().stop();
+}
+
+} // namespace badcad
@@ -0,0 +1,92 @@
+#pragma once
+
+#include <atomic>
+#include <functional>
+#include <ostream>
+#include <string>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+
+namespace badcad {
+
+enum class LogLevel {
+    Trace,
+    Debug,
+    Info,
+    Warn,
+    Error,
+    Off
+};
+
+// Levels below this are compiled out: their arguments are never evaluated
+// and no code is generated. Values follow LogLevel (0 = Trace).
+#ifndef BADCAD_LOG_MIN_LEVEL
+#ifdef NDEBUG
+#define BADCAD_LOG_MIN_LEVEL 2
+#else
+#define BADCAD_LOG_MIN_LEVEL 1
+#endif
+#endif
+
+// Asynchronous logger. The calling thread only copies the arguments into a
+// bounded ring buffer; formatting and console I/O happen on a background
+// writer thread. When the buffer is full new messages are dropped (and
+// counted) rather than stalling the caller.
+class Logger {
+public:
+    using Formatter = std::function<void(std::ostream&)>;
+
+    static bool isEnabled(LogLevel level) {
+        return level >= s_level.load(std::memory_order_relaxed);
+    }
+    static void setLevel(LogLevel level) { s_level.store(level, std::memory_order_relaxed); }
+    static bool parseLevel(const std::string& name, LogLevel& outLevel);
+
+    // Arguments are captured by value; strings and char arrays are copied so
+    // temporaries such as path.c_str() stay valid until the message is written
+    template <typename... Args>
+    static void log(LogLevel level, Args&&... args) {
+        auto captured = std::make_tuple(capture(std::forward<Args>(args))...);
+        submit(level, [captured = std::move(captured)](std::ostream& out) {
+            std::apply([&out](const auto&... values) { (void)(out << ... << values); }, captured);
+        });
+    }
+
+    // Block until everything queued so far has been written
+    static void flush();
+    // Flush and stop the writer thread; later messages restart it
+    static void shutdown();
+
+private:
+    static void submit(LogLevel level, Formatter&& format);
+
+    template <typename T>
+    static auto capture(T&& value) {
+        using Decayed = std::decay_t<T>;
+        if constexpr (std::is_array_v<std::remove_reference_t<T>>) {
+            return std::string(value);
+        } else if constexpr (std::is_same_v<Decayed, const char*> || std::is_same_v<Decayed, char*>) {
+            return std::string(value ? value : "(null)");
+        } else {
+            return Decayed(std::forward<T>(value));
+        }
+    }
+
+    static std::atomic<LogLevel> s_level;
+};
+
+} // namespace badcad
+
+#define BADCAD_LOG(level, ...)                                                          \
+    do {                                                                                \
+        if ((int)(level) >= BADCAD_LOG_MIN_LEVEL && ::badcad::Logger::isEnabled(level)) { \
+            ::badcad::Logger::log(level, __VA_ARGS__);                                  \
+        }                                                                               \
+    } while (0)
+
+#define BADCAD_LOG_TRACE(...) BADCAD_LOG(::badcad::LogLevel::Trace, __VA_ARGS__)
+#define BADCAD_LOG_DEBUG(...) BADCAD_LOG(::badcad::LogLevel::Debug, __VA_ARGS__)
+#define BADCAD_LOG_INFO(...) BADCAD_LOG(::badcad::LogLevel::Info, __VA_ARGS__)
+#define BADCAD_LOG_WARN(...) BADCAD_LOG(::badcad::LogLevel::Warn, __VA_ARGS__)
+#define BADCAD_LOG_ERROR(...) BADCAD_LOG(::badcad::LogLevel::Error, __VA_ARGS__)
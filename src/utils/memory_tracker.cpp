@@ -0,0 +1,112 @@
+#include "memory_tracker.h"
+#include <atomic>
+#include <cstdio>
+#include <fstream>
+
+#ifdef _WIN32
+#include <windows.h>
+#include <psapi.h>
+#else
+#include <unistd.h>
+#endif
+
+namespace badcad {
+
+namespace {
+
+constexpr int kTagCount = (int)MemoryTag::Count;
+
+std::atomic<size_t> s_live[kTagCount];
+std::atomic<size_t> s_peak[kTagCount];
+
+std::string formatBytes(size_t bytes) {
+    char text[32];
+    if (bytes >= 1024 * 1024) {
+        std::snprintf(text, sizeof(text), "%.1f MB", bytes / (1024.0 * 1024.0));
+    } else {
+        std::snprintf(text, sizeof(text), "%.1f KB", bytes / 1024.0);
+    }
+    return text;
+}
+
+} // namespace
+
+void MemoryTracker::add(MemoryTag tag, size_t bytes) {
+    int i = (int)tag;
+    size_t live = s_live[i].fetch_add(bytes, std::memory_order_relaxed) + bytes;
+    size_t peak = s_peak[i].load(std::memory_order_relaxed);
+    while (live > peak && !s_peak[i].compare_exchange_weak(peak, live, std::memory_order_relaxed)) {
+    }
+}
+
+void MemoryTracker::remove(MemoryTag tag, size_t bytes) {
+    s_live[(int)tag].fetch_sub(bytes, std::memory_order_relaxed);
+}
+
+size_t MemoryTracker::getLiveBytes(MemoryTag tag) {
+    return s_live[(int)tag].load(std::memory_order_relaxed);
+}
+
+size_t MemoryTracker::getPeakBytes(MemoryTag tag) {
+    return s_peak[(int)tag].load(std::memory_order_relaxed);
+}
+
+size_t MemoryTracker::getTotalLiveBytes() {
+    size_t total = 0;
+    for (int i = 0; i < kTagCount; i++) {
+        total += s_live[i].load(std::memory_order_relaxed);
+    }
+    return total;
+}
+
+size_t MemoryTracker::getProcessResidentBytes() {
+#ifdef _WIN32
+    PROCESS_MEMORY_COUNTERS counters;
+    if (GetProcessMemoryInfo(GetCurrentProcess(), &counters, sizeof(counters))) {
+        return counters.WorkingSetSize;
+    }
+    return 0;
+#else
+    // Second field of statm is the resident page count
+    std::ifstream statm("/proc/self/statm");
+    size_t totalPages = 0, residentPages = 0;
+    if (statm >> totalPages >> residentPages) {
+        return residentPages * (size_t)sysconf(_SC_PAGESIZE);
+    }
+    return 0;
+#endif
+}
+
+const char* MemoryTracker::getTagName(MemoryTag tag) {
+    switch (tag) {
+        case MemoryTag::Document: return "Document";
+        case MemoryTag::Sketches: return "Sketches";
+        case MemoryTag::GpuBuffers: return "GPU buffers";
+        case MemoryTag::Tessellation: return "Tessellation";
+        case MemoryTag::Undo: return "Undo";
+        default: return "?";
+    }
+}
+
+std::string MemoryTracker::formatReport() {
+    std::string report = "Memory (live / peak):\n";
+    char line[128];
+    for (int i = 0; i < kTagCount; i++) {
+        std::snprintf(line, sizeof(line), "  %-14s %12s / %s\n", getTagName((MemoryTag)i),
+                      formatBytes(getLiveBytes((MemoryTag)i)).c_str(),
+                      formatBytes(getPeakBytes((MemoryTag)i)).c_str());
+        report += line;
+    }
+    std::snprintf(line, sizeof(line), "  %-14s %12s\n", "Tracked total", formatBytes(getTotalLiveBytes()).c_str());
+    report += line;
+
+    size_t resident = getProcessResidentBytes();
+    if (resident > 0) {
+        std::snprintf(line, sizeof(line), "  %-14s %12s (idle budget %s)\n", "Process RSS",
+                      formatBytes(resident).c_str(), formatBytes(kIdleMemoryBudget).c_str());
+        report += line;
+    }
+    return report;
+}
+
+} // namespace badcad
@@ -0,0 +1,75 @@
+#pragma once
+
+#include <cstddef>
+#include <string>
+
+namespace badcad {
+
+// Budgets from SPECIFICATION.md §8, checked against process resident size
+static constexpr size_t kIdleMemoryBudget = 200u * 1024 * 1024;
+static constexpr size_t kMediumAssemblyMemoryBudget = 500u * 1024 * 1024;
+
+// Subsystems whose memory is accounted separately
+enum class MemoryTag {
+    Document,       // Planes, features and other document state
+    Sketches,
+    GpuBuffers,     // FBO color/depth storage, textures, VBOs (estimated from sizes)
+    Tessellation,   // CPU-side meshes
+    Undo,
+    Count
+};
+
+// Live and peak bytes per tag. Owners report their footprint explicitly
+// (there is no global operator new hook), so this tracks what each subsystem
+// believes it holds; compare against getProcessResidentBytes() to spot
+// untracked growth. Thread-safe.
+class MemoryTracker {
+public:
+    static void add(MemoryTag tag, size_t bytes);
+    static void remove(MemoryTag tag, size_t bytes);
+
+    static size_t getLiveBytes(MemoryTag tag);
+    static size_t getPeakBytes(MemoryTag tag);
+    static size_t getTotalLiveBytes();
+
+    // Resident set size reported by the OS, 0 if unavailable
+    static size_t getProcessResidentBytes();
+
+    static const char* getTagName(MemoryTag tag);
+
+    // Multi-line table of all tags plus process RSS, for logs and the CLI
+    static std::string formatReport();
+};
+
+// A tagged byte count that keeps the tracker in sync: set() moves it to a new
+// size and the destructor releases it. Copies account for their own bytes.
+class TrackedBytes {
+public:
+    explicit TrackedBytes(MemoryTag tag) : m_tag(tag) {}
+    TrackedBytes(const TrackedBytes& other) : m_tag(other.m_tag) { set(other.m_bytes); }
+    TrackedBytes& operator=(const TrackedBytes& other) {
+        if (this != &other) {
+            set(0);
+            m_tag = other.m_tag;
+            set(other.m_bytes);
+        }
+        return *this;
+    }
+    ~TrackedBytes() { set(0); }
+
+    void set(size_t bytes) {
+        if (bytes > m_bytes) {
+            MemoryTracker::add(m_tag, bytes - m_bytes);
+        } else if (bytes < m_bytes) {
+            MemoryTracker::remove(m_tag, m_bytes - bytes);
+        }
+        m_bytes = bytes;
+    }
+    size_t get() const { return m_bytes; }
+
+private:
+    MemoryTag m_tag;
+    size_t m_bytes = 0;
+};
+
+} // namespace badcad
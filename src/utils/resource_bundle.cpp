@@ -0,0 +1,122 @@
+#include "resource_bundle.h"
+#include "hash.h"
+#include "log.h"
+#include "trace.h"
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+
+#include <stb/stb_image.h>
+
+namespace badcad {
+
+namespace {
+
+// Inflated and disk-loaded resources; entries are never removed so views stay valid
+std::mutex s_cacheMutex;
+std::unordered_map<std::string, std::unique_ptr<std::vector<unsigned char>>> s_cache;
+
+#ifdef BADCAD_EMBED_RESOURCES
+const ResourceBundleEntry* findEntry(const std::string& name) {
+    size_t low = 0;
+    size_t high = kResourceBundleEntryCount;
+    while (low < high) {
+        size_t mid = (low + high) / 2;
+        int order = std::strcmp(kResourceBundleEntries[mid].name, name.c_str());
+        if (order == 0) {
+            return &kResourceBundleEntries[mid];
+        }
+        if (order < 0) {
+            low = mid + 1;
+        } else {
+            high = mid;
+        }
+    }
+    return nullptr;
+}
+#endif
+
+ResourceView viewOf(const std::vector<unsigned char>& bytes) {
+    return {bytes.data(), bytes.size()};
+}
+
+} // namespace
+
+ResourceView Resources::get(const std::string& name) {
+#ifdef BADCAD_EMBED_RESOURCES
+    const ResourceBundleEntry* entry = findEntry(name);
+    if (entry && entry->storedSize == entry->originalSize) {
+        return {kResourceBundleData + entry->offset, entry->originalSize};
+    }
+#endif
+
+    std::lock_guard<std::mutex> lock(s_cacheMutex);
+    auto cached = s_cache.find(name);
+    if (cached != s_cache.end()) {
+        return viewOf(*cached->second);
+    }
+
+    auto bytes = std::make_unique<std::vector<unsigned char>>();
+#ifdef BADCAD_EMBED_RESOURCES
+    if (entry) {
+        BADCAD_TRACE_SCOPE_CAT("Resources inflate", "io");
+        bytes->resize(entry->originalSize);
+        int inflated = stbi_zlib_decode_buffer(reinterpret_cast<char*>(bytes->data()), (int)bytes->size(),
+                                               reinterpret_cast<const char*>(kResourceBundleData + entry->offset),
+                                               (int)entry->storedSize);
+        if (inflated != (int)entry->originalSize) {
+            BADCAD_LOG_ERROR("Corrupt embedded resource: ", name);
+            return {};
+        }
+        const std::vector<unsigned char>& stored = *(s_cache[name] = std::move(bytes));
+        return viewOf(stored);
+    }
+#endif
+
+    BADCAD_TRACE_SCOPE_CAT("Resources read", "io");
+    std::ifstream file("resources/" + name, std::ios::binary | std::ios::ate);
+    if (!file.is_open()) {
+        return {};
+    }
+    bytes->resize((size_t)file.tellg());
+    file.seekg(0);
+    if (!file.read(reinterpret_cast<char*>(bytes->data()), bytes->size())) {
+        return {};
+    }
+    const std::vector<unsigned char>& stored = *(s_cache[name] = std::move(bytes));
+    return viewOf(stored);
+}
+
+bool Resources::isEmbedded(const std::string& name) {
+#ifdef BADCAD_EMBED_RESOURCES
+    return findEntry(name) != nullptr;
+#else
+    (void)name;
+    return false;
+#endif
+}
+
+uint64_t Resources::getFingerprint(const std::string& name) {
+#ifdef BADCAD_EMBED_RESOURCES
+    if (const ResourceBundleEntry* entry = findEntry(name)) {
+        return entry->contentHash;
+    }
+#endif
+    std::error_code ec;
+    std::filesystem::path path = "resources/" + name;
+    uintmax_t size = std::filesystem::file_size(path, ec);
+    if (ec) {
+        return 0;
+    }
+    auto modified = std::filesystem::last_write_time(path, ec);
+    if (ec) {
+        return 0;
+    }
+    return hashCombine(hashCombine(kHashSeed, (uint64_t)size), (uint64_t)modified.time_since_epoch().count());
+}
+
+} // namespace badcad
@@ -0,0 +1,52 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+namespace badcad {
+
+// Read-only bytes of a resource, valid for the lifetime of the process
+struct ResourceView {
+    const unsigned char* data = nullptr;
+    size_t size = 0;
+
+    explicit operator bool() const { return data != nullptr; }
+};
+
+// One packed file. Layout shared with tools/pack_resources.cpp, which emits
+// the table sorted by name.
+struct ResourceBundleEntry {
+    const char* name;       // Path relative to resources/, '/' separators
+    size_t offset;          // Into kResourceBundleData
+    size_t storedSize;
+    size_t originalSize;    // Equal to storedSize when stored uncompressed (e.g. PNG)
+    uint64_t contentHash;   // hashBytes() of the original bytes
+};
+
+#ifdef BADCAD_EMBED_RESOURCES
+// Defined in the generated resource_bundle_data.cpp
+extern const ResourceBundleEntry kResourceBundleEntries[];
+extern const size_t kResourceBundleEntryCount;
+extern const unsigned char kResourceBundleData[];
+#endif
+
+// Resource lookup by name, e.g. "fonts/IBMPlexSans-Regular.ttf".
+//
+// Builds with BADCAD_EMBED_RESOURCES serve everything from the bundle linked
+// into the executable: uncompressed entries point straight into it, and
+// compressed ones are inflated once, on first use. Names that are not packed
+// (and every name in builds without the bundle) are read from resources/ on
+// disk and cached, so development builds pick up edited assets.
+class Resources {
+public:
+    static ResourceView get(const std::string& name);
+    static bool isEmbedded(const std::string& name);
+
+    // Changes whenever the resource's contents do, without reading or
+    // inflating them: the packed hash for embedded entries, size and
+    // modification time for files on disk. 0 if the resource does not exist.
+    static uint64_t getFingerprint(const std::string& name);
+};
+
+} // namespace badcad
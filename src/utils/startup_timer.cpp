@@ -0,0 +1,43 @@
+#include "startup_timer.h"
+#include "log.h"
+#include <chrono>
+#include <cstdio>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace badcad {
+
+namespace {
+
+const std::chrono::steady_clock::time_point s_processStart = std::chrono::steady_clock::now();
+std::vector<std::pair<const char*, double>> s_marks;
+
+} // namespace
+
+void StartupTimer::mark(const char* phase) {
+    s_marks.emplace_back(phase, elapsedMs());
+}
+
+double StartupTimer::elapsedMs() {
+    std::chrono::duration<double, std::milli> elapsed = std::chrono::steady_clock::now() - s_processStart;
+    return elapsed.count();
+}
+
+void StartupTimer::report() {
+    std::string text = "Startup breakdown:";
+    double previous = 0.0;
+    char line[128];
+    for (const auto& mark : s_marks) {
+        std::snprintf(line, sizeof(line), "\n  %-28s %7.1f ms  (+%.1f)", mark.first, mark.second, mark.second - previous);
+        text += line;
+        previous = mark.second;
+    }
+    BADCAD_LOG_INFO(text);
+
+    if (previous > kStartupBudgetMs) {
+        BADCAD_LOG_WARN("Startup took ", (int)previous, " ms, over the ", (int)kStartupBudgetMs, " ms budget");
+    }
+}
+
+} // namespace badcad
@@ -0,0 +1,20 @@
+#pragma once
+
+namespace badcad {
+
+// Startup budget from SPECIFICATION.md, launch to an interactive home screen
+static constexpr double kStartupBudgetMs = 1500.0;
+
+// Wall-clock milestones from process start (static initialization) to the
+// first interactive frame. Main thread only.
+class StartupTimer {
+public:
+    // Phase names must be string literals
+    static void mark(const char* phase);
+    static double elapsedMs();
+
+    // Logs each phase with its duration and warns when over the budget
+    static void report();
+};
+
+} // namespace badcad
@@ -0,0 +1,301 @@
+#include "task_scheduler.h"
+#include "log.h"
+#include "trace.h"
+#include <algorithm>
+#include <chrono>
+#include <exception>
+
+namespace badcad {
+
+namespace {
+
+// Index of the worker running on this thread, -1 for every other thread
+thread_local int t_workerIndex = -1;
+
+} // namespace
+
+TaskScheduler& TaskScheduler::instance() {
+    static TaskScheduler scheduler;
+    return scheduler;
+}
+
+TaskScheduler::~TaskScheduler() {
+    stop();
+}
+
+void TaskScheduler::start(unsigned workerCount) {
+    if (isRunning()) {
+        return;
+    }
+    if (workerCount == 0) {
+        unsigned hardware = std::thread::hardware_concurrency();
+        workerCount = hardware > 1 ? hardware - 1 : 1;
+    }
+
+    m_stopping = false;
+    m_queues.clear();
+    for (unsigned i = 0; i <= workerCount; i++) {
+        m_queues.push_back(std::make_unique<WorkQueue>());
+    }
+    m_workerNames.clear();
+    for (unsigned i = 0; i < workerCount; i++) {
+        m_workerNames.push_back("Worker " + std::to_string(i + 1));
+    }
+    for (unsigned i = 0; i < workerCount; i++) {
+        m_workers.emplace_back(&TaskScheduler::workerMain, this, (int)i);
+    }
+    BADCAD_LOG_DEBUG("Task scheduler started with ", workerCount, " workers");
+}
+
+void TaskScheduler::stop() {
+    if (!isRunning()) {
+        return;
+    }
+    {
+        std::lock_guard<std::mutex> lock(m_wakeMutex);
+        m_stopping = true;
+    }
+    m_wake.notify_all();
+    for (auto& worker : m_workers) {
+        worker.join();
+    }
+    m_workers.clear();
+    m_queues.clear();
+
+    std::lock_guard<std::mutex> lock(m_mainMutex);
+    m_mainTasks.clear();
+}
+
+TaskHandle TaskScheduler::submit(std::function<void()> function, TaskPriority priority) {
+    TaskHandle task = createTask(std::move(function), priority);
+    launch(task);
+    return task;
+}
+
+TaskHandle TaskScheduler::createTask(std::function<void()> function, TaskPriority priority) {
+    return TaskHandle(new Task(std::move(function), priority));
+}
+
+void TaskScheduler::addDependency(const TaskHandle& task, const TaskHandle& dependency) {
+    task->m_pending.fetch_add(1, std::memory_order_relaxed);
+    {
+        std::lock_guard<std::mutex> lock(dependency->m_mutex);
+        if (!dependency->m_done.load(std::memory_order_relaxed)) {
+            dependency->m_successors.push_back(task);
+            return;
+        }
+    }
+    // Already finished; the launch reference keeps the count above zero
+    task->m_pending.fetch_sub(1, std::memory_order_relaxed);
+}
+
+void TaskScheduler::launch(const TaskHandle& task) {
+    if (task->m_pending.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+        schedule(task);
+    }
+}
+
+TaskHandle TaskScheduler::then(const TaskHandle& parent, std::function<void()> function, TaskPriority priority) {
+    TaskHandle task = createTask(std::move(function), priority);
+    addDependency(task, parent);
+    launch(task);
+    return task;
+}
+
+TaskHandle TaskScheduler::whenAll(const std::vector<TaskHandle>& tasks, std::function<void()> function,
+                                  TaskPriority priority) {
+    TaskHandle task = createTask(std::move(function), priority);
+    for (const auto& dependency : tasks) {
+        addDependency(task, dependency);
+    }
+    launch(task);
+    return task;
+}
+
+void TaskScheduler::wait(const TaskHandle& task) {
+    BADCAD_TRACE_SCOPE_CAT("TaskScheduler::wait", "task");
+    // Other threads (the UI) only help with interactive work, so a frame never
+    // ends up running a save or a cache rebuild
+    bool isWorker = t_workerIndex >= 0;
+    TaskPriority lowest = isWorker ? TaskPriority::Idle : TaskPriority::Interactive;
+    while (!task->isDone()) {
+        TaskHandle other;
+        if (isRunning() && popTask(t_workerIndex, other, lowest)) {
+            execute(other);
+            continue;
+        }
+        // Short timeout: the task may finish on a worker between the check and
+        // the wait, or interactive work may be queued behind lower priorities
+        std::unique_lock<std::mutex> lock(m_wakeMutex);
+        m_taskFinished.wait_for(lock, std::chrono::milliseconds(1), [&] {
+            return task->isDone() || (isWorker && m_queued.load(std::memory_order_relaxed) > 0);
+        });
+    }
+}
+
+void TaskScheduler::parallelFor(size_t begin, size_t end, size_t grainSize,
+                                const std::function<void(size_t, size_t)>& body, TaskPriority priority) {
+    if (end <= begin) {
+        return;
+    }
+    size_t count = end - begin;
+    grainSize = std::max<size_t>(grainSize, 1);
+
+    // A few chunks per thread so stealing can even out uneven work
+    size_t maxChunks = (m_workers.size() + 1) * 4;
+    size_t chunks = std::min((count + grainSize - 1) / grainSize, maxChunks);
+    if (chunks <= 1 || !isRunning()) {
+        body(begin, end);
+        return;
+    }
+    size_t chunkSize = (count + chunks - 1) / chunks;
+
+    std::vector<TaskHandle> tasks;
+    tasks.reserve(chunks);
+    for (size_t chunkBegin = begin + chunkSize; chunkBegin < end; chunkBegin += chunkSize) {
+        size_t chunkEnd = std::min(chunkBegin + chunkSize, end);
+        tasks.push_back(submit([&body, chunkBegin, chunkEnd]() { body(chunkBegin, chunkEnd); }, priority));
+    }
+    body(begin, std::min(begin + chunkSize, end));
+
+    for (const auto& task : tasks) {
+        wait(task);
+    }
+}
+
+void TaskScheduler::postToMainThread(std::function<void()> function) {
+    std::lock_guard<std::mutex> lock(m_mainMutex);
+    m_mainTasks.push_back(std::move(function));
+}
+
+size_t TaskScheduler::runMainThreadTasks() {
+    std::vector<std::function<void()>> tasks;
+    {
+        std::lock_guard<std::mutex> lock(m_mainMutex);
+        tasks.swap(m_mainTasks);
+    }
+    if (tasks.empty()) {
+        return 0;
+    }
+
+    BADCAD_TRACE_SCOPE_CAT("TaskScheduler::runMainThreadTasks", "task");
+    for (auto& function : tasks) {
+        function();
+    }
+    return tasks.size();
+}
+
+void TaskScheduler::schedule(const TaskHandle& task) {
+    if (!isRunning()) {
+        execute(task);
+        return;
+    }
+
+    // Workers keep their own spawns local; everyone else uses the injection queue
+    WorkQueue& queue = *m_queues[t_workerIndex >= 0 ? t_workerIndex : m_queues.size() - 1];
+    {
+        std::lock_guard<std::mutex> lock(queue.mutex);
+        queue.tasks[(int)task->m_priority].push_back(task);
+    }
+    m_queued.fetch_add(1, std::memory_order_release);
+
+    // Taking the lock orders this with a worker's predicate check, so the
+    // notification cannot slip in between its check and its sleep
+    { std::lock_guard<std::mutex> lock(m_wakeMutex); }
+    m_wake.notify_one();
+}
+
+bool TaskScheduler::popTask(int workerIndex, TaskHandle& outTask, TaskPriority lowest) {
+    if (m_queued.load(std::memory_order_acquire) == 0) {
+        return false;
+    }
+
+    int queueCount = (int)m_queues.size();
+    int injection = queueCount - 1;
+
+    for (int priority = 0; priority <= (int)lowest; priority++) {
+        // Own work first, newest first (still warm in cache)
+        if (workerIndex >= 0) {
+            WorkQueue& own = *m_queues[workerIndex];
+            std::lock_guard<std::mutex> lock(own.mutex);
+            auto& tasks = own.tasks[priority];
+            if (!tasks.empty()) {
+                outTask = std::move(tasks.back());
+                tasks.pop_back();
+                m_queued.fetch_sub(1, std::memory_order_relaxed);
+                return true;
+            }
+        }
+
+        // Then submissions from outside the pool, then steal oldest-first from the others
+        for (int offset = 0; offset < queueCount; offset++) {
+            int index = (injection + offset) % queueCount;
+            if (index == workerIndex) {
+                continue;
+            }
+            WorkQueue& victim = *m_queues[index];
+            std::lock_guard<std::mutex> lock(victim.mutex);
+            auto& tasks = victim.tasks[priority];
+            if (!tasks.empty()) {
+                outTask = std::move(tasks.front());
+                tasks.pop_front();
+                m_queued.fetch_sub(1, std::memory_order_relaxed);
+                return true;
+            }
+        }
+    }
+    return false;
+}
+
+void TaskScheduler::execute(const TaskHandle& task) {
+    {
+        BADCAD_TRACE_SCOPE_CAT("Task", "task");
+        try {
+            task->m_function();
+        } catch (const std::exception& e) {
+            BADCAD_LOG_ERROR("Task failed: ", e.what());
+        } catch (...) {
+            BADCAD_LOG_ERROR("Task failed with an unknown exception");
+        }
+    }
+    // Release captures now rather than when the last handle goes away
+    task->m_function = nullptr;
+
+    std::vector<TaskHandle> successors;
+    {
+        std::lock_guard<std::mutex> lock(task->m_mutex);
+        task->m_done.store(true, std::memory_order_release);
+        successors.swap(task->m_successors);
+    }
+    for (const auto& successor : successors) {
+        if (successor->m_pending.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+            schedule(successor);
+        }
+    }
+
+    { std::lock_guard<std::mutex> lock(m_wakeMutex); }
+    m_taskFinished.notify_all();
+}
+
+void TaskScheduler::workerMain(int workerIndex) {
+    t_workerIndex = workerIndex;
+    Tracer::setThreadName(m_workerNames[workerIndex].c_str());
+
+    while (true) {
+        TaskHandle task;
+        if (popTask(workerIndex, task)) {
+            execute(task);
+            continue;
+        }
+
+        std::unique_lock<std::mutex> lock(m_wakeMutex);
+        m_wake.wait(lock, [this] { return m_queued.load(std::memory_order_acquire) > 0 || m_stopping; });
+        // Queued work is finished before stopping so saves are never cut short
+        if (m_stopping && m_queued.load(std::memory_order_acquire) == 0) {
+            break;
+        }
+    }
+    t_workerIndex = -1;
+}
+
+} // namespace badcad
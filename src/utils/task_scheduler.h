@@ -0,0 +1,132 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace badcad {
+
+enum class TaskPriority {
+    Interactive,    // Results the user is waiting on (picking, previews, open)
+    Background,     // Save, parse, tessellation, solving, recompute
+    Idle,           // Caches and prefetching; runs only when nothing else is queued
+    Count
+};
+
+class Task;
+using TaskHandle = std::shared_ptr<Task>;
+
+// A unit of work owned by the scheduler. It becomes runnable once it has been
+// launched and every task it depends on has finished.
+class Task {
+public:
+    bool isDone() const { return m_done.load(std::memory_order_acquire); }
+    TaskPriority getPriority() const { return m_priority; }
+
+private:
+    friend class TaskScheduler;
+
+    Task(std::function<void()> function, TaskPriority priority)
+        : m_function(std::move(function)), m_priority(priority) {}
+
+    std::function<void()> m_function;
+    TaskPriority m_priority;
+    std::atomic<int> m_pending{1};      // Unfinished dependencies, +1 until launched
+    std::atomic<bool> m_done{false};
+    std::mutex m_mutex;                 // Guards m_successors and the transition to done
+    std::vector<TaskHandle> m_successors;
+};
+
+// Process-wide work-stealing thread pool. Each worker keeps one deque per
+// priority: it pushes and pops its own work LIFO and steals FIFO from the
+// others, while tasks submitted from non-worker threads go through a shared
+// injection queue. Higher priorities are always drained first.
+//
+// Anything that has to touch ImGui, GL or editor state is handed back with
+// postToMainThread() and runs in Application::run() between frames.
+//
+// Until start() is called (e.g. headless runs) tasks execute inline on the
+// submitting thread, so callers never need a second code path.
+class TaskScheduler {
+public:
+    static TaskScheduler& instance();
+
+    // 0 workers uses one fewer than the hardware threads so the UI keeps a core
+    void start(unsigned workerCount = 0);
+    // Runs everything already queued, joins the workers and drops undelivered
+    // main-thread callbacks (their owners are being torn down)
+    void stop();
+    bool isRunning() const { return !m_workers.empty(); }
+    unsigned getWorkerCount() const { return (unsigned)m_workers.size(); }
+
+    // Create and launch in one step
+    TaskHandle submit(std::function<void()> function, TaskPriority priority = TaskPriority::Background);
+
+    // Task graphs: create, wire dependencies, then launch
+    TaskHandle createTask(std::function<void()> function, TaskPriority priority = TaskPriority::Background);
+    void addDependency(const TaskHandle& task, const TaskHandle& dependency);
+    void launch(const TaskHandle& task);
+
+    // Continuations: run once the parent (or all of the tasks) have finished
+    TaskHandle then(const TaskHandle& parent, std::function<void()> function,
+                    TaskPriority priority = TaskPriority::Background);
+    TaskHandle whenAll(const std::vector<TaskHandle>& tasks, std::function<void()> function,
+                       TaskPriority priority = TaskPriority::Background);
+
+    // Block until the task has finished, running other queued work meanwhile.
+    // Workers run anything queued; other threads only Interactive tasks and
+    // otherwise sleep. The task's dependencies must already be launched.
+    void wait(const TaskHandle& task);
+
+    // Run body(chunkBegin, chunkEnd) over [begin, end) in chunks of at least
+    // grainSize. The caller executes the first chunk and returns when all are
+    // done, helping as in wait(): called off the workers, it runs only
+    // Interactive tasks, which may include the other chunks.
+    void parallelFor(size_t begin, size_t end, size_t grainSize,
+                     const std::function<void(size_t, size_t)>& body,
+                     TaskPriority priority = TaskPriority::Interactive);
+
+    // Main-thread dispatch queue, safe to call from any thread
+    void postToMainThread(std::function<void()> function);
+    // Called once per frame on the main thread; returns the number of callbacks run
+    size_t runMainThreadTasks();
+
+private:
+    static constexpr int kPriorityCount = (int)TaskPriority::Count;
+
+    struct WorkQueue {
+        std::mutex mutex;
+        std::deque<TaskHandle> tasks[kPriorityCount];
+    };
+
+    TaskScheduler() = default;
+    ~TaskScheduler();
+
+    void schedule(const TaskHandle& task);
+    // Highest priority first, down to and including lowest
+    bool popTask(int workerIndex, TaskHandle& outTask, TaskPriority lowest = TaskPriority::Idle);
+    void execute(const TaskHandle& task);
+    void workerMain(int workerIndex);
+
+    // One queue per worker plus the injection queue at the end
+    std::vector<std::unique_ptr<WorkQueue>> m_queues;
+    std::vector<std::thread> m_workers;
+    std::vector<std::string> m_workerNames;     // Stable storage for trace thread names
+
+    std::atomic<int> m_queued{0};
+    std::mutex m_wakeMutex;
+    std::condition_variable m_wake;             // Work was queued or stop requested
+    std::condition_variable m_taskFinished;     // For wait()
+    bool m_stopping = false;
+
+    std::mutex m_mainMutex;
+    std::vector<std::function<void()>> m_mainTasks;
+};
+
+} // namespace badcad
@@ -0,0 +1,149 @@
+#include "trace.h"
+#include "log.h"
+#include <algorithm>
+#include <chrono>
+#include <fstream>
+#include <iomanip>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+namespace badcad {
+
+namespace {
+
+struct TraceEvent {
+    const char* name;
+    const char* category;
+    uint64_t startNs;
+    uint64_t durationNs;
+};
+
+// Written only by its owning thread. count is published with release order
+// after the slot is filled, so a reader sees complete events up to count.
+struct ThreadBuffer {
+    std::vector<TraceEvent> events;   // Power-of-two size
+    uint64_t mask = 0;
+    std::atomic<uint64_t> count{0};
+    uint32_t threadId = 0;
+    std::string threadName;
+};
+
+std::mutex s_registryMutex;
+std::vector<std::unique_ptr<ThreadBuffer>> s_buffers;   // Never freed; threads may exit first
+size_t s_capacity = 1 << 16;
+const std::chrono::steady_clock::time_point s_epoch = std::chrono::steady_clock::now();
+
+thread_local ThreadBuffer* t_buffer = nullptr;
+thread_local const char* t_threadName = nullptr;
+
+ThreadBuffer* registerThread() {
+    std::lock_guard<std::mutex> lock(s_registryMutex);
+    auto buffer = std::make_unique<ThreadBuffer>();
+    buffer->events.resize(s_capacity);
+    buffer->mask = s_capacity - 1;
+    buffer->threadId = (uint32_t)s_buffers.size() + 1;
+    buffer->threadName = t_threadName ? t_threadName : "Thread " + std::to_string(buffer->threadId);
+    t_buffer = buffer.get();
+    s_buffers.push_back(std::move(buffer));
+    return t_buffer;
+}
+
+void writeJsonString(std::ostream& out, const char* text) {
+    out << '"';
+    for (const char* c = text; *c; c++) {
+        if (*c == '"' || *c == '\\') {
+            out << '\\';
+        }
+        out << *c;
+    }
+    out << '"';
+}
+
+} // namespace
+
+std::atomic<bool> Tracer::s_enabled{false};
+
+void Tracer::enable(size_t eventsPerThread) {
+    {
+        std::lock_guard<std::mutex> lock(s_registryMutex);
+        // Buffers already allocated keep their size
+        s_capacity = 1024;
+        while (s_capacity < eventsPerThread) {
+            s_capacity <<= 1;
+        }
+    }
+    s_enabled.store(true, std::memory_order_relaxed);
+}
+
+void Tracer::disable() {
+    s_enabled.store(false, std::memory_order_relaxed);
+}
+
+void Tracer::setThreadName(const char* name) {
+    t_threadName = name;
+    if (t_buffer) {
+        std::lock_guard<std::mutex> lock(s_registryMutex);
+        t_buffer->threadName = name;
+    }
+}
+
+uint64_t Tracer::now() {
+    auto elapsed = std::chrono::steady_clock::now() - s_epoch;
+    // +1 so a valid timestamp is never 0 (TraceScope uses 0 for "not recording")
+    return (uint64_t)std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed).count() + 1;
+}
+
+void Tracer::record(const char* name, const char* category, uint64_t startNs, uint64_t endNs) {
+    ThreadBuffer* buffer = t_buffer ? t_buffer : registerThread();
+    uint64_t index = buffer->count.load(std::memory_order_relaxed);
+    buffer->events[index & buffer->mask] = {name, category, startNs, endNs - startNs};
+    buffer->count.store(index + 1, std::memory_order_release);
+}
+
+bool Tracer::writeChromeTrace(const std::string& path) {
+    std::ofstream file(path);
+    if (!file.is_open()) {
+        BADCAD_LOG_ERROR("Failed to write trace: ", path);
+        return false;
+    }
+
+    std::lock_guard<std::mutex> lock(s_registryMutex);
+    size_t written = 0;
+    file << std::fixed << std::setprecision(3);
+    file << "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n";
+    bool first = true;
+
+    std::vector<TraceEvent> snapshot;
+    for (const auto& buffer : s_buffers) {
+        file << (first ? "" : ",\n") << "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":"
+             << buffer->threadId << ",\"args\":{\"name\":";
+        writeJsonString(file, buffer->threadName.c_str());
+        file << "}}";
+        first = false;
+
+        // Copy, then drop whatever the owner may have overwritten meanwhile
+        uint64_t capacity = buffer->events.size();
+        uint64_t before = buffer->count.load(std::memory_order_acquire);
+        snapshot = buffer->events;
+        uint64_t after = buffer->count.load(std::memory_order_acquire);
+        uint64_t begin = after > capacity ? after - capacity : 0;
+
+        for (uint64_t i = begin; i < before; i++) {
+            const TraceEvent& event = snapshot[i & buffer->mask];
+            file << ",\n{\"name\":";
+            writeJsonString(file, event.name);
+            file << ",\"cat\":";
+            writeJsonString(file, event.category);
+            file << ",\"ph\":\"X\",\"pid\":1,\"tid\":" << buffer->threadId
+                 << ",\"ts\":" << event.startNs / 1000.0 << ",\"dur\":" << event.durationNs / 1000.0 << "}";
+            written++;
+        }
+    }
+    file << "\n]}\n";
+
+    BADCAD_LOG_INFO("Trace written to ", path, " (", written, " events)");
+    return true;
+}
+
+} // namespace badcad
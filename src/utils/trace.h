@@ -0,0 +1,75 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+namespace badcad {
+
+// Timeline tracing across threads, exported as Chrome trace JSON (opens in
+// chrome://tracing and ui.perfetto.dev).
+//
+// Each thread records into its own fixed-size ring buffer, so recording never
+// takes a lock; the oldest events are overwritten once a buffer is full.
+// While tracing is disabled a zone costs one relaxed atomic load. Defining
+// BADCAD_DISABLE_TRACING compiles zones out entirely.
+//
+// Zone names and categories must be string literals (or otherwise outlive
+// the trace); only the pointers are stored.
+class Tracer {
+public:
+    static void enable(size_t eventsPerThread = 1 << 16);
+    static void disable();
+    static bool isEnabled() { return s_enabled.load(std::memory_order_relaxed); }
+
+    // Label for the calling thread in the exported timeline
+    static void setThreadName(const char* name);
+
+    static uint64_t now();
+    static void record(const char* name, const char* category, uint64_t startNs, uint64_t endNs);
+
+    // Safe to call while other threads are still recording
+    static bool writeChromeTrace(const std::string& path);
+
+private:
+    static std::atomic<bool> s_enabled;
+};
+
+class TraceScope {
+public:
+    explicit TraceScope(const char* name, const char* category = "app")
+        : m_name(name), m_category(category) {
+        if (Tracer::isEnabled()) {
+            m_start = Tracer::now();
+        }
+    }
+    ~TraceScope() {
+        if (m_start != 0) {
+            Tracer::record(m_name, m_category, m_start, Tracer::now());
+        }
+    }
+
+    TraceScope(const TraceScope&) = delete;
+    TraceScope& operator=(const TraceScope&) = delete;
+
+private:
+    const char* m_name;
+    const char* m_category;
+    uint64_t m_start = 0;   // 0 = tracing was off when the scope was entered
+};
+
+} // namespace badcad
+
+#define BADCAD_TRACE_CONCAT_INNER(a, b) a##b
+#define BADCAD_TRACE_CONCAT(a, b) BADCAD_TRACE_CONCAT_INNER(a, b)
+
+#ifndef BADCAD_DISABLE_TRACING
+#define BADCAD_TRACE_SCOPE(name) \
+    ::badcad::TraceScope BADCAD_TRACE_CONCAT(traceScope_, __LINE__)(name)
+#define BADCAD_TRACE_SCOPE_CAT(name, category) \
+    ::badcad::TraceScope BADCAD_TRACE_CONCAT(traceScope_, __LINE__)(name, category)
+#else
+#define BADCAD_TRACE_SCOPE(name) ((void)0)
+#define BADCAD_TRACE_SCOPE_CAT(name, category) ((void)0)
+#endif
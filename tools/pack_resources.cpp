@@ -0,0 +1,140 @@
+// Packs resource files into a C++ source file that is compiled into badCAD.
+//
+//   pack_resources <output.cpp> <resource dir> <relative path>...
+//
+// Files are zlib-compressed when that saves at least 10% (fonts, shaders);
+// already-compressed formats such as PNG are stored as-is so the runtime can
+// hand out pointers into the executable without copying. Entries are sorted
+// by name for binary search and aligned to 16 bytes. The generated file is
+// built with BADCAD_EMBED_RESOURCES defined; see src/utils/resource_bundle.h.
+
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <vector>
+#include "../src/utils/hash.h"
+
+#define STB_IMAGE_WRITE_IMPLEMENTATION
+#include <stb/stb_image_write.h>
+
+namespace {
+
+constexpr size_t kAlignment = 16;
+
+struct PackedFile {
+    std::string name;
+    std::vector<unsigned char> stored;
+    size_t originalSize = 0;
+    uint64_t contentHash = 0;
+};
+
+bool readFile(const std::string& path, std::vector<unsigned char>& outBytes) {
+    std::ifstream file(path, std::ios::binary | std::ios::ate);
+    if (!file.is_open()) {
+        return false;
+    }
+    outBytes.resize((size_t)file.tellg());
+    file.seekg(0);
+    return (bool)file.read(reinterpret_cast<char*>(outBytes.data()), outBytes.size());
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    if (argc < 4) {
+        std::cerr << "Usage: pack_resources <output.cpp> <resource dir> <relative path>..." << std::endl;
+        return 2;
+    }
+    std::string outputPath = argv[1];
+    std::string root = argv[2];
+
+    std::vector<PackedFile> files;
+    size_t totalOriginal = 0;
+    size_t totalStored = 0;
+
+    for (int i = 3; i < argc; i++) {
+        PackedFile packed;
+        packed.name = argv[i];
+        std::replace(packed.name.begin(), packed.name.end(), '\\', '/');
+
+        std::vector<unsigned char> bytes;
+        if (!readFile(root + "/" + packed.name, bytes)) {
+            std::cerr << "Failed to read " << root << "/" << packed.name << std::endl;
+            return 1;
+        }
+        packed.originalSize = bytes.size();
+        packed.contentHash = badcad::hashBytes(bytes.data(), bytes.size());
+
+        int compressedSize = 0;
+        unsigned char* compressed = stbi_zlib_compress(bytes.data(), (int)bytes.size(), &compressedSize, 8);
+        if (compressed && (size_t)compressedSize * 10 < bytes.size() * 9) {
+            packed.stored.assign(compressed, compressed + compressedSize);
+        } else {
+            packed.stored = std::move(bytes);
+        }
+        std::free(compressed);
+
+        totalOriginal += packed.originalSize;
+        totalStored += packed.stored.size();
+        files.push_back(std::move(packed));
+    }
+
+    std::sort(files.begin(), files.end(), [](const PackedFile& a, const PackedFile& b) { return a.name < b.name; });
+    for (size_t i = 1; i < files.size(); i++) {
+        if (files[i].name == files[i - 1].name) {
+            std::cerr << "Duplicate resource: " << files[i].name << std::endl;
+            return 1;
+        }
+    }
+
+    std::ofstream out(outputPath);
+    if (!out.is_open()) {
+        std::cerr << "Failed to write " << outputPath << std::endl;
+        return 1;
+    }
+
+    out << "// Generated by tools/pack_resources.cpp - do not edit\n"
+        << "#include \"utils/resource_bundle.h\"\n\n"
+        << "namespace badcad {\n\n"
+        << "alignas(" << kAlignment << ") extern const unsigned char kResourceBundleData[] = {\n";
+
+    std::vector<size_t> offsets;
+    size_t offset = 0;
+    char byteText[8];
+    for (const PackedFile& file : files) {
+        size_t padding = (kAlignment - offset % kAlignment) % kAlignment;
+        for (size_t i = 0; i < padding; i++) {
+            out << "0,";
+        }
+        offset += padding;
+        offsets.push_back(offset);
+
+        out << "// " << file.name << "\n";
+        for (size_t i = 0; i < file.stored.size(); i++) {
+            std::snprintf(byteText, sizeof(byteText), "%u,", file.stored[i]);
+            out << byteText << ((i % 24 == 23) ? "\n" : "");
+        }
+        out << "\n";
+        offset += file.stored.size();
+    }
+    // Keeps the array non-empty when no files are packed
+    out << "0\n};\n\n";
+
+    out << "extern const ResourceBundleEntry kResourceBundleEntries[] = {\n";
+    char hashText[24];
+    for (size_t i = 0; i < files.size(); i++) {
+        std::snprintf(hashText, sizeof(hashText), "0x%016llxull", (unsigned long long)files[i].contentHash);
+        out << "    {\"" << files[i].name << "\", " << offsets[i] << ", " << files[i].stored.size()
+            << ", " << files[i].originalSize << ", " << hashText << "},\n";
+    }
+    out << "    {\"\", 0, 0, 0, 0}\n};\n\n"
+        << "extern const size_t kResourceBundleEntryCount = " << files.size() << ";\n\n"
+        << "} // namespace badcad\n";
+
+    std::cout << "Packed " << files.size() << " resources: " << totalOriginal / 1024 << " KB -> "
+              << totalStored / 1024 << " KB" << std::endl;
+    return 0;
+}